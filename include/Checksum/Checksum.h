@@ -0,0 +1,44 @@
+/**
+ * @file Checksum.h
+ * @author Bottini, Franco Nicolas.
+ * @brief Cabecera del checksum de integridad de los mensajes (CRC32C), comun al Server y a los clientes.
+ * @version 1.0
+ * @date Marzo de 2023.
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef __CHECKSUM_H__
+#define __CHECKSUM_H__
+
+#include "Common.h"
+
+/**
+ * @brief Selecciona la implementacion del CRC32C.
+ *
+ * Utiliza la instruccion crc32 de SSE4.2 si el procesador la admite y, en caso contrario, una implementacion portable
+ * por tablas (slicing-by-8). Debe invocarse una vez por proceso, antes de calcular cualquier checksum.
+ *
+ * @return No devuelve ningun valor.
+*/
+void checksum_init(void);
+
+/**
+ * @brief Calcula el checksum del contenido de un mensaje.
+ *
+ * @param msg Contenido del mensaje.
+ * @param len Longitud del contenido, sin el caracter nulo final.
+ *
+ * @return CRC32C del contenido.
+*/
+uint32_t checksum_message(const char* msg, size_t len);
+
+/**
+ * @brief Obtiene el nombre de la implementacion del CRC32C en uso.
+ *
+ * @return "SSE4.2" o "software".
+*/
+const char* checksum_impl(void);
+
+#endif //__CHECKSUM_H__
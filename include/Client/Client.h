@@ -13,6 +13,58 @@
 #define __CLIENT_H__
 
 #include "Common.h"
+#include "Config.h"
+#include "Tracer.h"
+#include "Checksum.h"
+
+//Tiempo maximo por defecto (en milisegundos) que un cliente con politica CREDIT_BLOCK espera que el servidor le devuelva creditos (IPC_CREDIT_BLOCK_TIMEOUT_MS).
+#define CREDIT_BLOCK_TIMEOUT_MS 1000
+
+//Espera minima por defecto (en microsegundos) antes de reintentar una solicitud rechazada con WAIT (IPC_BACKOFF_MIN_US).
+#define BACKOFF_MIN_US 10
+
+//Espera maxima por defecto (en microsegundos) entre reintentos de una solicitud rechazada con WAIT (IPC_BACKOFF_MAX_US).
+#define BACKOFF_MAX_US 1000
+
+//Tiempo maximo por defecto (en milisegundos) que un cliente espera a que un servidor reiniciado en caliente publique su PID (IPC_RESTART_WAIT_MS).
+#define SERVER_RESTART_WAIT_MS 5000
+
+/**
+ * Tipo enumerado que define el comportamiento de un cliente cuando agota su ventana de creditos.
+ * Se selecciona con la variable de entorno IPC_CREDIT_POLICY ("block" o "fail").
+*/
+typedef enum CreditPolicy
+{
+    //Espera a que el servidor devuelva creditos (hasta CREDIT_BLOCK_TIMEOUT_MS) antes de descartar el mensaje.
+    CREDIT_BLOCK,
+
+    //Descarta el mensaje inmediatamente.
+    CREDIT_FAIL_FAST
+} CreditPolicy;
+
+/**
+ * Tiempos de espera y opciones del cliente, leidos de la configuracion al iniciar el proceso y comunes a todos sus clientes.
+*/
+typedef struct ClientTuning
+{
+    //Tiempo maximo (en milisegundos) que se espera la respuesta del servidor a una solicitud.
+    long reply_timeout_ms;
+
+    //Espera minima (en microsegundos) antes de reintentar una solicitud rechazada con WAIT.
+    long backoff_min_us;
+
+    //Espera maxima (en microsegundos) entre reintentos de una solicitud rechazada con WAIT.
+    long backoff_max_us;
+
+    //Tiempo maximo (en milisegundos) que un cliente con politica CREDIT_BLOCK espera creditos.
+    long credit_block_timeout_ms;
+
+    //Tiempo maximo (en milisegundos) que se espera a un servidor reiniciado en caliente.
+    long restart_wait_ms;
+
+    //1 si los mensajes se envian con el CRC32C de su contenido en la cabecera (IPC_CHECKSUM).
+    int checksum;
+} ClientTuning;
 
 /**
  * Una estructura que representa un cliente que se conecta a un servidor.
@@ -31,30 +83,70 @@ typedef struct Client
     // El ID del de la cola de mensajes.
     int msgid;
 
+    // Clase de prioridad con la que se encolan los mensajes (solo MESSAGE_QUEUE).
+    MsgPriority priority;
+
+    // Un puntero a la pagina de control de creditos compartida por el servidor.
+    CreditPage* credit_page;
+
+    // Un puntero a la entrada del cliente en la pagina de control de creditos (NULL si no hay entradas libres).
+    CreditSlot* credit;
+
+    // Comportamiento del cliente al agotar sus creditos.
+    CreditPolicy credit_policy;
+
     // Un puntero a la memoria compartida.
-    char* shm;
+    Message* shm;
+
+    // Un puntero al anillo del modo de baja latencia de la memoria compartida (NULL si el servidor no lo habilito).
+    ShmRing* ring;
+
+    // Mascara de las posiciones del anillo, leida de la cantidad de slots que publica el servidor.
+    unsigned int ring_mask;
+
+    // Un puntero al archivo mapeado en memoria del canal MAPPED FILE.
+    MappedFile* mapped;
+
+    // Numero de secuencia del proximo mensaje.
+    uint32_t seq;
+
+    // Identificador del cliente virtual que envia el mensaje (0 para un cliente independiente).
+    uint32_t vid;
 
     // Un puntero a la función que inicializa el cliente.
     void (*init)(void);
 
-    // Un puntero a la función que envía mensajes desde el cliente al servidor.
-    void (*send)(const char* msg);
+    // Un puntero a la función que envía mensajes desde el cliente al servidor. Devuelve 1 si el mensaje se envio, 0 en caso contrario.
+    int (*send)(const char* msg);
+
+    // Un puntero a la función que escribe el mensaje una vez que el servidor otorgo el canal (NULL si el canal no tiene handshake).
+    int (*write)(const char* msg);
 } Client;
 
+//Puntero que almacena la instancia del cliente del hilo (cada hilo de un proceso con clientes virtuales atiende su propio canal).
+extern _Thread_local Client* client;
+
+//Array auxiliar para obtener un elemento del enumerado 'ChannelType' en formato de cadena.
+extern const char* ChannelStringType[];
+
+//Tiempos de espera y opciones del proceso cliente (ver client_configure).
+extern ClientTuning tuning;
+
 /**
  * @brief Imprime en la consola información sobre los argumentos de entrada requeridos. 
  * 
  * Imprime en la consola una descripción detallada sobre los argumentos de entrada que deben ser proporcionados para que el programa pueda ejecutarse correctamente. 
  * En concreto, se debe especificar el tipo de cliente que se desea instanciar: FIFO, Shared Memory o Message Queue. 
+ * Opcionalmente, para los clientes Message Queue se puede indicar la clase de prioridad de sus mensajes.
  * 
  * @return No devuelve ningún valor.
  */
 void print_help(void);
 
 /**
- * @brief Manejador de señales SIGUSR1. 
+ * @brief Manejador de señales del cliente. 
  * 
- * Si la señal SIGUSR1 es recibida por el proceso, esta función se ejecutará automáticamente.
+ * Finaliza el cliente al recibir SIGTERM, SIGINT o SIGHUP. Las respuestas del servidor no pasan por el manejador: se reciben con wait_reply.
  * 
  * @param sig El número de señal recibido
  * @param info Puntero a una estructura siginfo_t que contiene información adicional sobre la señal recibida
@@ -75,11 +167,42 @@ void signal_handler(int sig, siginfo_t *info, void* context);
  */
 Client* client_factory(ChannelType channel_type, int server_pid);
 
+/**
+ * @brief Carga la configuracion del proceso cliente. 
+ * 
+ * Lee el archivo de configuracion y las variables de entorno y aplica los tiempos de espera del cliente (IPC_REPLY_TIMEOUT_MS,
+ * IPC_BACKOFF_MIN_US, IPC_BACKOFF_MAX_US, IPC_CREDIT_BLOCK_TIMEOUT_MS e IPC_RESTART_WAIT_MS) y el envio del CRC32C de cada
+ * mensaje (IPC_CHECKSUM=1). Debe invocarse al comenzar el programa, antes de crear cualquier cliente.
+ * 
+ * @return No devuelve ningun valor.
+ */
+void client_configure(void);
+
+/**
+ * @brief Obtiene el PID del servidor en ejecucion. 
+ * 
+ * Lee el PID publicado por el servidor en el archivo IPC_PID_FILE (PID_SERVER_FILE por defecto).
+ * 
+ * @return PID del servidor, o -1 si no se encontro un servidor en ejecucion.
+ */
+int read_server_pid(void);
+
+/**
+ * @brief Vuelve a leer el PID del servidor tras un reinicio en caliente. 
+ * 
+ * Se invoca cuando el servidor conocido ya no existe o no responde: espera hasta IPC_RESTART_WAIT_MS milisegundos
+ * (SERVER_RESTART_WAIT_MS por defecto) a que el archivo del PID indique un servidor distinto y en ejecucion.
+ * 
+ * @return 1 si el cliente paso a utilizar un nuevo servidor. 0 si no hay un nuevo servidor.
+ */
+int refresh_server_pid(void);
+
 /**
  * @brief Inicializa el cliente con los argumentos de entrada especificados. 
  * 
  * Inicializa el cliente con los argumentos de entrada proporcionados en el programa.
  * La función espera que se proporcione un argumento que especifica el tipo de cliente a instanciar, que puede ser FIFO (0), Shared Memory (1) o Message Queue (2).
+ * Un segundo argumento opcional indica la clase de prioridad de la cola de mensajes: URGENT (1), NORMAL (2, por defecto) o BULK (3).
  * Si se proporciona un número incorrecto de argumentos o un argumento inválido, se imprime un mensaje de error y se finaliza la ejecución del programa.
  * Si no se encuentra un servidor en ejecución, se imprime un mensaje de error y se finaliza la ejecución del programa.
  * 
@@ -91,9 +214,10 @@ Client* client_factory(ChannelType channel_type, int server_pid);
 void client_init(int argc, char* argv[]);
 
 /**
- * @brief Inicializa el manejador de señales para SIGUSR1. 
+ * @brief Inicializa el manejador de señales del cliente. 
  *
- * Configura el proceso para que escuche y procese señales del tipo SIGUSR1.
+ * Configura el proceso para que procese SIGTERM, SIGINT y SIGHUP y bloquea las señales de tiempo real SIGNAL_REPLY de cada canal,
+ * que queda encolada hasta que el cliente la espera con sigtimedwait.
  * 
  * @return No devuelve ningun valor.
  */
@@ -122,54 +246,217 @@ void shared_memory_init(void);
  */
 void message_queue_init(void);
 
+/**
+ * @brief Inicializa el canal MAPPED FILE.
+ *
+ * Abre el archivo creado por el servidor (IPC_MAPPED_FILE o MAPPED_FILE_NAME) y lo mapea en el espacio del proceso.
+ *
+ * @return No devuelve ningún valor.
+ */
+void mapped_file_init(void);
+
+/**
+ * @brief Inicializa el control de flujo basado en creditos. 
+ * 
+ * Se conecta a la pagina de control de creditos creada por el servidor y reserva una entrada para el cliente, en la que
+ * publica su peso para el reparto de los canales (variable de entorno IPC_CLIENT_WEIGHT, 1 por defecto). Si el servidor
+ * reservo CPUs para sus hilos, los excluye de la afinidad del proceso; por eso debe invocarse antes de crear otros hilos.
+ * Si el peso es invalido, la función muestra un mensaje de error y termina el programa.
+ * 
+ * @return No devuelve ningún valor.
+ */
+void credit_page_init(void);
+
+/**
+ * @brief Reserva los creditos necesarios para enviar un mensaje. 
+ * 
+ * Si la ventana de creditos otorgada por el servidor esta agotada, el comportamiento depende de la politica del cliente:
+ * con CREDIT_BLOCK espera a que el servidor devuelva creditos y con CREDIT_FAIL_FAST descarta el mensaje.
+ * Los mensajes descartados se contabilizan en la pagina de control para que el servidor los informe.
+ * 
+ * @param bytes Bytes del mensaje a enviar.
+ * 
+ * @return 1 si se reservaron los creditos. 0 si el mensaje debe descartarse.
+ */
+int acquire_credits(int bytes);
+
+/**
+ * @brief Intenta reservar los creditos necesarios para enviar un mensaje, sin esperar. 
+ * 
+ * @param bytes Bytes del mensaje a enviar.
+ * 
+ * @return 1 si se reservaron los creditos (o el cliente no tiene entrada de creditos). 0 si la ventana esta agotada.
+ */
+int try_credits(int bytes);
+
+/**
+ * @brief Envia una señal de control de tiempo real al servidor. 
+ * 
+ * Las señales de tiempo real se encolan sin fusionarse. Si la cola de señales pendientes esta llena (EAGAIN) el envio se reintenta
+ * con espera exponencial hasta SIGNAL_QUEUE_RETRIES veces y cada desborde se informa en la pagina de control de creditos.
+ * Si el servidor ya no existe (ESRCH), se vuelve a leer su PID por si fue reiniciado en caliente y se reintenta el envio.
+ * 
+ * @param sig Señal a enviar (SIGNAL_START_WRITE o SIGNAL_END_WRITE).
+ * @param value Valor que acompaña a la señal (canal, comando y bytes del mensaje).
+ * 
+ * @return 1 si la señal se encolo. 0 si se agotaron los reintentos.
+*/
+int send_control(int sig, int value);
+
+/**
+ * @brief Devuelve los creditos reservados para un mensaje que no se envio. 
+ * 
+ * @param bytes Bytes del mensaje descartado.
+ * 
+ * @return No devuelve ningun valor.
+ */
+void refund_credits(int bytes);
+
+/**
+ * @brief Espera la respuesta del servidor a una solicitud de inicio de escritura. 
+ * 
+ * Bloquea al cliente en sigtimedwait, sin consumir CPU, hasta recibir la SIGNAL_REPLY de su canal o hasta que transcurran IPC_REPLY_TIMEOUT_MS milisegundos.
+ * Descarta las respuestas dirigidas a otro cliente virtual del proceso (solicitudes anteriores que vencieron).
+ * 
+ * @param response Respuesta recibida (START_WRITE o WAIT).
+ * 
+ * @return 1 si se recibio la respuesta. 0 si se agoto el tiempo de espera.
+ */
+int wait_reply(USRSignalType* response);
+
 /**
  * @brief Envía una solicitud de envio de mensaje al servidor. 
  * 
- * Envía una señal al servidor solicitando escribir un mensaje y espera una respuesta.
- * Si la conexión no se establece en un plazo de 1 segundo, la función devuelve un valor de 0.
- * Si el servidor está ocupado, la función espera un tiempo aleatorio y de vuelve a intentarlo.
+ * Reserva los creditos del mensaje, envía una señal al servidor solicitando escribir un mensaje y espera una respuesta.
+ * Si la respuesta no llega en IPC_REPLY_TIMEOUT_MS milisegundos, la función devuelve un valor de 0, salvo que el servidor haya
+ * sido reiniciado en caliente: en ese caso la solicitud se repite con el nuevo servidor.
+ * Si el canal está ocupado, el servidor encola la solicitud y responde cuando le toca al cliente en el reparto; solo si la
+ * rechaza (respuesta WAIT), la función espera con retroceso exponencial (entre IPC_BACKOFF_MIN_US e IPC_BACKOFF_MAX_US, con jitter) y vuelve a intentarlo.
+ * Si el mensaje se descarta se consume igualmente su numero de secuencia, lo que permite al servidor detectar la perdida.
+ * 
+ * @param bytes Bytes del mensaje a enviar, se informan al servidor junto con la solicitud.
  * 
  * @return Devuelve un valor entero:
  *          - 1 si la conexión se establece con éxito.
  *          - 0 si la conexión no se establece.
  */
-int request_send(void);
+int request_send(int bytes);
+
+/**
+ * @brief Envía al servidor la solicitud de inicio de escritura del cliente actual, sin esperar la respuesta. 
+ * 
+ * Los creditos del mensaje ya deben estar reservados; si la señal no se puede enviar se devuelven. La respuesta llega en la
+ * SIGNAL_REPLY del canal con el identificador del cliente virtual, lo que permite tener varias solicitudes en vuelo.
+ * 
+ * @param bytes Bytes del mensaje a enviar, se informan al servidor junto con la solicitud.
+ * 
+ * @return 1 si la solicitud se envio. 0 si se agotaron los reintentos de la señal.
+ */
+int request_start(int bytes);
+
+/**
+ * @brief Completa la cabecera del proximo mensaje del cliente. 
+ * 
+ * Asigna el PID, el proximo numero de secuencia y el instante de envio. Se invoca una vez que el servidor otorgo el canal.
+ * 
+ * @param header Cabecera a completar.
+ * 
+ * @return No devuelve ningún valor.
+ */
+void fill_header(MsgHeader* header);
 
 /**
  * @brief Envia un mensaje al servidor a través de la FIFO.
  *
  * @param msg Un puntero a la cadena de caracteres que representa el mensaje que se enviará al servidor.
  *
- * @return No devuelve ningun valor.
+ * @return 1 si el servidor otorgo el canal y el mensaje se escribio. 0 si el mensaje se descarto.
  *
  * @note Se asume que el cliente ya ha sido inicializado y que la variable client es válida.
  * @warning No se garantiza que el servidor haya recibido o procesado el mensaje enviado.
  */
-void fifo_send(const char* msg);
+int fifo_send(const char* msg);
+
+/**
+ * @brief Escribe un mensaje en la FIFO una vez que el servidor otorgo el canal e informa el fin de escritura.
+ *
+ * @param msg Un puntero a la cadena de caracteres que representa el mensaje que se enviará al servidor.
+ *
+ * @return 1 (el mensaje se escribio).
+ */
+int fifo_write(const char* msg);
+
+/**
+ * @brief Envia un mensaje al servidor a través del anillo del modo de baja latencia de la SHARED MEMORY.
+ *
+ * Reserva los creditos del mensaje y un slot del anillo, publica el mensaje y despierta al consumidor del servidor si estaba
+ * estacionado en el futex. No requiere señales: si el anillo esta lleno el mensaje se descarta.
+ *
+ * @param msg Un puntero a la cadena de caracteres que representa el mensaje que se enviará al servidor.
+ *
+ * @return 1 si el mensaje se publico en el anillo. 0 si el mensaje se descarto.
+ */
+int shared_memory_ring_send(const char* msg);
 
 /**
  * @brief Envia un mensaje al servidor a través de la SHARED MEMORY.
  *
  * @param msg Un puntero a la cadena de caracteres que representa el mensaje que se enviará al servidor.
  *
- * @return No devuelve ningun valor.
+ * @return 1 si el servidor otorgo el canal y el mensaje se escribio. 0 si el mensaje se descarto.
  *
  * @note Se asume que el cliente ya ha sido inicializado y que la variable client es válida.
  * @warning No se garantiza que el servidor haya recibido o procesado el mensaje enviado.
  */
-void shared_memory_send(const char* msg);
+int shared_memory_send(const char* msg);
+
+/**
+ * @brief Escribe un mensaje en la SHARED MEMORY una vez que el servidor otorgo el canal e informa el fin de escritura.
+ *
+ * @param msg Un puntero a la cadena de caracteres que representa el mensaje que se enviará al servidor.
+ *
+ * @return 1 (el mensaje se escribio).
+ */
+int shared_memory_write(const char* msg);
 
 /**
  * @brief Envia un mensaje al servidor a través de la MESSAGE QUEUE.
  *
  * @param msg Un puntero a la cadena de caracteres que representa el mensaje que se enviará al servidor.
  *
- * @return No devuelve ningun valor.
+ * @return 1 si el servidor otorgo el canal y el mensaje se escribio. 0 si el mensaje se descarto.
  *
  * @note Se asume que el cliente ya ha sido inicializado y que la variable client es válida.
  * @warning No se garantiza que el servidor haya recibido o procesado el mensaje enviado.
  */
-void message_queue_send(const char* msg);
+int message_queue_send(const char* msg);
+
+/**
+ * @brief Escribe un mensaje en la MESSAGE QUEUE una vez que el servidor otorgo el canal e informa el fin de escritura.
+ *
+ * @param msg Un puntero a la cadena de caracteres que representa el mensaje que se enviará al servidor.
+ *
+ * @return 1 (el mensaje se escribio).
+ */
+int message_queue_write(const char* msg);
+
+/**
+ * @brief Busca el slot del archivo mapeado asignado al cliente o reclama uno libre.
+ *
+ * @return Un puntero al slot, o NULL si la tabla esta llena.
+ */
+MappedSlot* find_mapped_slot(void);
+
+/**
+ * @brief Publica un mensaje en el archivo mapeado sin handshake con el servidor.
+ *
+ * Escribe el ultimo valor del cliente en su slot protegido por un seqlock y agrega una copia al log circular.
+ *
+ * @param msg Un puntero a la cadena de caracteres que representa el mensaje que se publicara.
+ *
+ * @return 1 si el mensaje se publico. 0 si la tabla de slots esta llena.
+ */
+int mapped_file_send(const char* msg);
 
 /**
  * @brief Finaliza la ejecucion del programa. 
@@ -0,0 +1,148 @@
+/**
+ * @file ClientHost.h
+ * @author Bottini, Franco Nicolas.
+ * @brief Cabecera del modo host de clientes virtuales del Cliente IPC.
+ * @version 1.0
+ * @date Marzo de 2023.
+ * 
+ * @copyright Copyright (c) 2023
+ * 
+ */
+
+#ifndef __CLIENT_HOST_H__
+#define __CLIENT_HOST_H__
+
+#include <pthread.h>
+#include "Client.h"
+
+//Periodo medio de envio (en milisegundos) de cada cliente virtual si no se indica --period-ms.
+#define HOST_PERIOD_MS 3000
+
+//Tiempo maximo (en milisegundos) que un hilo del host duerme antes de revisar si debe terminar.
+#define HOST_POLL_MS 100
+
+//Intervalo (en milisegundos) entre intentos de reservar creditos de un cliente virtual sin creditos.
+#define HOST_CREDIT_RETRY_MS 1
+
+/**
+ * Estado de un cliente virtual de un canal con handshake.
+*/
+typedef enum VirtualState
+{
+    //Esperando el instante de su proximo envio.
+    VIRTUAL_IDLE,
+
+    //Mensaje formateado, esperando creditos para solicitar el canal.
+    VIRTUAL_CREDITS,
+
+    //Solicitud enviada, esperando la respuesta del servidor hasta 'next_ns'.
+    VIRTUAL_REQUESTED,
+
+    //Solicitud rechazada con WAIT, esperando el retroceso hasta 'next_ns'.
+    VIRTUAL_BACKOFF
+} VirtualState;
+
+/**
+ * Cliente logico alojado en el proceso host, con su propio numero de secuencia y su propia agenda de envio.
+*/
+typedef struct VirtualClient
+{
+    //Identificador del cliente virtual (1..N), viaja en la cabecera de cada mensaje.
+    uint32_t vid;
+
+    //Numero de secuencia del proximo mensaje del cliente virtual.
+    uint32_t seq;
+
+    //Valor del proximo mensaje (contador, igual que el cliente independiente).
+    int counter;
+
+    //Instante (CLOCK_MONOTONIC, en nanosegundos) del proximo evento: envio, reintento de creditos, vencimiento de la respuesta o fin del retroceso.
+    int64_t next_ns;
+
+    //Instante (CLOCK_MONOTONIC, en nanosegundos) en que comenzo a esperar creditos.
+    int64_t since_ns;
+
+    //Estado del envio en curso.
+    VirtualState state;
+
+    //Retroceso actual (en microsegundos) ante una respuesta WAIT.
+    long backoff_us;
+
+    //Mensaje en curso, se conserva entre la solicitud y la escritura.
+    char msg[12];
+} VirtualClient;
+
+/**
+ * Canal del host: un hilo con su propio cliente que atiende a los clientes virtuales del canal en orden de vencimiento.
+ * En los canales con handshake el hilo es un bucle de eventos: cada cliente virtual puede tener su solicitud en vuelo y
+ * las respuestas, que llevan el identificador del cliente virtual, se reciben en la SIGNAL_REPLY del canal.
+*/
+typedef struct HostChannel
+{
+    //Canal atendido por el hilo.
+    ChannelType type;
+
+    //Clientes virtuales del canal, organizados como un heap de minimos por 'next_ns'.
+    VirtualClient* clients;
+
+    //Cantidad de clientes virtuales del canal.
+    int count;
+
+    //Identificador del primer cliente virtual del canal (los del canal son contiguos).
+    uint32_t first_vid;
+
+    //Posicion en el heap de cada cliente virtual, indexada por 'vid - first_vid'.
+    int* position;
+
+    //Hilo que atiende el canal.
+    pthread_t thread;
+
+    //Mensajes enviados con exito.
+    long sent;
+
+    //Mensajes descartados (sin creditos o sin respuesta del servidor).
+    long dropped;
+
+    //Solicitudes vencidas sin respuesta del servidor.
+    long timeouts;
+
+    //Solicitudes en vuelo.
+    int outstanding;
+
+    //Maximo de solicitudes en vuelo.
+    int max_outstanding;
+
+    //Integral de las solicitudes en vuelo en el tiempo (solicitudes por nanosegundo), para el promedio.
+    int64_t outstanding_ns;
+
+    //Instante del ultimo cambio de 'outstanding'.
+    int64_t mark_ns;
+
+    //Duracion del bucle de eventos del canal (0 si el canal no tiene handshake).
+    int64_t elapsed_ns;
+} HostChannel;
+
+/**
+ * @brief Imprime en la consola información sobre los argumentos del modo host. 
+ * 
+ * @return No devuelve ningún valor.
+ */
+void print_host_help(void);
+
+/**
+ * @brief Ejecuta el modo host de clientes virtuales.
+ * 
+ * Interpreta los argumentos --clients N, --channel-mix a:b:c (por defecto 1:1:1) y --period-ms P (por defecto HOST_PERIOD_MS),
+ * reparte los N clientes virtuales entre los canales segun el mix y lanza un hilo por canal. Cada cliente virtual envia un mensaje
+ * en promedio cada P milisegundos; en los canales con handshake varios clientes virtuales pueden esperar respuesta a la vez, hasta
+ * agotar la ventana de creditos del proceso. N no puede superar CONTROL_VID_MASK. El proceso termina al recibir SIGTERM, SIGINT o SIGHUP o al detenerse el servidor.
+ * Si los argumentos son invalidos o no se encuentra un servidor en ejecucion, la función muestra un mensaje de error y termina el programa.
+ * 
+ * @param argc Número de argumentos proporcionados.
+ * @param argv Arreglo de argumentos proporcionados.
+ * 
+ * @return No devuelve ningún valor.
+ */
+void client_host_run(int argc, char* argv[]);
+
+#endif //__CLIENT_HOST_H__
@@ -21,6 +21,8 @@
 #include <string.h>
 #include <errno.h>
 #include <time.h>
+#include <stdatomic.h>
+#include <stdint.h>
 #include <sys/stat.h>
 #include <sys/ipc.h>
 #include <sys/shm.h>
@@ -39,6 +41,90 @@
 //Longitud maxima admitida para los mensajes enviados por los clientes
 #define MSG_MAX_SIZE 1024
 
+//Bit de 'flags' de la cabecera que indica que 'crc' contiene el CRC32C del contenido del mensaje.
+#define MSG_FLAG_CHECKSUM 0x1
+
+//Cantidad de canales IPC atendidos por el servidor.
+#define CHANNEL_COUNT 4
+
+//Path por defecto del archivo mapeado en memoria del canal MAPPED FILE (se puede cambiar con IPC_MAPPED_FILE).
+#define MAPPED_FILE_NAME "/dev/shm/.ipc_mapped"
+
+//Cantidad de entradas de la tabla de ultimos valores del archivo mapeado (potencia de 2).
+#define MAPPED_SLOTS 16384
+
+//Cantidad de registros de la region de anexado del archivo mapeado (potencia de 2).
+#define MAPPED_APPEND_RECORDS 4096
+
+//Longitud maxima de un valor publicado en el archivo mapeado (los mensajes mas largos se truncan).
+#define MAPPED_VALUE_MAX 128
+
+//Cantidad de entradas de la pagina de control de creditos (maxima cantidad de clientes con control de flujo).
+#define CREDIT_SLOTS 1024
+
+//Cantidad de palabras de 64 bits de la mascara de CPUs reservados para el servidor (hasta 1024 CPUs).
+#define CPU_MASK_WORDS 16
+
+//Ventana inicial de creditos de cada cliente: cantidad de solicitudes que puede tener pendientes de procesar en el servidor.
+#define CREDIT_WINDOW_MSGS 4
+
+//Ventana maxima de creditos a la que puede crecer la ventana de un cliente.
+#define CREDIT_WINDOW_MAX 16
+
+//Bytes de credito otorgados por cada mensaje de la ventana.
+#define CREDIT_BYTES_PER_MSG 256
+
+//Peso maximo que un cliente puede declarar para el reparto de los canales (IPC_CLIENT_WEIGHT).
+#define GRANT_WEIGHT_MAX 16
+
+//Tiempo maximo por defecto (en milisegundos) que un cliente espera la respuesta del servidor a una solicitud de inicio de escritura (IPC_REPLY_TIMEOUT_MS).
+#define REPLY_TIMEOUT_MS 1000
+
+//Cantidad minima de slots del anillo de memoria compartida del modo de baja latencia (potencia de 2). IPC_SHM_SIZE puede agrandar el anillo.
+#define SHM_RING_SLOTS 256
+
+//Cantidad de carriles de prioridad de la cola de mensajes (valores de 'mtype' 1..MQ_LANES).
+#define MQ_LANES 3
+
+//Peso de cada clase de prioridad (URGENT, NORMAL, BULK) en el round-robin ponderado de las concesiones y de los carriles de la cola de mensajes.
+#define MQ_LANE_WEIGHTS { 4, 2, 1 }
+
+//Señal de tiempo real con la que un cliente solicita el inicio de escritura (SIGRTMIN no se utiliza: los timeouts del servidor se atienden con timerfd).
+#define SIGNAL_START_WRITE (SIGRTMIN + 1)
+
+//Señal de tiempo real con la que un cliente informa el fin de escritura.
+#define SIGNAL_END_WRITE (SIGRTMIN + 2)
+
+//Señal de tiempo real con la que el servidor responde a una solicitud de inicio de escritura sobre un canal.
+//Cada canal con handshake (FIFO, SHARED_MEMORY y MESSAGE_QUEUE) tiene su propia señal para que un proceso con varios clientes
+//pueda esperar la respuesta de cada canal por separado.
+#define SIGNAL_REPLY(channel) (SIGRTMIN + 3 + (int)(channel))
+
+//Posicion de la clase de prioridad (MsgPriority) en el valor de SIGNAL_START_WRITE: bits 0-1 canal, 2-3 prioridad, 4-14 bytes y 15-30
+//cliente virtual. La operacion la indica la propia señal; SIGNAL_END_WRITE conserva la operacion en los bits 2-3.
+#define CONTROL_PRIORITY_SHIFT 2
+
+//Mascara de la clase de prioridad en el valor de SIGNAL_START_WRITE (0 equivale a PRIORITY_NORMAL).
+#define CONTROL_PRIORITY_MASK 0x3
+
+//Posicion de los bytes del mensaje en el valor de SIGNAL_START_WRITE.
+#define CONTROL_BYTES_SHIFT 4
+
+//Mascara de los bytes del mensaje en el valor de SIGNAL_START_WRITE (alcanza para MSG_MAX_SIZE).
+#define CONTROL_BYTES_MASK 0x7FF
+
+//Posicion del identificador del cliente virtual en el valor de SIGNAL_START_WRITE y de SIGNAL_REPLY (la respuesta ocupa los bits 0-1).
+#define CONTROL_VID_SHIFT 15
+
+//Mascara del identificador del cliente virtual en el valor de las señales de control (los 16 bits bajos del vid).
+#define CONTROL_VID_MASK 0xFFFF
+
+//Cantidad minima de señales encolables (RLIMIT_SIGPENDING) que se intenta garantizar.
+#define SIGNAL_PENDING_MIN 8192
+
+//Reintentos de un envio de señal rechazado por desborde de la cola de señales pendientes.
+#define SIGNAL_QUEUE_RETRIES 8
+
 /**
  * Enumerado que define los tipos de señales con las que trabaja el cliente y el servidor.
  */
@@ -75,19 +161,321 @@ typedef enum ChannelType
     SHARED_MEMORY,
 
     //Cliente que se comunica con el servidor mediante una Cola de Mensajes.
-    MESSAGE_QUEUE
+    MESSAGE_QUEUE,
+
+    //Cliente que publica su ultimo valor en un archivo mapeado en memoria.
+    MAPPED_FILE
 } ChannelType;
 
+/**
+ * Tipo enumerado que define las clases de prioridad de la cola de mensajes.
+ * Cada clase se mapea directamente sobre el campo 'mtype' de SysV, un valor menor implica mayor prioridad.
+*/
+typedef enum MsgPriority
+{
+    //Mensajes de control, se drenan antes que el resto.
+    PRIORITY_URGENT = 1,
+
+    //Trafico normal (valor por defecto).
+    PRIORITY_NORMAL = 2,
+
+    //Trafico masivo, se atiende con la menor prioridad.
+    PRIORITY_BULK = 3
+} MsgPriority;
+
+/**
+ * Cabecera que antecede a cada mensaje en todos los canales.
+*/
+typedef struct MsgHeader
+{
+    //ID del proceso que envia el mensaje.
+    int32_t pid;
+
+    //Identificador del cliente virtual dentro del proceso (0 para un cliente independiente).
+    uint32_t vid;
+
+    //Numero de secuencia del mensaje dentro del cliente. Se incrementa en cada intento de envio, por lo que un mensaje descartado deja un hueco.
+    uint32_t seq;
+
+    //CRC32C del contenido del mensaje, valido solo si 'flags' incluye MSG_FLAG_CHECKSUM.
+    uint32_t crc;
+
+    //Opciones del mensaje (MSG_FLAG_CHECKSUM).
+    uint32_t flags;
+
+    //Instante (CLOCK_MONOTONIC) en que el cliente envio el mensaje, permite medir latencias.
+    struct timespec timestamp;
+} MsgHeader;
+
+/**
+ * Estructura que define un mensaje completo tal como se escribe en la FIFO y en la memoria compartida.
+*/
+typedef struct Message
+{
+    //Cabecera del mensaje.
+    MsgHeader header;
+
+    //Cadena de caracteres que contiene el mensaje en sí mismo.
+    char msg[MSG_MAX_SIZE];
+} Message;
+
 /**
  * Estructura auxiliar que define un elemento de la cola de mensajes.
 */
 typedef struct MsgQueueElemnet
 {
-    //Valor numérico que indica el tipo de mensaje que se está enviando o recibiendo.
+    //Valor numérico que indica el tipo de mensaje que se está enviando o recibiendo (clase de prioridad 'MsgPriority').
     long type;
 
+    //Cabecera del mensaje.
+    MsgHeader header;
+
     //Cadena de caracteres que contiene el mensaje en sí mismo.
     char msg[MSG_MAX_SIZE];
 } MsgQueueElemnet;
 
+/**
+ * Entrada de la pagina de control de creditos asociada a un cliente.
+ * El cliente suma a los contadores en vuelo antes de enviar una solicitud y el servidor los descuenta al procesarla.
+*/
+typedef struct CreditSlot
+{
+    //PID del cliente duenio de la entrada: 0 si nunca se uso, -1 si fue liberada.
+    atomic_int pid;
+
+    //Solicitudes enviadas por el cliente que el servidor todavia no proceso.
+    atomic_int inflight_msgs;
+
+    //Bytes de las solicitudes que el servidor todavia no proceso.
+    atomic_int inflight_bytes;
+
+    //Mensajes descartados por el cliente por falta de creditos.
+    atomic_int dropped;
+
+    //Peso del cliente en el reparto de los canales (1..GRANT_WEIGHT_MAX; 0 equivale a 1).
+    atomic_int weight;
+} CreditSlot;
+
+/**
+ * Pagina de control compartida por el servidor con todos los clientes para el control de flujo basado en creditos.
+*/
+typedef struct CreditPage
+{
+    //Cantidad de solicitudes pendientes que puede tener cada cliente.
+    atomic_int window_msgs;
+
+    //Cantidad de bytes pendientes que puede tener cada cliente.
+    atomic_int window_bytes;
+
+    //Señales de control que los clientes no pudieron encolar por desborde de la cola de señales pendientes.
+    atomic_long signal_overflows;
+
+    //CPUs reservados para los hilos del servidor, que los clientes deben evitar (mascara de bits; vacia si no se aislan).
+    uint64_t isolated_cpus[CPU_MASK_WORDS];
+
+    //Entradas de los clientes, direccionadas por PID con sondeo lineal.
+    CreditSlot slots[CREDIT_SLOTS];
+} CreditPage;
+
+/**
+ * Slot del anillo de memoria compartida del modo de baja latencia.
+*/
+typedef struct ShmRingSlot
+{
+    //Numero de secuencia del slot: vale 'pos' cuando esta libre para el productor de la posicion 'pos' y 'pos + 1' cuando el mensaje esta publicado.
+    atomic_uint sequence;
+
+    //Bytes de credito reservados por el productor para el mensaje.
+    int bytes;
+
+    //Mensaje publicado en el slot.
+    Message message;
+} ShmRingSlot;
+
+/**
+ * Anillo de memoria compartida del modo de baja latencia: multiples productores (clientes) y un unico consumidor (servidor).
+ * Los productores reservan posiciones incrementando 'head' y publican el mensaje actualizando la secuencia del slot; el
+ * consumidor espera activamente sobre el slot siguiente y, agotado su presupuesto de espera, se estaciona en un futex.
+*/
+typedef struct ShmRing
+{
+    //Proxima posicion a reservar por los productores.
+    _Alignas(64) atomic_uint head;
+
+    //Proxima posicion a consumir por el servidor.
+    _Alignas(64) atomic_uint tail;
+
+    //Palabra del futex: 1 si el consumidor esta estacionado y debe ser despertado por el productor.
+    _Alignas(64) atomic_int parked;
+
+    //Mensajes descartados por los productores al encontrar el anillo lleno.
+    atomic_long full;
+
+    //Cantidad de slots del anillo (potencia de 2). La fija el servidor segun el tamaño del segmento y los clientes la leen al conectarse.
+    unsigned int capacity;
+
+    //Slots del anillo.
+    _Alignas(64) ShmRingSlot slots[];
+} ShmRing;
+
+/**
+ * Entrada de la tabla de ultimos valores del archivo mapeado, protegida por un seqlock.
+*/
+typedef struct MappedSlot
+{
+    //Contador del seqlock: impar mientras el cliente escribe la entrada, par cuando la entrada es consistente.
+    atomic_uint sequence;
+
+    //Cliente dueño de la entrada: (pid << 32) | vid, 0 si la entrada esta libre.
+    atomic_ullong owner;
+
+    //Cabecera del ultimo valor publicado.
+    MsgHeader header;
+
+    //Longitud del ultimo valor publicado.
+    uint32_t len;
+
+    //Ultimo valor publicado.
+    char value[MAPPED_VALUE_MAX];
+} MappedSlot;
+
+/**
+ * Registro de la region de anexado del archivo mapeado.
+*/
+typedef struct MappedRecord
+{
+    //Estado del registro: 2 * pos + 1 mientras se escribe el registro de la posicion 'pos', 2 * pos + 2 cuando esta publicado.
+    atomic_ullong sequence;
+
+    //Cabecera de la actualizacion.
+    MsgHeader header;
+
+    //Longitud del valor.
+    uint32_t len;
+
+    //Valor publicado.
+    char value[MAPPED_VALUE_MAX];
+} MappedRecord;
+
+/**
+ * Contenido del archivo mapeado en memoria: una tabla de ultimos valores por cliente y una region de anexado circular
+ * con todas las actualizaciones. Los productores nunca esperan: si el lector se atrasa mas de MAPPED_APPEND_RECORDS
+ * registros, los registros mas viejos se sobreescriben.
+*/
+typedef struct MappedFile
+{
+    //Proxima posicion a reservar de la region de anexado.
+    _Alignas(64) atomic_ullong append_head;
+
+    //Tabla de ultimos valores, direccionada por cliente con sondeo lineal.
+    _Alignas(64) MappedSlot slots[MAPPED_SLOTS];
+
+    //Region de anexado.
+    MappedRecord records[MAPPED_APPEND_RECORDS];
+} MappedFile;
+
+//Valor que identifica a un archivo de traza de trafico ("IPCT").
+#define TRAFFIC_TRACE_MAGIC 0x54435049U
+
+/**
+ * Registro de una traza de trafico grabada por el servidor y reinyectada por la herramienta Replay.
+ * El archivo comienza con un entero de 32 bits con TRAFFIC_TRACE_MAGIC seguido de los registros.
+*/
+typedef struct TrafficRecord
+{
+    //Tiempo transcurrido desde el mensaje anterior de la traza, en nanosegundos.
+    uint64_t delta_ns;
+
+    //Canal por el que se recibio el mensaje.
+    uint16_t channel;
+
+    //Clase de prioridad del mensaje (solo MESSAGE_QUEUE, 0 en los demas canales).
+    uint16_t priority;
+
+    //Tamaño del mensaje en bytes, incluyendo el caracter nulo final.
+    uint32_t size;
+} TrafficRecord;
+
+//Valor que identifica a un archivo de eventos del trazador ("IPCE").
+#define EVENT_TRACE_MAGIC 0x45435049U
+
+/**
+ * Enumerado que define los eventos del ciclo de vida de un mensaje registrados por el trazador.
+*/
+typedef enum TraceEventType
+{
+    //Cliente: envio una solicitud de inicio de escritura.
+    TRACE_REQUEST,
+
+    //Servidor: otorgo el canal. Cliente: recibio la respuesta START_WRITE.
+    TRACE_GRANT,
+
+    //Servidor: respondio WAIT. Cliente: recibio la respuesta WAIT.
+    TRACE_WAIT,
+
+    //Cliente: escribio el mensaje en el canal.
+    TRACE_WRITE,
+
+    //Cliente: envio END_WRITE. Servidor: recibio END_WRITE.
+    TRACE_END_WRITE,
+
+    //Servidor: entrego el mensaje al pipeline.
+    TRACE_RECEIVE,
+
+    //Servidor: vencio el timer del canal. Cliente: no recibio respuesta a tiempo.
+    TRACE_TIMEOUT,
+
+    //Servidor: libero el canal al completar la escritura.
+    TRACE_RELEASE,
+
+    //Cantidad de tipos de eventos.
+    TRACE_EVENT_TYPES
+} TraceEventType;
+
+/**
+ * Evento registrado por el trazador. El archivo de eventos de un proceso comienza con una cabecera 'TraceFileHeader'
+ * seguida de los eventos de todos sus hilos.
+*/
+typedef struct TraceEvent
+{
+    //Instante (CLOCK_MONOTONIC) del evento, en nanosegundos; es comun a todos los procesos del equipo.
+    uint64_t timestamp;
+
+    //Hilo que registro el evento.
+    int32_t tid;
+
+    //Proceso del otro extremo: el cliente en los eventos del servidor, 0 en los del cliente.
+    int32_t peer;
+
+    //Cliente virtual del mensaje (0 si no corresponde).
+    uint32_t vid;
+
+    //Numero de secuencia del mensaje (0 si no corresponde).
+    uint32_t seq;
+
+    //Tipo de evento ('TraceEventType').
+    uint16_t type;
+
+    //Canal del evento.
+    uint16_t channel;
+
+    //Reservado, mantiene el evento en 32 bytes.
+    uint32_t reserved;
+} TraceEvent;
+
+/**
+ * Cabecera de un archivo de eventos del trazador.
+*/
+typedef struct TraceFileHeader
+{
+    //EVENT_TRACE_MAGIC.
+    uint32_t magic;
+
+    //Proceso que genero el archivo.
+    int32_t pid;
+
+    //Rol del proceso ("server" o "client").
+    char role[16];
+} TraceFileHeader;
+
 #endif //__COMMON_H__
\ No newline at end of file
@@ -0,0 +1,107 @@
+/**
+ * @file Config.h
+ * @author Bottini, Franco Nicolas.
+ * @brief Cabecera de la configuracion en tiempo de ejecucion, comun al Server y a los clientes.
+ * @version 1.0
+ * @date Marzo de 2023.
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef __CONFIG_H__
+#define __CONFIG_H__
+
+#include "Common.h"
+
+//Path por defecto del archivo de configuracion (se puede cambiar con la variable de entorno IPC_CONFIG).
+#define CONFIG_FILE_DEFAULT "ipc.conf"
+
+//Longitud maxima de un valor del archivo de configuracion.
+#define CONFIG_VALUE_MAX 256
+
+//Path por defecto a partir del cual se generan las claves de la memoria compartida y de la cola de mensajes (IPC_KEY_PATH).
+#define CONFIG_KEY_PATH "Server.c"
+
+//Identificador de proyecto por defecto de las claves de la memoria compartida y de la cola de mensajes (IPC_KEY_ID).
+#define CONFIG_KEY_ID 'B'
+
+/**
+ * @brief Carga el archivo de configuracion.
+ *
+ * El archivo (IPC_CONFIG o CONFIG_FILE_DEFAULT) contiene lineas 'CLAVE = valor' con los mismos nombres que las
+ * variables de entorno; las lineas vacias y las que comienzan con '#' se ignoran. Si el archivo no existe se utilizan
+ * los valores por defecto. Las claves desconocidas y las lineas mal formadas se informan y se ignoran.
+ *
+ * @return No devuelve ningun valor.
+*/
+void config_init(void);
+
+/**
+ * @brief Obtiene el valor de una clave de configuracion.
+ *
+ * La variable de entorno tiene prioridad sobre el archivo de configuracion. El valor devuelto puede cambiar con
+ * config_reload, por lo que debe copiarse si se necesita conservarlo.
+ *
+ * @param name Nombre de la clave.
+ *
+ * @return Valor de la clave, o NULL si no esta definida.
+*/
+const char* config_get(const char* name);
+
+/**
+ * @brief Obtiene el valor numerico de una clave de configuracion.
+ *
+ * @param name Nombre de la clave.
+ * @param fallback Valor por defecto.
+ * @param min Valor minimo admitido.
+ * @param max Valor maximo admitido.
+ *
+ * @return Valor de la clave, o 'fallback' si no esta definida o si no es un entero entre 'min' y 'max' (en ese caso se informa).
+*/
+long config_long(const char* name, long fallback, long min, long max);
+
+/**
+ * @brief Obtiene el valor numerico de una clave de configuracion que debe ser una potencia de 2 (tamaños de anillos).
+ *
+ * @param name Nombre de la clave.
+ * @param fallback Valor por defecto (potencia de 2).
+ * @param min Valor minimo admitido.
+ * @param max Valor maximo admitido.
+ *
+ * @return Valor de la clave, o 'fallback' si no esta definida o si no es una potencia de 2 entre 'min' y 'max' (en ese caso se informa).
+*/
+long config_pow2(const char* name, long fallback, long min, long max);
+
+/**
+ * @brief Obtiene el path de la FIFO del servidor (IPC_FIFO_NAME o FIFO_NAME).
+ *
+ * @return Path de la FIFO.
+*/
+const char* config_fifo_name(void);
+
+/**
+ * @brief Obtiene el path del archivo en donde el servidor publica su PID (IPC_PID_FILE o PID_SERVER_FILE).
+ *
+ * @return Path del archivo.
+*/
+const char* config_pid_file(void);
+
+/**
+ * @brief Genera la clave de la memoria compartida y de la cola de mensajes a partir de IPC_KEY_PATH e IPC_KEY_ID.
+ *
+ * @return Clave generada con ftok.
+*/
+key_t config_ipc_key(void);
+
+/**
+ * @brief Vuelve a leer el archivo de configuracion.
+ *
+ * Solo se aplican los cambios de las claves que admiten recarga; el resto se informa y conserva su valor hasta el proximo
+ * reinicio. Los cambios de las claves definidas en el entorno no tienen efecto, porque el entorno tiene prioridad.
+ *
+ * @return Cantidad de claves cuyo valor cambio.
+*/
+int config_reload(void);
+
+#endif //__CONFIG_H__
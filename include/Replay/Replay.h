@@ -0,0 +1,89 @@
+/**
+ * @file Replay.h
+ * @author Bottini, Franco Nicolas.
+ * @brief Cabecera de la herramienta de reinyeccion de trazas de trafico.
+ * @version 1.0
+ * @date Marzo de 2023.
+ * 
+ * @copyright Copyright (c) 2023
+ * 
+ */
+
+#ifndef __REPLAY_H__
+#define __REPLAY_H__
+
+#include <sys/wait.h>
+#include "Client.h"
+
+/**
+ * Resultado de la reinyeccion de un canal, enviado por cada proceso de reinyeccion al proceso principal.
+*/
+typedef struct ReplayReport
+{
+    //Canal reinyectado.
+    int channel;
+
+    //Cantidad de mensajes de la traza que corresponden al canal.
+    long scheduled;
+
+    //Cantidad de mensajes enviados con exito.
+    long sent;
+
+    //Cantidad de mensajes que no se pudieron enviar (sin creditos o sin respuesta del servidor).
+    long failed;
+
+    //Suma de los atrasos respecto del instante programado, en nanosegundos.
+    int64_t lag_sum_ns;
+
+    //Maximo atraso respecto del instante programado, en nanosegundos.
+    int64_t lag_max_ns;
+
+    //Tiempo total que demoro la reinyeccion del canal, en nanosegundos.
+    int64_t elapsed_ns;
+} ReplayReport;
+
+/**
+ * @brief Imprime en la consola información sobre los argumentos de entrada requeridos. 
+ * 
+ * @return No devuelve ningún valor.
+ */
+void print_replay_help(void);
+
+/**
+ * @brief Carga en memoria una traza de trafico grabada por el servidor.
+ * 
+ * Si el archivo no existe o no es una traza valida, la función muestra un mensaje de error y termina el programa.
+ * 
+ * @param path Path del archivo de la traza.
+ * 
+ * @return No devuelve ningún valor.
+ */
+void load_trace(const char* path);
+
+/**
+ * @brief Reinyecta los mensajes de la traza que corresponden a un canal.
+ * 
+ * Se ejecuta en un proceso propio por canal: crea un cliente del canal y envia cada mensaje de la traza en el instante
+ * programado (escalado por la velocidad de reinyeccion), con el tamaño y la prioridad grabados.
+ * 
+ * @param channel_type Canal a reinyectar.
+ * @param server_pid PID del servidor.
+ * @param start Instante de comienzo de la reinyeccion, comun a todos los canales.
+ * @param report File descriptor donde se escribe el ReplayReport del canal.
+ * 
+ * @return No devuelve ningún valor.
+ */
+void replay_channel(ChannelType channel_type, int server_pid, const struct timespec* start, int report);
+
+/**
+ * @brief Imprime en la consola el resultado de la reinyeccion.
+ * 
+ * @param reports Resultados de cada canal.
+ * @param count Cantidad de resultados.
+ * @param elapsed_ns Tiempo total de la reinyeccion, en nanosegundos.
+ * 
+ * @return No devuelve ningún valor.
+ */
+void print_replay_report(const ReplayReport* reports, int count, int64_t elapsed_ns);
+
+#endif //__REPLAY_H__
@@ -0,0 +1,167 @@
+/**
+ * @file Aggregator.h
+ * @author Bottini, Franco Nicolas.
+ * @brief Cabecera de la agregacion de lecturas numericas del Server IPC.
+ * @version 1.0
+ * @date Marzo de 2023.
+ * 
+ * @copyright Copyright (c) 2023
+ * 
+ */
+
+#ifndef __AGGREGATOR_H__
+#define __AGGREGATOR_H__
+
+#include "Common.h"
+
+//Duracion (en segundos) de cada ventana fija de agregacion.
+#define AGG_WINDOW_SEC 10
+
+//Cantidad de entradas de la tabla de agregados por cliente (potencia de 2).
+#define AGG_TABLE_SIZE 16384
+
+//Cantidad maxima de clientes en la tabla, por debajo de su tamaño para que toda busqueda termine en una entrada libre.
+#define AGG_TABLE_LOAD (AGG_TABLE_SIZE / 4 * 3)
+
+//Tiempo sin lecturas tras el cual se verifica si el proceso de un cliente termino, para liberar su entrada.
+#define AGG_IDLE_CHECK_MS 1000
+
+//Tiempo sin lecturas tras el cual se libera la entrada de un cliente aunque su proceso siga activo (mas de dos ventanas).
+#define AGG_EVICT_MS (3 * AGG_WINDOW_SEC * 1000)
+
+//Cantidad de entradas de la tabla que se revisan en cada lectura agregada.
+#define AGG_SWEEP_STEP 4
+
+//Sub-buckets por potencia de 2 del sketch de cuantiles (error relativo maximo ~ 1/AGG_SKETCH_SUBBUCKETS).
+#define AGG_SKETCH_SUBBUCKETS 16
+
+//Menor exponente binario representable por el sketch, valores menores en modulo caen en el bucket del cero.
+#define AGG_SKETCH_MIN_EXP -16
+
+//Cantidad de exponentes binarios representables por el sketch.
+#define AGG_SKETCH_EXPONENTS 64
+
+//Cantidad de buckets del sketch por signo.
+#define AGG_SKETCH_BUCKETS (AGG_SKETCH_EXPONENTS * AGG_SKETCH_SUBBUCKETS)
+
+/**
+ * Sketch de cuantiles log-lineal: cada potencia de 2 se divide en AGG_SKETCH_SUBBUCKETS buckets de igual ancho.
+ * Dos sketches se combinan sumando sus buckets (sketch_merge), por lo que el sketch del total es la union de los de los canales.
+*/
+typedef struct QuantileSketch
+{
+    //Buckets de los valores positivos.
+    uint32_t positive[AGG_SKETCH_BUCKETS];
+
+    //Buckets de los valores negativos (indexados por modulo).
+    uint32_t negative[AGG_SKETCH_BUCKETS];
+
+    //Cantidad de valores cuyo modulo es menor al menor exponente representable.
+    uint32_t zero;
+
+    //Cantidad total de valores.
+    uint64_t count;
+} QuantileSketch;
+
+/**
+ * Resumen de las lecturas de una ventana: suma, minimo, maximo y cantidad.
+*/
+typedef struct AggSummary
+{
+    //Cantidad de lecturas.
+    long count;
+
+    //Suma de las lecturas.
+    double sum;
+
+    //Menor lectura.
+    double min;
+
+    //Mayor lectura.
+    double max;
+} AggSummary;
+
+/**
+ * @brief Interpreta un mensaje como una lectura numerica.
+ * 
+ * Los enteros se convierten de a 8 digitos por vez (SWAR); los numeros con parte decimal o exponente usan strtod.
+ * 
+ * @param msg Mensaje a interpretar.
+ * @param len Longitud del mensaje.
+ * @param value Lectura obtenida.
+ * 
+ * @return 1 si el mensaje es una lectura numerica. 0 en caso contrario.
+*/
+int parse_reading(const char* msg, size_t len, double* value);
+
+/**
+ * @brief Agrega un mensaje a los resumenes de su cliente y de su canal.
+ * 
+ * Interpreta el mensaje una unica vez y actualiza la suma, el minimo, el maximo y la cantidad de lecturas de la ventana actual,
+ * ademas del sketch de cuantiles del canal. Al cumplirse AGG_WINDOW_SEC segundos la ventana se cierra y se publica.
+ * 
+ * @param channel_type Canal por el que se recibio el mensaje.
+ * @param pid ID del proceso que envio el mensaje.
+ * @param vid Identificador del cliente virtual que envio el mensaje.
+ * @param msg Mensaje recibido.
+ * @param len Longitud del mensaje.
+ * 
+ * @return No devuelve ningun valor.
+*/
+void aggregate_msg(ChannelType channel_type, pid_t pid, uint32_t vid, const char* msg, size_t len);
+
+/**
+ * @brief Agrega una lectura ya interpretada a los resumenes de su cliente y de su canal.
+ * 
+ * Cada cliente (proceso y cliente virtual) tiene su propia entrada; las de clientes terminados o inactivos se liberan de a poco.
+ * 
+ * @param channel_type Canal por el que se recibio el mensaje.
+ * @param pid ID del proceso que envio el mensaje.
+ * @param vid Identificador del cliente virtual que envio el mensaje.
+ * @param value Lectura del mensaje, NULL si el mensaje no es una lectura numerica.
+ * 
+ * @return No devuelve ningun valor.
+*/
+void aggregate_reading(ChannelType channel_type, pid_t pid, uint32_t vid, const double* value);
+
+/**
+ * @brief Suma los buckets de un sketch a otro.
+ * 
+ * @param dst Sketch destino.
+ * @param src Sketch a sumar.
+ * 
+ * @return No devuelve ningun valor.
+*/
+void sketch_merge(QuantileSketch* dst, const QuantileSketch* src);
+
+/**
+ * @brief Obtiene un cuantil aproximado de un sketch.
+ * 
+ * @param sketch Sketch a consultar.
+ * @param q Cuantil buscado, entre 0 y 1.
+ * 
+ * @return Valor aproximado del cuantil. 0 si el sketch esta vacio.
+*/
+double sketch_quantile(const QuantileSketch* sketch, double q);
+
+/**
+ * @brief Cierra la ventana actual si corresponde y copia los agregados a la instantanea que imprime print_aggregate_stats.
+ * 
+ * Debe llamarse con el lock del servidor tomado; la impresion se hace despues, fuera del lock.
+ * 
+ * @return No devuelve ningun valor.
+*/
+void snapshot_aggregates(void);
+
+/**
+ * @brief Imprime por un determinado output los agregados de la ultima ventana cerrada y de la ventana actual, segun la ultima instantanea.
+ * 
+ * Los agregados por canal y su total se imprimen siempre; los agregados por cliente solo en el archivo de estadisticas.
+ * 
+ * @param fp File descriptor del archivo de salida.
+ * 
+ * @return No devuelve ningun valor.
+*/
+void print_aggregate_stats(FILE *fp);
+
+#endif //__AGGREGATOR_H__
@@ -0,0 +1,105 @@
+/**
+ * @file Credits.h
+ * @author Bottini, Franco Nicolas.
+ * @brief Cabecera del control de flujo basado en creditos del Server IPC.
+ * @version 1.0
+ * @date Marzo de 2023.
+ * 
+ * @copyright Copyright (c) 2023
+ * 
+ */
+
+#ifndef __CREDITS_H__
+#define __CREDITS_H__
+
+#include "Common.h"
+#include "Config.h"
+
+/**
+ * @brief Crea la pagina de control de creditos compartida con los clientes.
+ * 
+ * En un reinicio en caliente se adopta la pagina del servidor anterior sin reiniciarla, conservando las entradas de los clientes.
+ * Si la creación o la asignación del segmento de memoria compartida fallan, la función muestra un mensaje de error y termina el programa.
+ * 
+ * @return No devuelve ningun valor.
+*/
+void create_credit_page(void);
+
+/**
+ * @brief Registra los creditos reservados por la solicitud que recibio el acceso a un canal.
+ * 
+ * @param channel_type Canal otorgado.
+ * @param pid ID del proceso al que se le otorgo el canal.
+ * @param bytes Bytes reservados por el cliente para el mensaje.
+ * 
+ * @return No devuelve ningun valor.
+*/
+void lease_credits(ChannelType channel_type, pid_t pid, int bytes);
+
+/**
+ * @brief Devuelve los creditos de la solicitud que ocupaba un canal.
+ * 
+ * Se invoca cuando el servidor termina de procesar el mensaje del canal o cuando se produce un timeout.
+ * Ajusta ademas la ventana de creditos: crece de forma aditiva con cada mensaje drenado y se reduce a la mitad con cada timeout.
+ * 
+ * @param channel_type Canal liberado.
+ * @param timeout 1 si el canal se libero por timeout. 0 en caso contrario.
+ * 
+ * @return No devuelve ningun valor.
+*/
+void release_lease(ChannelType channel_type, int timeout);
+
+/**
+ * @brief Devuelve los creditos de una solicitud rechazada (respuesta WAIT).
+ * 
+ * @param pid ID del proceso que envio la solicitud.
+ * @param bytes Bytes reservados por el cliente para el mensaje.
+ * 
+ * @return No devuelve ningun valor.
+*/
+void release_credits(pid_t pid, int bytes);
+
+/**
+ * @brief Obtiene el peso que un cliente declaro en su entrada de la pagina de control.
+ * 
+ * @param pid ID del proceso del cliente.
+ * 
+ * @return Peso del cliente (1..GRANT_WEIGHT_MAX), o 1 si el cliente no registro una entrada.
+*/
+int get_client_weight(pid_t pid);
+
+/**
+ * @brief Obtiene la cantidad de señales de control que los clientes no pudieron encolar.
+ * 
+ * @return Cantidad de desbordes de la cola de señales informados por los clientes.
+*/
+long get_client_signal_overflows(void);
+
+/**
+ * @brief Publica en la pagina de control los CPUs reservados para los hilos del servidor.
+ * 
+ * Los clientes leen la mascara al adjuntar la pagina y excluyen esos CPUs de su afinidad.
+ * 
+ * @param mask Mascara de CPUs reservados (vacia para no aislar a los clientes).
+ * 
+ * @return No devuelve ningun valor.
+*/
+void publish_isolated_cpus(const uint64_t mask[CPU_MASK_WORDS]);
+
+/**
+ * @brief Imprime por un determinado output el estado del control de flujo.
+ * 
+ * @param fp File descriptor del archivo de salida.
+ * 
+ * @return No devuelve ningun valor.
+*/
+void print_credit_stats(FILE *fp);
+
+/**
+ * @brief Elimina la pagina de control de creditos (durante una entrega en caliente solo se desvincula).
+ * 
+ * @return No devuelve ningun valor.
+*/
+void remove_credit_page(void);
+
+#endif //__CREDITS_H__
@@ -0,0 +1,96 @@
+/**
+ * @file Dashboard.h
+ * @author Bottini, Franco Nicolas.
+ * @brief Cabecera del tablero de estadisticas de refresco fijo del Server IPC.
+ * @version 1.0
+ * @date Marzo de 2023.
+ * 
+ * @copyright Copyright (c) 2023
+ * 
+ */
+
+#ifndef __DASHBOARD_H__
+#define __DASHBOARD_H__
+
+#include "Common.h"
+#include "Config.h"
+
+//Periodo de refresco por defecto del tablero, en milisegundos.
+#define DASHBOARD_PERIOD_MS 500
+
+//Cantidad de buckets del histograma de latencias de cada canal (4 sub-buckets por potencia de 2 de microsegundos).
+#define DASHBOARD_LATENCY_BUCKETS 128
+
+//Cantidad de mensajes muestreados que se conservan para mostrar en el tablero.
+#define DASHBOARD_RECENT 5
+
+/**
+ * @brief Inicializa el tablero e inicia su hilo de refresco.
+ * 
+ * El periodo de refresco se configura con IPC_DASHBOARD_MS (0 deshabilita el tablero y vuelve a imprimir las estadisticas
+ * con cada mensaje). Con IPC_VERBOSE_SAMPLE=N se muestra uno de cada N mensajes recibidos.
+ * Si el hilo no se puede crear, la función muestra un mensaje de error y termina el programa.
+ * 
+ * @return No devuelve ningun valor.
+*/
+void dashboard_init(void);
+
+/**
+ * @brief Aplica el periodo de refresco (IPC_DASHBOARD_MS) y el muestreo de mensajes (IPC_VERBOSE_SAMPLE) del tablero.
+ * 
+ * Se invoca al iniciar el tablero y al recargar la configuracion. El tablero solo se habilita o deshabilita al iniciar el
+ * servidor: al recargar, un periodo 0 (o un periodo distinto de 0 con el tablero deshabilitado) se informa y se ignora.
+ * 
+ * @return No devuelve ningun valor.
+*/
+void dashboard_configure(void);
+
+/**
+ * @brief Indica si el tablero esta habilitado.
+ * 
+ * @return 1 si el tablero esta habilitado, 0 si las estadisticas se imprimen con cada mensaje.
+*/
+int dashboard_enabled(void);
+
+/**
+ * @brief Registra en la instantanea del tablero un mensaje recibido o un timeout.
+ * 
+ * Si el mensaje cae en el muestreo configurado, se conserva para mostrarlo en el tablero.
+ * 
+ * @param channel_type Canal del mensaje.
+ * @param pid ID del proceso que envio el mensaje o que ocupaba el canal.
+ * @param msg Mensaje recibido (NULL si es un timeout).
+ * @param timeout 1 si la conexion termino en timeout, 0 en caso contrario.
+ * 
+ * @return No devuelve ningun valor.
+*/
+void dashboard_record(ChannelType channel_type, pid_t pid, const char* msg, int timeout);
+
+/**
+ * @brief Registra en el histograma del canal la latencia de entrega de un mensaje.
+ * 
+ * @param channel_type Canal del mensaje.
+ * @param sent Instante (CLOCK_MONOTONIC) en que el cliente envio el mensaje.
+ * 
+ * @return No devuelve ningun valor.
+*/
+void dashboard_latency(ChannelType channel_type, const struct timespec* sent);
+
+/**
+ * @brief Actualiza en la instantanea del tablero el proceso que ocupa un canal.
+ * 
+ * @param channel_type Canal.
+ * @param pid ID del proceso que ocupa el canal (0 si el canal esta libre).
+ * 
+ * @return No devuelve ningun valor.
+*/
+void dashboard_lock_holder(ChannelType channel_type, pid_t pid);
+
+/**
+ * @brief Detiene el hilo de refresco y escribe por ultima vez las estadisticas.
+ * 
+ * @return No devuelve ningun valor.
+*/
+void dashboard_close(void);
+
+#endif //__DASHBOARD_H__
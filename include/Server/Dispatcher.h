@@ -0,0 +1,118 @@
+/**
+ * @file Dispatcher.h
+ * @author Bottini, Franco Nicolas.
+ * @brief Cabecera del despachador de eventos del Server IPC.
+ * @version 1.0
+ * @date Marzo de 2023.
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef __DISPATCHER_H__
+#define __DISPATCHER_H__
+
+#include "Common.h"
+#include "Config.h"
+
+//Cantidad maxima de fuentes registradas en el despachador.
+#define DISPATCH_SOURCES_MAX 16
+
+//Cantidad maxima de eventos que una fuente atiende por turno antes de ceder el turno a la siguiente (IPC_DISPATCH_BUDGET puede reducirla).
+#define DISPATCH_BUDGET 32
+
+/**
+ * Fuente de eventos registrada en el despachador: un file descriptor que epoll informa como listo para leer
+ * y la funcion que atiende los eventos pendientes de esa fuente.
+*/
+typedef struct DispatchSource
+{
+    //Nombre de la fuente, utilizado en las estadisticas.
+    const char* name;
+
+    //File descriptor que indica que la fuente tiene eventos pendientes.
+    int fd;
+
+    //Atiende hasta 'budget' eventos de la fuente y devuelve cuantos atendio.
+    int (*drain)(struct DispatchSource* source, int budget);
+
+    //Dato propio de la fuente (por ejemplo, el canal al que pertenece).
+    long context;
+
+    //Turnos en los que la fuente estuvo lista.
+    long turns;
+
+    //Eventos atendidos.
+    long handled;
+
+    //Turnos en los que la fuente agoto su presupuesto y quedo con eventos pendientes.
+    long exhausted;
+} DispatchSource;
+
+/**
+ * @brief Crea la instancia de epoll del despachador.
+ *
+ * Si la creación falla, la función muestra un mensaje de error y termina el programa.
+ *
+ * @return No devuelve ningun valor.
+*/
+void dispatcher_init(void);
+
+/**
+ * @brief Aplica el presupuesto de eventos por turno de cada fuente (IPC_DISPATCH_BUDGET, 1..DISPATCH_BUDGET).
+ *
+ * Se invoca al crear el despachador y al recargar la configuracion.
+ *
+ * @return No devuelve ningun valor.
+*/
+void dispatcher_configure(void);
+
+/**
+ * @brief Registra una fuente en el despachador.
+ *
+ * La fuente se registra por nivel (level-triggered): mientras tenga eventos pendientes vuelve a aparecer como lista.
+ * Una fuente que agota su presupuesto se atiende tambien en la vuelta siguiente aunque epoll no la informe, ya que
+ * puede tener eventos retenidos fuera de su file descriptor (por ejemplo, un timbre eventfd ya leido).
+ * Si el registro falla, la función muestra un mensaje de error y termina el programa.
+ *
+ * @param source Fuente a registrar. Debe permanecer valida mientras el despachador este en ejecucion.
+ *
+ * @return No devuelve ningun valor.
+*/
+void dispatcher_register(DispatchSource* source);
+
+/**
+ * @brief Ejecuta el bucle del despachador hasta que se invoque dispatcher_stop.
+ *
+ * En cada vuelta espera a que alguna fuente este lista y atiende las fuentes listas en round-robin, comenzando
+ * por una fuente distinta en cada vuelta y con un presupuesto de DISPATCH_BUDGET eventos por fuente, de modo que
+ * una fuente con mucho trafico no posterga a las demas.
+ *
+ * @return No devuelve ningun valor.
+*/
+void dispatcher_run(void);
+
+/**
+ * @brief Indica al bucle del despachador que debe terminar al finalizar la vuelta actual.
+ *
+ * @return No devuelve ningun valor.
+*/
+void dispatcher_stop(void);
+
+/**
+ * @brief Imprime por un determinado output las estadisticas del despachador.
+ *
+ * @param fp File descriptor del archivo de salida.
+ *
+ * @return No devuelve ningun valor.
+*/
+void print_dispatcher_stats(FILE *fp);
+
+/**
+ * @brief Cierra la instancia de epoll del despachador.
+ *
+ * @return No devuelve ningun valor.
+*/
+void dispatcher_close(void);
+
+#endif //__DISPATCHER_H__
@@ -0,0 +1,129 @@
+/**
+ * @file HotRestart.h
+ * @author Bottini, Franco Nicolas.
+ * @brief Cabecera del reinicio en caliente del Server IPC.
+ * @version 1.0
+ * @date Marzo de 2023.
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef __HOT_RESTART_H__
+#define __HOT_RESTART_H__
+
+#include "Common.h"
+#include "Config.h"
+
+//Señal con la que el nuevo servidor pide al servidor en ejecucion que le entregue los recursos IPC.
+#define SIGNAL_HANDOFF SIGUSR2
+
+//Tiempo maximo que el nuevo servidor espera a que el servidor anterior complete la entrega.
+#define RESTART_TIMEOUT_MS 5000
+
+//Bytes reservados en la region de estado para las secciones que se traspasan entre procesos.
+#define RESTART_DATA_SIZE (1 << 20)
+
+/**
+ * Secciones de estado que el servidor saliente guarda para el servidor entrante.
+*/
+typedef enum RestartSection
+{
+    //Contadores de mensajes por canal.
+    RESTART_STATS,
+
+    //Estadisticas de los carriles de prioridad de la cola de mensajes.
+    RESTART_LANES,
+
+    //Tabla de numeros de secuencia de los clientes.
+    RESTART_SEQUENCES,
+
+    //Bytes leidos de la FIFO que todavia no formaban un mensaje completo.
+    RESTART_FIFO_STREAM,
+
+    //Proximo registro a consumir del archivo mapeado en modo append.
+    RESTART_MAPPED_TAIL,
+
+    //Cantidad de secciones.
+    RESTART_SECTIONS
+} RestartSection;
+
+/**
+ * @brief Inicializa la region de estado del reinicio en caliente.
+ *
+ * Con IPC_HOT_RESTART=1 se adjunta a la region creada por el servidor en ejecucion; en caso contrario crea una region
+ * nueva. Si se pide un reinicio en caliente y no hay un servidor en ejecucion, o si se inicia un servidor normal
+ * habiendo otro en ejecucion, la función muestra un mensaje de error y termina el programa.
+ *
+ * @return No devuelve ningun valor.
+*/
+void hot_restart_init(void);
+
+/**
+ * @brief Pide al servidor en ejecucion que entregue los recursos IPC y espera a que termine.
+ *
+ * Solo tiene efecto en un reinicio en caliente. Debe invocarse con la FIFO ya abierta, para que su contenido no se
+ * pierda cuando el servidor anterior la cierre. Si la entrega no se completa en RESTART_TIMEOUT_MS, la función muestra
+ * un mensaje de error y termina el programa.
+ *
+ * @return No devuelve ningun valor.
+*/
+void hot_restart_handoff(void);
+
+/**
+ * @brief Indica si el servidor adopta los recursos IPC de un servidor anterior.
+ *
+ * @return 1 si el servidor se inicio con un reinicio en caliente. 0 en caso contrario.
+*/
+int hot_restart_adopting(void);
+
+/**
+ * @brief Registra la solicitud de entrega recibida del nuevo servidor.
+ *
+ * @param sender ID del proceso que envio la señal; solo se acepta el servidor que se registro como sucesor.
+ *
+ * @return 1 si la solicitud fue aceptada. 0 en caso contrario.
+*/
+int hot_restart_request(pid_t sender);
+
+/**
+ * @brief Indica si el servidor esta entregando sus recursos IPC a un sucesor.
+ *
+ * Durante la entrega el servidor deja de otorgar los canales y, al terminar, conserva los recursos IPC en lugar de eliminarlos.
+ *
+ * @return 1 si hay una entrega en curso. 0 en caso contrario.
+*/
+int hot_restart_handing_off(void);
+
+/**
+ * @brief Guarda una seccion de estado en la region para el servidor entrante.
+ *
+ * @param section Seccion a guardar.
+ * @param data Datos de la seccion.
+ * @param size Bytes de la seccion.
+ *
+ * @return No devuelve ningun valor.
+*/
+void restart_save(RestartSection section, const void* data, size_t size);
+
+/**
+ * @brief Recupera una seccion de estado guardada por el servidor anterior.
+ *
+ * @param section Seccion a recuperar.
+ * @param data Destino de los datos.
+ * @param capacity Bytes disponibles en el destino.
+ *
+ * @return Bytes recuperados, o 0 si la seccion no se guardo o no entra en el destino.
+*/
+size_t restart_load(RestartSection section, void* data, size_t capacity);
+
+/**
+ * @brief Libera la region de estado.
+ *
+ * Si hay una entrega en curso marca la entrega como completa y conserva la region para el sucesor; en caso contrario la elimina.
+ *
+ * @return No devuelve ningun valor.
+*/
+void hot_restart_close(void);
+
+#endif //__HOT_RESTART_H__
@@ -0,0 +1,140 @@
+/**
+ * @file Journal.h
+ * @author Bottini, Franco Nicolas.
+ * @brief Cabecera del journal de mensajes del Server IPC.
+ * @version 1.0
+ * @date Marzo de 2023.
+ * 
+ * @copyright Copyright (c) 2023
+ * 
+ */
+
+#ifndef __JOURNAL_H__
+#define __JOURNAL_H__
+
+#include <stdint.h>
+#include "Common.h"
+#include "Config.h"
+
+//Tamaño de cada segmento del journal (preasignado y mapeado en memoria).
+#define JOURNAL_SEGMENT_SIZE (16 * 1024 * 1024)
+
+//Cantidad de registros entre dos entradas consecutivas del indice.
+#define JOURNAL_INDEX_STRIDE 256
+
+//Cantidad de mensajes por defecto que se agrupan en una sincronizacion a disco.
+#define JOURNAL_SYNC_MSGS 64
+
+//Tiempo maximo por defecto (en milisegundos) que un registro permanece sin sincronizar.
+#define JOURNAL_SYNC_MS 10
+
+//Valor que identifica el comienzo de un registro valido dentro de un segmento.
+#define JOURNAL_MAGIC 0x4A4F524EU
+
+/**
+ * Cabecera binaria de cada registro del journal. A continuacion se almacena el mensaje, alineado a 8 bytes.
+*/
+typedef struct JournalRecord
+{
+    //Marca de registro valido (JOURNAL_MAGIC). Un valor 0 indica el final de los datos del segmento.
+    uint32_t magic;
+
+    //Longitud del mensaje en bytes.
+    uint32_t length;
+
+    //Numero de secuencia del registro dentro del journal, continuo entre segmentos y entre ejecuciones del servidor.
+    uint64_t seq;
+
+    //Instante (CLOCK_MONOTONIC, en nanosegundos) en que el cliente envio el mensaje. 0 si el canal no lo informa.
+    int64_t sent_ns;
+
+    //Instante (CLOCK_MONOTONIC, en nanosegundos) en que el servidor recibio el mensaje.
+    int64_t recv_ns;
+
+    //ID del proceso que envio el mensaje.
+    int32_t pid;
+
+    //Canal por el que se recibio el mensaje.
+    uint16_t channel;
+
+    //Reservado, siempre 0.
+    uint16_t reserved;
+
+    //Identificador del cliente virtual que envio el mensaje (0 para un cliente independiente).
+    uint32_t vid;
+
+    //Numero de secuencia del mensaje dentro del cliente (el de su cabecera).
+    uint32_t client_seq;
+} JournalRecord;
+
+/**
+ * Entrada del indice del journal: permite ubicar un registro sin recorrer los segmentos completos.
+*/
+typedef struct JournalIndexEntry
+{
+    //Numero de segmento que contiene el registro.
+    uint32_t segment;
+
+    //Desplazamiento del registro dentro del segmento.
+    uint32_t offset;
+
+    //Numero de secuencia del registro.
+    uint64_t seq;
+
+    //Instante de recepcion del registro (CLOCK_MONOTONIC, en nanosegundos).
+    int64_t recv_ns;
+} JournalIndexEntry;
+
+/**
+ * @brief Inicializa el journal de mensajes.
+ * 
+ * El journal es opcional: solo se habilita si se define la variable de entorno IPC_JOURNAL_DIR con el directorio donde se
+ * guardan los segmentos y el indice. La politica de sincronizacion se configura con IPC_JOURNAL_SYNC_MSGS e IPC_JOURNAL_SYNC_MS.
+ * La numeracion de los registros continua la del journal existente en el directorio, y la sincronizacion a disco la realiza
+ * un hilo propio. Si el journal no se puede crear, la función muestra un mensaje de error y termina el programa.
+ * 
+ * @return No devuelve ningun valor.
+*/
+void journal_init(void);
+
+/**
+ * @brief Aplica la politica de sincronizacion del journal (IPC_JOURNAL_SYNC_MSGS e IPC_JOURNAL_SYNC_MS).
+ * 
+ * Se invoca al habilitar el journal y al recargar la configuracion; el hilo de sincronizacion aplica el nuevo periodo.
+ * 
+ * @return No devuelve ningun valor.
+*/
+void journal_configure(void);
+
+/**
+ * @brief Agrega un mensaje al journal.
+ * 
+ * El registro se copia en el segmento mapeado en memoria y la funcion no espera al disco: el hilo de sincronizacion escribe
+ * los registros en grupo cada IPC_JOURNAL_SYNC_MSGS mensajes o IPC_JOURNAL_SYNC_MS milisegundos, y cierra los segmentos completos.
+ * 
+ * @param channel_type Canal por el que se recibio el mensaje.
+ * @param header Cabecera del mensaje (proceso, cliente virtual, secuencia e instante de envio).
+ * @param msg Mensaje recibido.
+ * @param len Longitud del mensaje en bytes.
+ * 
+ * @return No devuelve ningun valor.
+*/
+void journal_append(ChannelType channel_type, const MsgHeader* header, const char* msg, size_t len);
+
+/**
+ * @brief Imprime por un determinado output las estadisticas del journal.
+ * 
+ * @param fp File descriptor del archivo de salida.
+ * 
+ * @return No devuelve ningun valor.
+*/
+void print_journal_stats(FILE *fp);
+
+/**
+ * @brief Detiene el hilo de sincronizacion, sincroniza y cierra el journal.
+ * 
+ * @return No devuelve ningun valor.
+*/
+void journal_close(void);
+
+#endif //__JOURNAL_H__
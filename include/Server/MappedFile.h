@@ -0,0 +1,73 @@
+/**
+ * @file MappedFile.h
+ * @author Bottini, Franco Nicolas.
+ * @brief Cabecera del canal de archivo mapeado en memoria del Server IPC.
+ * @version 1.0
+ * @date Marzo de 2023.
+ * 
+ * @copyright Copyright (c) 2023
+ * 
+ */
+
+#ifndef __MAPPED_FILE_H__
+#define __MAPPED_FILE_H__
+
+#include "Common.h"
+#include "Config.h"
+
+//Periodo de muestreo por defecto del archivo mapeado, en milisegundos.
+#define MAPPED_SAMPLE_MS 100
+
+//Cada cuantos muestreos se liberan las entradas de clientes que ya no existen.
+#define MAPPED_REAP_SAMPLES 50
+
+/**
+ * Modo de consumo del archivo mapeado.
+*/
+typedef enum MappedMode
+{
+    //Se entrega al pipeline solo el ultimo valor de cada cliente que cambio desde el muestreo anterior.
+    MAPPED_LATEST,
+
+    //Se entregan al pipeline todas las actualizaciones de la region de anexado.
+    MAPPED_APPEND
+} MappedMode;
+
+/**
+ * @brief Crea el archivo mapeado en memoria e inicia su hilo de muestreo.
+ * 
+ * El archivo se crea en IPC_MAPPED_FILE (por defecto MAPPED_FILE_NAME) y se muestrea cada IPC_MAPPED_SAMPLE_MS milisegundos.
+ * Con IPC_MAPPED_MODE=append se consumen todas las actualizaciones en lugar del ultimo valor de cada cliente.
+ * En un reinicio en caliente el archivo se adopta sin truncarlo, de modo que los clientes conservan su mapeo.
+ * Si la creación del archivo o del hilo fallan, la función muestra un mensaje de error y termina el programa.
+ * 
+ * @return No devuelve ningun valor.
+*/
+void mapped_file_init(void);
+
+/**
+ * @brief Aplica el periodo de muestreo del archivo mapeado (IPC_MAPPED_SAMPLE_MS).
+ * 
+ * Se invoca al crear el archivo mapeado y al recargar la configuracion; el nuevo periodo rige desde el proximo muestreo.
+ * 
+ * @return No devuelve ningun valor.
+*/
+void mapped_file_configure(void);
+
+/**
+ * @brief Imprime por un determinado output las estadisticas del archivo mapeado.
+ * 
+ * @param fp File descriptor del archivo de salida.
+ * 
+ * @return No devuelve ningun valor.
+*/
+void print_mapped_stats(FILE *fp);
+
+/**
+ * @brief Detiene el hilo de muestreo y elimina el archivo mapeado (durante una entrega en caliente lo conserva).
+ * 
+ * @return No devuelve ningun valor.
+*/
+void mapped_file_close(void);
+
+#endif //__MAPPED_FILE_H__
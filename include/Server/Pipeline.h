@@ -0,0 +1,193 @@
+/**
+ * @file Pipeline.h
+ * @author Bottini, Franco Nicolas.
+ * @brief Cabecera del pipeline de procesamiento de mensajes del Server IPC.
+ * @version 1.0
+ * @date Marzo de 2023.
+ * 
+ * @copyright Copyright (c) 2023
+ * 
+ */
+
+#ifndef __PIPELINE_H__
+#define __PIPELINE_H__
+
+#include <pthread.h>
+#include <semaphore.h>
+#include "Common.h"
+#include "Config.h"
+#include "Checksum.h"
+
+//Cantidad maxima de mensajes de un lote (IPC_PIPELINE_BATCH puede reducir los lotes que arman los hilos del servidor).
+#define PIPELINE_BATCH_MAX 32
+
+//Cantidad maxima de etapas registradas.
+#define PIPELINE_MAX_STAGES 16
+
+//Capacidad por defecto de la cola acotada de cada etapa asincronica (IPC_PIPELINE_QUEUE_SIZE, potencia de 2).
+#define PIPELINE_QUEUE_SIZE 1024
+
+//Cantidad de hilos del servidor que entregan lotes al pipeline (despachador, consumidor del anillo y muestreo del archivo mapeado).
+#define PIPELINE_PRODUCERS 3
+
+//Pipeline utilizado cuando no se define la variable de entorno IPC_PIPELINE.
+#define PIPELINE_DEFAULT "decode,filter,sequence,aggregate,stats,journal,record"
+
+/**
+ * Vista de un mensaje recibido. Apunta directamente al buffer de recepcion del canal (o al segmento de memoria compartida),
+ * por lo que solo es valida hasta que el pipeline la libera; las etapas asincronicas reciben una copia propia.
+*/
+typedef struct MsgView MsgView;
+
+/**
+ * Funcion que devuelve al canal el espacio ocupado por una vista, por ejemplo el slot de memoria compartida a los productores.
+*/
+typedef void (*ViewRelease)(const MsgView* view);
+
+struct MsgView
+{
+    //Canal por el que se recibio el mensaje.
+    ChannelType channel;
+
+    //Clase de prioridad del mensaje (solo MESSAGE_QUEUE, 0 en los demas canales).
+    int priority;
+
+    //Cabecera del mensaje.
+    const MsgHeader* header;
+
+    //Contenido del mensaje.
+    const char* msg;
+
+    //Longitud del mensaje, sin el caracter nulo final.
+    size_t len;
+
+    //1 si la etapa 'decode' interpreto el mensaje.
+    int decoded;
+
+    //1 si el mensaje es una lectura numerica (valido si 'decoded' es 1).
+    int numeric;
+
+    //Lectura numerica del mensaje (valido si 'numeric' es 1).
+    double value;
+
+    //1 si una etapa descarto el mensaje; las etapas siguientes lo ignoran.
+    int dropped;
+
+    //1 si la vista es una muestra del ultimo valor de un cliente y no cada una de sus actualizaciones (los huecos de secuencia son esperables).
+    int sampled;
+
+    //Funcion que libera el espacio de la vista en su canal, NULL si el canal reutiliza su buffer sin intervencion.
+    ViewRelease release;
+};
+
+/**
+ * Lote de vistas de mensajes que recorre el pipeline.
+*/
+typedef struct MsgBatch
+{
+    //Vistas del lote.
+    MsgView views[PIPELINE_BATCH_MAX];
+
+    //Cantidad de vistas del lote.
+    int count;
+} MsgBatch;
+
+/**
+ * Manejador de una etapa del pipeline: procesa todas las vistas no descartadas de un lote.
+*/
+typedef void (*StageHandler)(MsgBatch* batch);
+
+/**
+ * @brief Registra una etapa disponible para el pipeline.
+ * 
+ * Las etapas registradas se pueden incluir por nombre en la configuracion del pipeline (IPC_PIPELINE).
+ * 
+ * @param name Nombre de la etapa.
+ * @param handler Manejador de la etapa.
+ * @param async_capable 1 si la etapa puede ejecutarse en un hilo propio (no comparte estado con el receptor). 0 en caso contrario.
+ * 
+ * @return No devuelve ningun valor.
+*/
+void pipeline_register(const char* name, StageHandler handler, int async_capable);
+
+/**
+ * @brief Inicializa el pipeline.
+ * 
+ * Registra las etapas incluidas (decode, filter, sequence, aggregate, stats, journal, record y forward) y arma el pipeline a
+ * partir de la lista separada por comas de la variable de entorno IPC_PIPELINE (PIPELINE_DEFAULT si no se define).
+ * Una etapa con el sufijo '@async' se ejecuta en un hilo propio detras de una cola acotada; si hay alguna, se reserva el
+ * slab de las copias de los mensajes con espacio para llenar todas las colas con mensajes de cualquier clase de tamaño.
+ * Si la configuracion es invalida (incluido un filtro numerico sin la etapa 'decode' antes), la función muestra un mensaje de error y termina el programa.
+ * 
+ * @return No devuelve ningun valor.
+*/
+void pipeline_init(void);
+
+/**
+ * @brief Aplica el tamaño de lote de los consumidores propios del servidor (IPC_PIPELINE_BATCH, 1..PIPELINE_BATCH_MAX).
+ * 
+ * Rige para las etapas asincronicas, el anillo de baja latencia y el archivo mapeado; los canales atendidos por el despachador
+ * arman sus lotes segun IPC_DISPATCH_BUDGET. Se invoca al iniciar el pipeline y al recargar la configuracion.
+ * 
+ * @return No devuelve ningun valor.
+*/
+void pipeline_configure(void);
+
+/**
+ * @brief Obtiene el tamaño de lote vigente de los consumidores propios del servidor.
+ * 
+ * @return Cantidad maxima de mensajes por lote.
+*/
+int pipeline_batch_limit(void);
+
+/**
+ * @brief Procesa un lote de mensajes por todas las etapas del pipeline.
+ * 
+ * Antes de las etapas se verifica el checksum de los mensajes que lo incluyen y se descartan los corruptos.
+ * Las etapas sincronicas se ejecutan en orden sobre las vistas del lote; para las asincronicas se copian los mensajes no
+ * descartados en su cola, en buffers del slab del tamaño de cada mensaje (si la cola esta llena o el slab se agoto, el
+ * mensaje se descarta para esa etapa y se contabiliza).
+ * Al finalizar se libera cada vista con su funcion 'release': ninguna etapa debe conservar punteros a una vista luego de procesarla.
+ * 
+ * @param batch Lote a procesar.
+ * 
+ * @return No devuelve ningun valor.
+*/
+void pipeline_run(MsgBatch* batch);
+
+/**
+ * @brief Imprime por un determinado output las estadisticas de cada etapa del pipeline.
+ * 
+ * @param fp File descriptor del archivo de salida.
+ * 
+ * @return No devuelve ningun valor.
+*/
+void print_pipeline_stats(FILE *fp);
+
+/**
+ * @brief Imprime por un determinado output los mensajes verificados y corruptos de cada canal.
+ * 
+ * @param fp File descriptor del archivo de salida.
+ * 
+ * @return No devuelve ningun valor.
+*/
+void print_integrity_stats(FILE *fp);
+
+/**
+ * @brief Detiene los hilos de las etapas asincronicas, procesando antes los mensajes encolados.
+ * 
+ * Las colas y sus estadisticas se conservan hasta pipeline_close, por lo que las estadisticas finales incluyen los
+ * mensajes procesados y los buffers que devolvieron las etapas.
+ * 
+ * @return No devuelve ningun valor.
+*/
+void pipeline_stop(void);
+
+/**
+ * @brief Detiene los hilos de las etapas asincronicas que sigan activos y libera sus colas y la arena de buffers.
+ * 
+ * @return No devuelve ningun valor.
+*/
+void pipeline_close(void);
+
+#endif //__PIPELINE_H__
@@ -0,0 +1,109 @@
+/**
+ * @file Placement.h
+ * @author Bottini, Franco Nicolas.
+ * @brief Cabecera de la ubicacion de los hilos del Server IPC en los CPUs.
+ * @version 1.0
+ * @date Marzo de 2023.
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef __PLACEMENT_H__
+#define __PLACEMENT_H__
+
+#include <pthread.h>
+#include "Common.h"
+#include "Config.h"
+
+//Cantidad maxima de hilos cuya ubicacion se informa.
+#define PLACEMENT_THREADS 16
+
+//Longitud maxima del nombre de un hilo ubicado.
+#define PLACEMENT_NAME_MAX 24
+
+/**
+ * Rol de un hilo del servidor, que determina el conjunto de CPUs en el que se ubica.
+*/
+typedef enum ThreadRole
+{
+    //Recepcion: despachador, hilo puente de la cola de mensajes, consumidor del anillo y muestreo del archivo mapeado (IPC_CPU_RECEIVE).
+    THREAD_RECEIVE,
+
+    //Estadisticas: tablero (IPC_CPU_STATS).
+    THREAD_STATS,
+
+    //Log: etapas asincronas del pipeline e hilo de sincronizacion del journal (IPC_CPU_LOG).
+    THREAD_LOG,
+
+    //Cantidad de roles.
+    THREAD_ROLES
+} ThreadRole;
+
+/**
+ * @brief Lee los conjuntos de CPUs de cada rol y la politica del despachador.
+ *
+ * Los conjuntos se definen como listas de CPUs ("2,3" o "0-3,6") en IPC_CPU_RECEIVE, IPC_CPU_STATS e IPC_CPU_LOG; un rol
+ * sin conjunto conserva la afinidad del proceso. IPC_CPU_ISOLATE=1 reserva esos CPUs para el servidor y los clientes los
+ * excluyen de su afinidad; IPC_SCHED_FIFO (1..99) ejecuta el despachador con SCHED_FIFO y esa prioridad.
+ * Debe invocarse antes de crear cualquier hilo. Si una lista es invalida o incluye CPUs que el proceso no puede usar, la
+ * función muestra un mensaje de error y termina el programa.
+ *
+ * @return No devuelve ningun valor.
+*/
+void placement_init(void);
+
+/**
+ * @brief Obtiene el primer CPU del conjunto de un rol.
+ *
+ * @param role Rol del hilo.
+ *
+ * @return Primer CPU del conjunto, o -1 si el rol no tiene conjunto.
+*/
+int placement_cpu(ThreadRole role);
+
+/**
+ * @brief Ubica un hilo recien creado en el conjunto de CPUs de su rol y registra su ubicacion.
+ *
+ * @param thread Hilo a ubicar.
+ * @param role Rol del hilo.
+ * @param name Nombre con el que se informa el hilo.
+ *
+ * @return No devuelve ningun valor.
+*/
+void placement_thread(pthread_t thread, ThreadRole role, const char* name);
+
+/**
+ * @brief Fija un hilo recien creado a un unico CPU y registra su ubicacion.
+ *
+ * El CPU se agrega a los reservados para el servidor si se aislan los clientes.
+ *
+ * @param thread Hilo a fijar.
+ * @param cpu CPU en el que se fija el hilo.
+ * @param name Nombre con el que se informa el hilo.
+ *
+ * @return No devuelve ningun valor.
+*/
+void placement_pin(pthread_t thread, int cpu, const char* name);
+
+/**
+ * @brief Ubica el hilo principal (despachador) en el conjunto de recepcion y publica los CPUs reservados.
+ *
+ * Debe invocarse despues de crear todos los hilos, inmediatamente antes de iniciar el despachador, para que ningun otro
+ * hilo herede su afinidad ni su politica de planificacion. Si no se tienen permisos para SCHED_FIFO, lo informa y
+ * el despachador continua con la politica por defecto.
+ *
+ * @return No devuelve ningun valor.
+*/
+void placement_start(void);
+
+/**
+ * @brief Imprime por un determinado output la ubicacion efectiva de los hilos del servidor.
+ *
+ * @param fp File descriptor del archivo de salida.
+ *
+ * @return No devuelve ningun valor.
+*/
+void print_placement(FILE *fp);
+
+#endif //__PLACEMENT_H__
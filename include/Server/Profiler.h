@@ -0,0 +1,111 @@
+/**
+ * @file Profiler.h
+ * @author Bottini, Franco Nicolas.
+ * @brief Cabecera de la instrumentacion del camino critico del Server IPC.
+ * @version 1.0
+ * @date Marzo de 2023.
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef __PROFILER_H__
+#define __PROFILER_H__
+
+#include "Common.h"
+#include "Config.h"
+
+//Cantidad maxima de puntos de medicion registrados.
+#define PROFILE_PROBES_MAX 32
+
+/**
+ * Enumerado que define los contadores de perf_event que se leen en cada medicion.
+*/
+typedef enum ProfileCounter
+{
+    PROFILE_CYCLES = 0,
+    PROFILE_INSTRUCTIONS = 1,
+    PROFILE_CONTEXT_SWITCHES = 2,
+    PROFILE_PAGE_FAULTS = 3,
+    PROFILE_COUNTERS = 4
+} ProfileCounter;
+
+/**
+ * Enumerado que define los puntos de medicion fijos del servidor. Las etapas del pipeline registran los suyos a continuacion.
+*/
+typedef enum ProfilePoint
+{
+    //Lectura de los mensajes de cada canal.
+    PROFILE_RECEIVE = 0,
+
+    //Atencion de las señales de control.
+    PROFILE_CONTROL = 1,
+
+    //Escritura del archivo de estadisticas.
+    PROFILE_STATS_FILE = 2,
+
+    //Escritura en la terminal.
+    PROFILE_TERMINAL = 3
+} ProfilePoint;
+
+/**
+ * Lectura de los contadores al comenzar una medicion.
+*/
+typedef struct ProfileSample
+{
+    //Marca de tiempo del contador de ciclos del procesador (rdtsc).
+    uint64_t tsc;
+
+    //Valor de cada contador de perf_event del hilo.
+    uint64_t counters[PROFILE_COUNTERS];
+} ProfileSample;
+
+/**
+ * @brief Habilita la instrumentacion si se define la variable de entorno IPC_PROFILE=1.
+ *
+ * Calibra la frecuencia del contador de ciclos contra CLOCK_MONOTONIC y registra los puntos de medicion fijos del servidor (ProfilePoint).
+ * Los contadores de perf_event se abren por hilo en su primera medicion; los que el sistema no permite se omiten.
+ *
+ * @return No devuelve ningun valor.
+*/
+void profiler_init(void);
+
+/**
+ * @brief Registra un punto de medicion.
+ *
+ * @param name Nombre del punto, utilizado en las estadisticas.
+ *
+ * @return Identificador del punto, o -1 si la instrumentacion esta deshabilitada.
+*/
+int profile_probe(const char* name);
+
+/**
+ * @brief Comienza una medicion en el hilo actual.
+ *
+ * @param sample Lectura inicial de los contadores.
+ *
+ * @return No devuelve ningun valor.
+*/
+void profile_begin(ProfileSample* sample);
+
+/**
+ * @brief Termina una medicion y acumula su costo en un punto de medicion.
+ *
+ * @param probe Identificador del punto (si es -1 no se acumula nada).
+ * @param sample Lectura inicial de los contadores.
+ * @param messages Mensajes procesados durante la medicion.
+ *
+ * @return No devuelve ningun valor.
+*/
+void profile_end(int probe, const ProfileSample* sample, long messages);
+
+/**
+ * @brief Imprime por un determinado output el costo por mensaje de cada punto de medicion.
+ *
+ * @param fp File descriptor del archivo de salida.
+ *
+ * @return No devuelve ningun valor.
+*/
+void print_profile_stats(FILE *fp);
+
+#endif //__PROFILER_H__
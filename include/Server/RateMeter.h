@@ -0,0 +1,61 @@
+/**
+ * @file RateMeter.h
+ * @author Bottini, Franco Nicolas.
+ * @brief Cabecera de los medidores de tasa por ventana deslizante del Server IPC.
+ * @version 1.0
+ * @date Marzo de 2023.
+ * 
+ * @copyright Copyright (c) 2023
+ * 
+ */
+
+#ifndef __RATE_METER_H__
+#define __RATE_METER_H__
+
+#include "Common.h"
+
+//Ancho de cada bucket de los medidores, en milisegundos.
+#define RATE_BUCKET_MS 250
+
+//Cantidad de buckets del anillo de cada medidor (potencia de 2, cubre la ventana mas larga).
+#define RATE_BUCKETS 256
+
+//Cantidad de ventanas informadas por los medidores.
+#define RATE_WINDOWS 3
+
+//Indice del medidor que acumula todos los canales.
+#define RATE_TOTAL CHANNEL_COUNT
+
+/**
+ * @brief Registra un mensaje recibido en el medidor de su canal y en el medidor total.
+ * 
+ * El costo es O(1): se incrementan los contadores del bucket actual, que se reinicia si pertenece a una vuelta anterior del anillo.
+ * 
+ * @param channel_type Canal del mensaje.
+ * @param bytes Tamaño del mensaje en bytes.
+ * 
+ * @return No devuelve ningun valor.
+*/
+void rate_meter_record(ChannelType channel_type, size_t bytes);
+
+/**
+ * @brief Calcula la tasa de un medidor sobre una ventana deslizante.
+ * 
+ * @param meter Canal del medidor o RATE_TOTAL para el total.
+ * @param window Indice de la ventana (0: 1 s, 1: 10 s, 2: 60 s).
+ * @param bytes_rate Tasa en bytes por segundo (puede ser NULL).
+ * 
+ * @return Tasa en mensajes por segundo.
+*/
+double rate_meter_rate(int meter, int window, double* bytes_rate);
+
+/**
+ * @brief Imprime por un determinado output las tasas de cada canal y del total.
+ * 
+ * @param fp File descriptor del archivo de salida.
+ * 
+ * @return No devuelve ningun valor.
+*/
+void print_rate_stats(FILE *fp);
+
+#endif //__RATE_METER_H__
@@ -0,0 +1,57 @@
+/**
+ * @file Recorder.h
+ * @author Bottini, Franco Nicolas.
+ * @brief Cabecera del grabador de trazas de trafico del Server IPC.
+ * @version 1.0
+ * @date Marzo de 2023.
+ * 
+ * @copyright Copyright (c) 2023
+ * 
+ */
+
+#ifndef __RECORDER_H__
+#define __RECORDER_H__
+
+#include "Common.h"
+#include "Config.h"
+
+/**
+ * @brief Inicializa el grabador de trazas de trafico.
+ * 
+ * La grabacion es opcional: solo se habilita si se define la variable de entorno IPC_TRACE_FILE con el archivo de salida.
+ * Si el archivo no se puede crear, la función muestra un mensaje de error y termina el programa.
+ * 
+ * @return No devuelve ningun valor.
+*/
+void recorder_init(void);
+
+/**
+ * @brief Graba en la traza la llegada de un mensaje.
+ * 
+ * Se registra el tiempo transcurrido desde el mensaje anterior, el canal, la prioridad y el tamaño del mensaje.
+ * 
+ * @param channel_type Canal por el que se recibio el mensaje.
+ * @param priority Clase de prioridad del mensaje (0 si el canal no tiene prioridades).
+ * @param size Tamaño del mensaje en bytes.
+ * 
+ * @return No devuelve ningun valor.
+*/
+void recorder_record(ChannelType channel_type, int priority, size_t size);
+
+/**
+ * @brief Imprime por un determinado output las estadisticas del grabador.
+ * 
+ * @param fp File descriptor del archivo de salida.
+ * 
+ * @return No devuelve ningun valor.
+*/
+void print_recorder_stats(FILE *fp);
+
+/**
+ * @brief Vuelca y cierra la traza de trafico.
+ * 
+ * @return No devuelve ningun valor.
+*/
+void recorder_close(void);
+
+#endif //__RECORDER_H__
@@ -0,0 +1,131 @@
+/**
+ * @file Scheduler.h
+ * @author Bottini, Franco Nicolas.
+ * @brief Cabecera del reparto de los canales con handshake entre los clientes del Server IPC.
+ * @version 1.0
+ * @date Marzo de 2023.
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef __SCHEDULER_H__
+#define __SCHEDULER_H__
+
+#include "Common.h"
+#include "Credits.h"
+#include "Config.h"
+
+//Cantidad maxima de clientes (proceso y cliente virtual) con estado de reparto por canal.
+#define GRANT_FLOWS_MAX 256
+
+//Bytes que recibe por defecto cada cliente por unidad de peso en cada ronda del deficit round-robin (IPC_GRANT_QUANTUM_BYTES).
+#define GRANT_QUANTUM_BYTES 128
+
+//Tiempo maximo por defecto que una solicitud espera en la cola antes de responderse WAIT (IPC_GRANT_QUEUE_TIMEOUT_MS). Debe ser menor que el tiempo de espera de respuesta del cliente (IPC_REPLY_TIMEOUT_MS).
+#define GRANT_QUEUE_TIMEOUT_MS 500
+
+//Tiempo por defecto sin concesiones tras el cual un cliente pierde el deficit acumulado, para que un cliente inactivo no acumule ventaja (IPC_GRANT_IDLE_RESET_MS).
+#define GRANT_IDLE_RESET_MS 100
+
+//Cantidad de clientes que se listan por canal en las estadisticas.
+#define GRANT_STATS_TOP 8
+
+/**
+ * Resultado de la extraccion de la proxima solicitud de un canal.
+*/
+typedef enum GrantStatus
+{
+    //No hay solicitudes en la cola.
+    GRANT_EMPTY,
+
+    //La solicitud debe recibir el canal.
+    GRANT_READY,
+
+    //La solicitud supero el tiempo maximo de espera en la cola y debe responderse WAIT.
+    GRANT_EXPIRED,
+
+    //El proceso de la solicitud ya no existe.
+    GRANT_GONE
+} GrantStatus;
+
+/**
+ * Solicitud de inicio de escritura encolada.
+*/
+typedef struct GrantRequest
+{
+    //ID del proceso que envio la solicitud.
+    pid_t pid;
+
+    //Identificador del cliente virtual que envio la solicitud.
+    uint32_t vid;
+
+    //Bytes del mensaje informados en la solicitud.
+    int bytes;
+} GrantRequest;
+
+/**
+ * @brief Aplica los parametros del reparto (IPC_GRANT_QUANTUM_BYTES, IPC_GRANT_QUEUE_TIMEOUT_MS e IPC_GRANT_IDLE_RESET_MS).
+ *
+ * Se invoca al iniciar el servidor y al recargar la configuracion; las solicitudes ya encoladas conservan su deficit.
+ * Si IPC_GRANT_QUEUE_TIMEOUT_MS no es menor que IPC_REPLY_TIMEOUT_MS, lo informa y utiliza la mitad de este ultimo, para
+ * que el cliente reciba WAIT antes de dar por perdida la respuesta.
+ *
+ * @return No devuelve ningun valor.
+*/
+void grant_configure(void);
+
+/**
+ * @brief Encola una solicitud de inicio de escritura en el reparto de un canal.
+ *
+ * Los clientes se identifican por proceso y cliente virtual, de modo que los clientes virtuales de un mismo proceso
+ * tienen solicitudes pendientes y deficit propios. Cada cliente tiene a lo sumo una solicitud pendiente por canal. Un
+ * cliente al que todavia le queda deficit de su turno se encola al frente, de modo que pueda consumir la parte que le
+ * corresponde por su peso aunque solo tenga una solicitud pendiente a la vez. El peso es el declarado por el proceso.
+ * La solicitud se encola en el carril de su clase de prioridad.
+ *
+ * @param channel_type Canal solicitado.
+ * @param pid ID del proceso que envio la solicitud.
+ * @param vid Identificador del cliente virtual que envio la solicitud.
+ * @param bytes Bytes del mensaje.
+ * @param priority Clase de prioridad del mensaje (PRIORITY_NORMAL en los canales sin prioridad).
+ *
+ * @return 1 si la solicitud se encolo. 0 si no hay lugar para el cliente y debe responderse WAIT.
+*/
+int grant_enqueue(ChannelType channel_type, pid_t pid, uint32_t vid, int bytes, MsgPriority priority);
+
+/**
+ * @brief Extrae la proxima solicitud de un canal segun el deficit round-robin ponderado.
+ *
+ * Los carriles de prioridad se atienden con un round-robin ponderado (MQ_LANE_WEIGHTS concesiones por turno), de modo que
+ * los mensajes urgentes se adelantan sin dejar sin servicio a los de menor prioridad.
+ * Cada ronda suma a cada cliente el quantum configurado por unidad de peso; un cliente recibe el canal mientras su deficit
+ * cubra los bytes de su solicitud. Las solicitudes vencidas o de procesos que ya no existen se devuelven con su estado
+ * para que el llamador las descarte.
+ *
+ * @param channel_type Canal liberado.
+ * @param request Solicitud extraida.
+ *
+ * @return Estado de la solicitud extraida, o GRANT_EMPTY si la cola esta vacia.
+*/
+GrantStatus grant_next(ChannelType channel_type, GrantRequest* request);
+
+/**
+ * @brief Copia las colas de reparto a la instantanea que imprime print_grant_stats.
+ *
+ * Debe llamarse con el lock del servidor tomado; la impresion se hace despues, fuera del lock.
+ *
+ * @return No devuelve ningun valor.
+*/
+void snapshot_grants(void);
+
+/**
+ * @brief Imprime por un determinado output la participacion de cada cliente en cada canal y sus tiempos de espera, segun la ultima instantanea.
+ *
+ * @param fp File descriptor del archivo de salida.
+ *
+ * @return No devuelve ningun valor.
+*/
+void print_grant_stats(FILE *fp);
+
+#endif //__SCHEDULER_H__
@@ -0,0 +1,83 @@
+/**
+ * @file SeqTracker.h
+ * @author Bottini, Franco Nicolas.
+ * @brief Cabecera del seguimiento de numeros de secuencia por cliente del Server IPC.
+ * @version 1.0
+ * @date Marzo de 2023.
+ * 
+ * @copyright Copyright (c) 2023
+ * 
+ */
+
+#ifndef __SEQ_TRACKER_H__
+#define __SEQ_TRACKER_H__
+
+#include "Common.h"
+
+//Cantidad de entradas de la tabla de clientes (potencia de 2).
+#define SEQ_TABLE_SIZE 16384
+
+//Cantidad de numeros de secuencia anteriores al esperado que se recuerdan para distinguir duplicados de reordenamientos.
+#define SEQ_WINDOW 64
+
+//Tiempo sin mensajes tras el cual se verifica si el proceso de un cliente termino, para liberar su entrada.
+#define SEQ_IDLE_CHECK_MS 1000
+
+//Tiempo sin mensajes tras el cual se libera la entrada de un cliente aunque su proceso siga activo.
+#define SEQ_EVICT_MS 60000
+
+//Cantidad de entradas de la tabla que se revisan en cada mensaje registrado.
+#define SEQ_SWEEP_STEP 4
+
+/**
+ * @brief Registra el numero de secuencia de un mensaje recibido.
+ * 
+ * Busca al cliente en una tabla de direccionamiento abierto indexada por PID y compara el numero de secuencia recibido
+ * con el esperado: un salto hacia adelante se contabiliza como mensajes perdidos, un numero ya recibido como duplicado y
+ * un numero anterior al esperado que no se habia recibido como reordenamiento. Un reordenamiento solo deja de contarse
+ * como perdido si ese numero se habia contado como perdido para el mismo cliente.
+ * 
+ * En cada llamada se revisan SEQ_SWEEP_STEP entradas de la tabla y se liberan las de clientes cuyo proceso termino
+ * (sin mensajes durante SEQ_IDLE_CHECK_MS) o inactivos durante SEQ_EVICT_MS.
+ * 
+ * @param channel_type Canal por el que se recibio el mensaje.
+ * @param header Cabecera del mensaje recibido.
+ * 
+ * @return No devuelve ningun valor.
+*/
+void track_sequence(ChannelType channel_type, const MsgHeader* header);
+
+/**
+ * @brief Copia los contadores de entrega a la instantanea que imprime print_sequence_stats.
+ * 
+ * Debe llamarse con el lock del servidor tomado; la impresion se hace despues, fuera del lock.
+ * 
+ * @return No devuelve ningun valor.
+*/
+void snapshot_sequences(void);
+
+/**
+ * @brief Imprime por un determinado output las estadisticas de entrega de cada canal de la ultima instantanea.
+ * 
+ * @param fp File descriptor del archivo de salida.
+ * 
+ * @return No devuelve ningun valor.
+*/
+void print_sequence_stats(FILE *fp);
+
+/**
+ * @brief Guarda la tabla de secuencias en la region de estado, para que el servidor que lo reemplaza en caliente
+ * no confunda el siguiente mensaje de cada cliente con una perdida.
+ * 
+ * @return No devuelve ningun valor.
+*/
+void save_sequences(void);
+
+/**
+ * @brief Recupera la tabla de secuencias guardada por el servidor reemplazado en caliente.
+ * 
+ * @return No devuelve ningun valor.
+*/
+void restore_sequences(void);
+
+#endif //__SEQ_TRACKER_H__
@@ -12,32 +12,58 @@
 #ifndef __SERVER_H__
 #define __SERVER_H__
 
+#include <sys/signalfd.h>
+#include <sys/eventfd.h>
 #include "ServerUtils.h"
+#include "Credits.h"
+#include "Scheduler.h"
+#include "Journal.h"
+#include "Recorder.h"
+#include "SeqTracker.h"
+#include "Aggregator.h"
+#include "Pipeline.h"
+#include "ShmRing.h"
+#include "ShmSegment.h"
+#include "Dashboard.h"
+#include "MappedFile.h"
+#include "Dispatcher.h"
+#include "Profiler.h"
+#include "Tracer.h"
+#include "HotRestart.h"
+#include "Placement.h"
+#include "Slab.h"
 
 /**
- * @brief Manejador de señales del server.
+ * @brief Atiende una señal de control leida del signalfd del server.
  *
- * @param sig El número de la señal recibida.
- * @param info Estructura siginfo_t que contiene información adicional sobre la señal.
- * @param context Contexto de ejecución en el momento en que se recibió la señal.
+ * Las solicitudes START_WRITE se encolan en el reparto del canal, que lo otorga en cuanto queda libre (solo se responde
+ * WAIT si la solicitud no pudo encolarse o vencio en la cola). Las señales END_WRITE registran el fin de la escritura
+ * en curso (en memoria compartida, ademas, tocan el timbre del slot). SIGTERM y SIGINT detienen el despachador y SIGHUP
+ * recarga el archivo de configuracion, aplicando sin reiniciar los parametros que lo admiten.
+ * SIGNAL_HANDOFF, enviada por el servidor que lo reemplaza en caliente, inicia la entrega de los recursos IPC.
+ *
+ * @param info Informacion de la señal leida del signalfd.
  * 
  * @return No devuelve ningun valor.
  */
-void signal_handler(int sig, siginfo_t *info, void* context);
+void handle_control_signal(const struct signalfd_siginfo* info);
 
 /**
- * @brief Inicializa el manejador de señales del server.
+ * @brief Inicializa la recepcion de las señales del server.
  *
- * Configura el manejador de señales para el servidor. Registra la función
- * signal_handler como manejador de señales para SIGUSR1, SIGRTMIN, SIGTERM, SIGINT y SIGHUP.
+ * Bloquea las señales de control de tiempo real (SIGNAL_START_WRITE y SIGNAL_END_WRITE), SIGTERM, SIGINT, SIGHUP
+ * y SIGNAL_HANDOFF, y crea el signalfd por el que el despachador las lee. Debe invocarse antes de crear cualquier hilo, para que todos
+ * hereden la mascara. Si la creación del signalfd falla, la función muestra un mensaje de error y termina el programa.
  * 
  * @return No devuelve ningun valor.
  */
-void signal_handler_init(void);
+void control_signals_init(void);
 
 /**
  * @brief Crea la FIFO del servidor. 
  *
+ * La FIFO queda abierta en modo no bloqueante durante toda la ejecucion, junto con un extremo de escritura propio.
+ * En un reinicio en caliente se abre la FIFO existente, antes de que el servidor anterior la cierre, para no perder su contenido.
  * Si la creación de la FIFO falla, la función muestra un mensaje de error y termina el programa.
  *
  * @return No devuelve ningun valor.
@@ -45,7 +71,7 @@ void signal_handler_init(void);
 void create_fifo(void);
 
 /**
- * @brief Crea el segmento de memoria compartida del servidor. 
+ * @brief Crea el segmento de memoria compartida del servidor y su timbre (eventfd).
  *
  * Si la creación o la asignación del segmento de memoria compartida fallan, la función muestra un mensaje de error y termina el programa.
  *
@@ -54,7 +80,7 @@ void create_fifo(void);
 void create_shared_memory_segment(void);
 
 /**
- * @brief Crea la cola de mensages del servidor. 
+ * @brief Crea la cola de mensages del servidor, su timbre (eventfd) y el hilo puente que la vacia.
  *
  * Si la creación de la col de mensajes falla, la función muestra un mensaje de error y termina el programa.
  *
@@ -63,20 +89,53 @@ void create_shared_memory_segment(void);
 void create_message_queue(void);
 
 /**
- * @brief Recibe los mensajes de los diferentes tipos de clientes.
+ * @brief Registra en el despachador las fuentes de eventos del servidor.
+ *
+ * Registra el signalfd de control, la FIFO, los timbres de la memoria compartida y de la cola de mensajes
+ * y el timer (timerfd) de timeout de cada canal con handshake.
+ *
+ * @return No devuelve ningun valor.
+ */
+void register_sources(void);
+
+/**
+ * @brief Extrae el proximo mensaje de la cola de mensajes respetando los carriles de prioridad.
+ * 
+ * Los carriles se drenan mediante round-robin ponderado (el carril URGENT tiene mayor peso que NORMAL y este que BULK),
+ * de forma que el trafico urgente no queda detras de una rafaga masiva pero los carriles de menor prioridad no sufren inanicion.
+ * Los mensajes se toman de los carriles que llena el hilo puente, sin bloquear.
+ * 
+ * @return Un puntero al mensaje extraido, que permanece valido hasta liberar su vista. NULL si no hay mensajes pendientes.
+ */
+const MsgQueueElemnet* message_queue_receive(void);
+
+/**
+ * @brief Devuelve al hilo puente el espacio de un mensaje de la cola de mensajes.
+ * 
+ * @param view Vista del mensaje leido del carril.
+ * 
+ * @return No devuelve ningun valor.
+ */
+void release_message_queue_view(const MsgView* view);
+
+/**
+ * @brief Devuelve el slot de memoria compartida a los productores.
  * 
- * Muestra los mensajes y actualiza la estadistica.
+ * Marca el slot como vacio escribiendo solo el PID de su cabecera, en lugar de limpiar el segmento completo.
+ * Un slot vacio al recibir END_WRITE indica que el cliente no llego a escribir el mensaje.
  * 
- * @param channel_type Canal sobre el cual se envía el mensaje.
+ * @param view Vista del mensaje leido del slot.
  * 
  * @return No devuelve ningun valor.
  */
-void recibe_msg(ChannelType channel_type);
+void release_shared_memory_view(const MsgView* view);
 
 /**
  * @brief Finaliza la ejecucion del programa. 
  * 
  * Elimina todos los mecanismos de IPC creados y termina la ejecucion del servidor. Tambien elimina el archivo con el PID del server.
+ * Si hay una entrega en caliente en curso, en cambio, conserva los mecanismos de IPC y el archivo con el PID, entrega al
+ * pipeline los mensajes que ya retiro de la cola de mensajes y guarda las estadisticas en la region de estado para el sucesor.
  * 
  * @return No devuelve ningun valor.
 */
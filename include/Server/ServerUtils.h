@@ -12,7 +12,11 @@
 #ifndef __SERVER_UTILS_H__
 #define __SERVER_UTILS_H__
 
+#include <pthread.h>
+#include <sys/resource.h>
+#include <sys/timerfd.h>
 #include "Common.h"
+#include "Config.h"
 
 //Canal utilizado.
 #define LOCK 1
@@ -26,36 +30,52 @@
 //Detener timer.
 #define STOP 0
 
+//Espera (en nanosegundos) antes del primer reintento de una respuesta que desbordo la cola de señales del cliente; se duplica en cada intento.
+#define REPLY_RETRY_NS 50000L
+
+//Cantidad maxima de respuestas pendientes de reintento.
+#define REPLY_PENDING_MAX 256
+
+//Tiempo maximo por defecto (en milisegundos) que un cliente puede retener un canal otorgado antes de que el servidor lo libere.
+#define LOCK_TIMEOUT_MS 10
+
 /**
  * @brief Comparte el PID del servidor. 
  * 
- * Guarda el PID del servidor en un archivo para que los clientes lo puedan levantar.
+ * Guarda el PID del servidor en un archivo para que los clientes lo puedan levantar. El archivo se escribe en un temporal
+ * del mismo directorio que luego lo reemplaza con rename, de forma que un cliente nunca lee un archivo vacio o incompleto
+ * (por ejemplo, durante un reinicio en caliente). Si el archivo no se puede escribir, la función muestra un mensaje de
+ * error y termina el programa.
  * 
  * @return No devuelve ningun valor.
 */
 void shared_server_pid(void);
 
 /**
- * @brief Calcula y actualiza la tasa de entrada de mensajes. 
+ * @brief Actualiza y guarda las estadisticas del servidor.
+ * 
+ * Se debe invocar cada vez que se recibe un nuevo mensaje. Recibe como parametros los datos del mensaje recibido.
  * 
- * La tasa de entrada se calcula a partir del tiempo transcurrido entre los dos ultimos mensajes recibidos.
+ * @param channel_type tipo de cliente que envio el mensaje.
+ * @param pid ID del proceso que envio el mensaje o que ocupaba el canal al producirse el timeout.
+ * @param msg mensaje recibido.
+ * @param timeout indica si la conexion termino en timeout: 0 no hubo timeout. 1 si sucedio un timeout.
  * 
  * @return No devuelve ningun valor.
 */
-void refresh_message_rate(void);
+void refresh_stats(ChannelType channel_type, pid_t pid, const char* msg, int timeout);
 
 /**
- * @brief Actualiza y guarda las estadisticas del servidor.
+ * @brief Actualiza las estadisticas de un carril de prioridad de la cola de mensajes.
  * 
- * Se debe invocar cada vez que se recibe un nuevo mensaje. Recibe como parametros los datos del mensaje recibido.
+ * Contabiliza el mensaje en su carril y acumula la latencia medida desde que el cliente lo encolo.
  * 
- * @param channel_type tipo de cliente que envio el mensaje.
- * @param msg mensaje recibido.
- * @param timeout indica si la conexion termino en timeout: 0 no hubo timeout. 1 si sucedio un timeout.
+ * @param lane clase de prioridad ('mtype') del mensaje recibido.
+ * @param sent instante (CLOCK_MONOTONIC) en que el cliente encolo el mensaje.
  * 
  * @return No devuelve ningun valor.
 */
-void refresh_stats(ChannelType channel_type, const char* msg, int timeout);
+void refresh_lane_stats(MsgPriority lane, const struct timespec* sent);
 
 /**
  * @brief Obtiene/genera el nombre del archivo donde se guardan las estadisticas de ejecucion del servidor.
@@ -67,10 +87,22 @@ const char* get_stats_file(void);
 /**
  * @brief Configura los timers que se van a utilizar para detectar los timeouts.
  * 
+ * Cada canal con handshake tiene un timerfd propio, que el despachador de eventos atiende como una fuente mas.
+ * Si la creación de los timers falla, la función muestra un mensaje de error y termina el programa.
+ * 
  * @return No devuelve ninfun valor.
 */
 void timers_init(void);
 
+/**
+ * @brief Aplica el tiempo maximo de retencion de un canal otorgado (IPC_LOCK_TIMEOUT_MS, LOCK_TIMEOUT_MS por defecto).
+ * 
+ * Se invoca al iniciar el servidor y al recargar la configuracion; los timers en curso conservan el tiempo con el que se iniciaron.
+ * 
+ * @return No devuelve ningun valor.
+*/
+void timers_configure(void);
+
 /**
  * @brief Determina si un canal IPC esta ocupado.
  * 
@@ -102,13 +134,13 @@ void change_timer_state(ChannelType channel_type, int state);
 void change_channel_state(ChannelType channel_type, int state, int pid);
 
 /**
- * @brief Obtiene el canal al que pertenece un timer.
+ * @brief Obtiene el timer (timerfd) de un canal.
  * 
- * @param timer Timer del cual se quiere obtener el canal.
+ * @param channel_type Canal del cual se quiere obtener el timer.
  * 
- * @return canal al cual pertenece el timer.
+ * @return File descriptor del timer del canal.
 */
-ChannelType get_timer_type(timer_t timer);
+int get_timer_fd(ChannelType channel_type);
 
 /**
  * @brief Obtiene el ID del proceso que esta ocupando un canal.
@@ -123,25 +155,108 @@ pid_t get_pid(ChannelType channel_type);
  * @brief Imprime por un determinado output informacion acerca de un mensaje.
  * 
  * @param channel_type Canal por el que se recibio el mensaje.
+ * @param pid ID del proceso que envio el mensaje.
  * @param msg Mensaje recibido.
  * @param fp File descriptor del archivo de salida.
  * 
  * @return No devuelve ningun valor.
 */
-void print_msg_info(ChannelType channel_type, const char* msg, FILE *fp);
+void print_msg_info(ChannelType channel_type, pid_t pid, const char* msg, FILE *fp);
 
 /**
  * @brief Imprime por un determinado output informacion acerca de un timeout.
  * 
  * @param channel_type Canal en donde se produjo el timeout.
+ * @param pid ID del proceso que ocupaba el canal.
  * @param fp File descriptor del archivo de salida.
  * 
  * @return No devuelve ningun valor.
 */
-void print_msg_timeout(ChannelType channel_type, FILE *fp);
+void print_msg_timeout(ChannelType channel_type, pid_t pid, FILE *fp);
+
+/**
+ * @brief Verifica el limite de señales encolables del proceso.
+ * 
+ * Si RLIMIT_SIGPENDING es menor a SIGNAL_PENDING_MIN intenta elevarlo (hasta el limite maximo permitido) y, si no lo logra,
+ * advierte que las señales de control pueden desbordar la cola con muchos clientes.
+ * 
+ * @return No devuelve ningun valor.
+*/
+void signal_limits_init(void);
+
+/**
+ * @brief Responde a un cliente una solicitud de inicio de escritura.
+ * 
+ * Si la cola de señales pendientes del cliente esta llena (EAGAIN), la respuesta queda pendiente y se reintenta desde el
+ * timer de reintentos, con espera exponencial y hasta SIGNAL_QUEUE_RETRIES intentos, sin bloquear al despachador. Si no
+ * quedan lugares para respuestas pendientes, la respuesta se pierde y se contabiliza.
+ * 
+ * La respuesta lleva el identificador del cliente virtual que envio la solicitud, para que un proceso con varios
+ * clientes virtuales entregue cada respuesta al cliente que la espera.
+ * 
+ * @param pid ID del proceso cliente.
+ * @param vid Identificador del cliente virtual que envio la solicitud.
+ * @param channel_type Canal de la solicitud, determina la señal de respuesta.
+ * @param response Respuesta a enviar (START_WRITE o WAIT).
+ * 
+ * @return No devuelve ningun valor.
+*/
+void reply_client(pid_t pid, uint32_t vid, ChannelType channel_type, USRSignalType response);
 
 /**
- * @brief Imprime por un determinado output las estadisticas del servidor.
+ * @brief Obtiene el timer (timerfd) de reintento de las respuestas pendientes, que el despachador registra como fuente.
+ * 
+ * @return File descriptor del timer.
+*/
+int get_reply_retry_fd(void);
+
+/**
+ * @brief Reintenta las respuestas pendientes y vuelve a armar el timer si alguna sigue pendiente. Se invoca con el lock tomado.
+ * 
+ * @return No devuelve ningun valor.
+*/
+void retry_replies(void);
+
+/**
+ * @brief Imprime por un determinado output las estadisticas de las señales de control.
+ * 
+ * @param fp File descriptor del archivo de salida.
+ * 
+ * @return No devuelve ningun valor.
+*/
+void print_signal_stats(FILE *fp);
+
+/**
+ * @brief Toma el lock que serializa el acceso al estado del servidor.
+ * 
+ * Lo utilizan el despachador, el consumidor del anillo de SHARED MEMORY y el muestreo del archivo mapeado al entregar mensajes
+ * al pipeline, y el tablero al tomar la instantanea de las estadisticas.
+ * 
+ * @return No devuelve ningun valor.
+*/
+void server_lock(void);
+
+/**
+ * @brief Libera el lock que serializa el acceso al estado del servidor.
+ * 
+ * @return No devuelve ningun valor.
+*/
+void server_unlock(void);
+
+/**
+ * @brief Copia las estadisticas del servidor y las de los modulos protegidos por el lock del servidor a la instantanea que imprime print_stats.
+ * 
+ * Debe llamarse con el lock del servidor tomado. Es una copia breve, sin formato ni escrituras, para que la impresion y el archivo
+ * de estadisticas se hagan despues de liberar el lock.
+ * 
+ * @return No devuelve ningun valor.
+*/
+void snapshot_stats(void);
+
+/**
+ * @brief Imprime por un determinado output las estadisticas del servidor de la ultima instantanea tomada con snapshot_stats.
+ * 
+ * Solo un hilo imprime a la vez: el despachador sin tablero, o el hilo del tablero.
  * 
  * @param fp File descriptor del archivo de salida.
  * 
@@ -149,4 +264,18 @@ void print_msg_timeout(ChannelType channel_type, FILE *fp);
 */
 void print_stats(FILE *fp);
 
+/**
+ * @brief Guarda los contadores del servidor en la region de estado, para el servidor que lo reemplaza en caliente.
+ * 
+ * @return No devuelve ningun valor.
+*/
+void save_stats(void);
+
+/**
+ * @brief Recupera los contadores guardados por el servidor reemplazado en caliente.
+ * 
+ * @return No devuelve ningun valor.
+*/
+void restore_stats(void);
+
 #endif //__SERVER_UTILS_H__
\ No newline at end of file
@@ -0,0 +1,65 @@
+/**
+ * @file ShmRing.h
+ * @author Bottini, Franco Nicolas.
+ * @brief Cabecera del modo de baja latencia de la memoria compartida del Server IPC.
+ * @version 1.0
+ * @date Marzo de 2023.
+ * 
+ * @copyright Copyright (c) 2023
+ * 
+ */
+
+#ifndef __SHM_RING_H__
+#define __SHM_RING_H__
+
+#include "Common.h"
+#include "Config.h"
+
+/**
+ * @brief Crea el anillo de memoria compartida del modo de baja latencia e inicia su hilo consumidor.
+ * 
+ * El modo es opcional: solo se habilita si se define la variable de entorno IPC_SHM_LOWLAT=1. El consumidor espera
+ * activamente hasta IPC_SHM_SPIN_US microsegundos antes de estacionarse en un futex. Si se define IPC_SHM_CPU se fija a ese
+ * CPU; si no, se ubica en los CPUs de recepcion (IPC_CPU_RECEIVE).
+ * En un reinicio en caliente se adopta el anillo del servidor anterior con su contenido, y el consumidor continua desde su cola.
+ * Si la creación del anillo o del hilo fallan, la función muestra un mensaje de error y termina el programa.
+ * 
+ * @return No devuelve ningun valor.
+*/
+void shm_ring_init(void);
+
+/**
+ * @brief Aplica el presupuesto de espera activa del consumidor del anillo (IPC_SHM_SPIN_US).
+ * 
+ * Se invoca al crear el anillo y al recargar la configuracion; el nuevo presupuesto rige desde la proxima espera.
+ * 
+ * @return No devuelve ningun valor.
+*/
+void shm_ring_configure(void);
+
+/**
+ * @brief Copia las latencias acumuladas a la instantanea que imprime print_shm_ring_stats.
+ * 
+ * Debe llamarse con el lock del servidor tomado, que es el que protege las latencias acumuladas por el consumidor.
+ * 
+ * @return No devuelve ningun valor.
+*/
+void snapshot_shm_ring(void);
+
+/**
+ * @brief Imprime por un determinado output las estadisticas del modo de baja latencia.
+ * 
+ * @param fp File descriptor del archivo de salida.
+ * 
+ * @return No devuelve ningun valor.
+*/
+void print_shm_ring_stats(FILE *fp);
+
+/**
+ * @brief Detiene el hilo consumidor y elimina el anillo de memoria compartida (durante una entrega en caliente lo conserva).
+ * 
+ * @return No devuelve ningun valor.
+*/
+void shm_ring_close(void);
+
+#endif //__SHM_RING_H__
@@ -0,0 +1,54 @@
+/**
+ * @file ShmSegment.h
+ * @author Bottini, Franco Nicolas.
+ * @brief Cabecera de la creacion de segmentos de memoria compartida del Server IPC.
+ * @version 1.0
+ * @date Marzo de 2023.
+ * 
+ * @copyright Copyright (c) 2023
+ * 
+ */
+
+#ifndef __SHM_SEGMENT_H__
+#define __SHM_SEGMENT_H__
+
+#include "Common.h"
+#include "Config.h"
+
+/**
+ * @brief Crea y agrega al proceso un segmento de memoria compartida.
+ * 
+ * El tamaño del segmento es 'size' redondeado a paginas. Con IPC_SHM_HUGEPAGES=1
+ * se intenta respaldar el segmento con paginas grandes (SHM_HUGETLB) y, si no hay paginas grandes disponibles, se usan paginas normales.
+ * Las paginas se ligan al nodo NUMA del CPU que atiende el segmento (o al nodo IPC_SHM_NUMA_NODE) y se prefaltean antes de devolverlo.
+ * Si la creación o la asignación del segmento fallan, la función devuelve NULL y deja el error en errno.
+ * 
+ * @param name Nombre del segmento para las estadisticas.
+ * @param key Clave del segmento.
+ * @param size Tamaño minimo del segmento en bytes.
+ * @param cpu CPU que atiende el segmento (-1 para el CPU actual).
+ * @param shmid Identificador del segmento creado.
+ * 
+ * @return Puntero al segmento agregado al proceso o NULL si fallo.
+*/
+void* shm_segment_create(const char* name, key_t key, size_t size, int cpu, int* shmid);
+
+/**
+ * @brief Lee un tamaño en bytes con sufijo opcional K, M o G.
+ * 
+ * @param value Cadena a interpretar (puede ser NULL).
+ * 
+ * @return Tamaño en bytes (0 si la cadena es NULL o invalida).
+*/
+size_t shm_segment_parse_size(const char* value);
+
+/**
+ * @brief Imprime por un determinado output como se crearon los segmentos de memoria compartida.
+ * 
+ * @param fp File descriptor del archivo de salida.
+ * 
+ * @return No devuelve ningun valor.
+*/
+void print_shm_segment_stats(FILE *fp);
+
+#endif //__SHM_SEGMENT_H__
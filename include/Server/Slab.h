@@ -0,0 +1,99 @@
+/**
+ * @file Slab.h
+ * @author Bottini, Franco Nicolas.
+ * @brief Cabecera del asignador por clases de tamaño (slab) de los buffers de mensajes del Server IPC.
+ * @version 1.0
+ * @date Marzo de 2023.
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef __SLAB_H__
+#define __SLAB_H__
+
+#include "Common.h"
+#include "Config.h"
+
+//Tamaño de las paginas en las que se divide la arena (potencia de 2).
+#define SLAB_PAGE_SIZE 65536
+
+//Cantidad de clases de tamaño: 64, 128, 256, 512 y 1024 bytes (la mayor alcanza para un mensaje de MSG_MAX_SIZE).
+#define SLAB_CLASSES 5
+
+//Tamaño de la clase mas chica.
+#define SLAB_MIN_SIZE 64
+
+//Cantidad maxima de buffers de cada clase en la cache de un hilo.
+#define SLAB_CACHE 32
+
+//Cantidad de buffers que se mueven entre la cache de un hilo y la lista global de una vez.
+#define SLAB_TRANSFER (SLAB_CACHE / 2)
+
+/**
+ * @brief Reserva la arena del asignador.
+ *
+ * La arena se reserva y se carga en memoria al iniciar, por lo que ninguna asignacion posterior recurre al heap ni
+ * produce fallos de pagina. Sus paginas se asignan a las clases de tamaño a medida que se necesitan y no vuelven a la
+ * arena, por lo que la cantidad de paginas por defecto alcanza para el peor caso de todas las clases a la vez: cada clase
+ * puede tener 'objects' buffers en uso mas las caches llenas de 'threads' hilos. IPC_SLAB_PAGES reemplaza ese calculo.
+ * Si la reserva falla, la función muestra un mensaje de error y termina el programa.
+ *
+ * @param objects Cantidad maxima de buffers en uso a la vez (fuera de las caches).
+ * @param threads Cantidad de hilos que utilizan el asignador.
+ *
+ * @return No devuelve ningun valor.
+*/
+void slab_init(long objects, int threads);
+
+/**
+ * @brief Obtiene un buffer de la clase de tamaño mas chica que alcanza para 'size' bytes.
+ *
+ * Toma el buffer de la cache del hilo; solo si esta vacia la recarga desde la lista global de la clase.
+ *
+ * @param size Cantidad de bytes necesarios.
+ *
+ * @return Puntero al buffer, o NULL si el tamaño supera la clase mayor o la arena se agoto (se contabiliza).
+*/
+void* slab_alloc(size_t size);
+
+/**
+ * @brief Devuelve un lote de buffers a la cache del hilo.
+ *
+ * Los buffers que exceden la cache se devuelven a la lista global de su clase de a SLAB_TRANSFER, con una sola
+ * adquisicion del lock por transferencia.
+ *
+ * @param objects Buffers obtenidos con slab_alloc (en cualquier hilo).
+ * @param count Cantidad de buffers.
+ *
+ * @return No devuelve ningun valor.
+*/
+void slab_free_bulk(void* const* objects, int count);
+
+/**
+ * @brief Devuelve a las listas globales los buffers de la cache del hilo.
+ *
+ * La invocan, antes de terminar, los hilos que asignan buffers (despachador, consumidor del anillo y muestreo del archivo
+ * mapeado) y los que los liberan (etapas asincronicas), para que sus caches no se cuenten como buffers en uso.
+ *
+ * @return No devuelve ningun valor.
+*/
+void slab_thread_flush(void);
+
+/**
+ * @brief Imprime por un determinado output la ocupacion de la arena y de cada clase de tamaño.
+ *
+ * @param fp File descriptor del archivo de salida.
+ *
+ * @return No devuelve ningun valor.
+*/
+void print_slab_stats(FILE *fp);
+
+/**
+ * @brief Libera la arena. No deben quedar hilos que utilicen sus buffers.
+ *
+ * @return No devuelve ningun valor.
+*/
+void slab_close(void);
+
+#endif //__SLAB_H__
@@ -0,0 +1,66 @@
+/**
+ * @file TraceDump.h
+ * @author Bottini, Franco Nicolas.
+ * @brief Cabecera de la herramienta que combina los archivos de eventos del trazador en una traza de Chrome / Perfetto.
+ * @version 1.0
+ * @date Marzo de 2023.
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef __TRACE_DUMP_H__
+#define __TRACE_DUMP_H__
+
+#include "Common.h"
+
+//Desplazamiento de los identificadores de las pistas de lease de cada canal dentro del proceso del servidor.
+#define LEASE_TRACK_BASE 1000000
+
+/**
+ * Evento cargado de un archivo de eventos, junto con el proceso que lo registro.
+*/
+typedef struct LoadedEvent
+{
+    //Evento registrado.
+    TraceEvent event;
+
+    //Proceso que registro el evento.
+    int32_t pid;
+
+    //1 si el proceso es el servidor.
+    int server;
+} LoadedEvent;
+
+/**
+ * @brief Imprime en la consola información sobre los argumentos de entrada requeridos.
+ *
+ * @return No devuelve ningún valor.
+ */
+void print_trace_dump_help(void);
+
+/**
+ * @brief Carga los eventos de un archivo de eventos del trazador.
+ *
+ * Si el archivo no existe o no es un archivo de eventos valido, la función muestra un mensaje de error y termina el programa.
+ *
+ * @param path Path del archivo de eventos.
+ *
+ * @return No devuelve ningún valor.
+ */
+void load_events(const char* path);
+
+/**
+ * @brief Escribe los eventos cargados, ordenados por instante, como una traza JSON de Chrome / Perfetto.
+ *
+ * Ademas de un evento instantaneo por cada evento registrado, arma intervalos para las solicitudes de los clientes
+ * (de REQUEST a su respuesta) y para los leases de cada canal en el servidor (de GRANT a RELEASE o TIMEOUT),
+ * estos ultimos en una pista propia por canal.
+ *
+ * @param path Path del archivo JSON de salida.
+ *
+ * @return No devuelve ningún valor.
+ */
+void write_chrome_trace(const char* path);
+
+#endif //__TRACE_DUMP_H__
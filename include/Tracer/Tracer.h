@@ -0,0 +1,59 @@
+/**
+ * @file Tracer.h
+ * @author Bottini, Franco Nicolas.
+ * @brief Cabecera del trazador de eventos del ciclo de vida de los mensajes, comun al Server y a los clientes.
+ * @version 1.0
+ * @date Marzo de 2023.
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef __TRACER_H__
+#define __TRACER_H__
+
+#include <pthread.h>
+#include "Common.h"
+#include "Config.h"
+
+//Cantidad por defecto de eventos del anillo de cada hilo (IPC_TRACE_RING_EVENTS, potencia de 2). Al llenarse se sobreescriben los mas antiguos.
+#define TRACE_RING_EVENTS 65536
+
+//Cantidad maxima de hilos con anillo propio por proceso.
+#define TRACE_THREADS_MAX 64
+
+//Path base de los archivos de eventos (se completa con el PID del proceso).
+#define TRACE_FILE_BASE "data/events_"
+
+/**
+ * @brief Habilita el trazador si se define la variable de entorno IPC_EVENT_TRACE=1, con anillos de IPC_TRACE_RING_EVENTS eventos por hilo.
+ *
+ * @param role Rol del proceso ("server" o "client"), que se guarda en la cabecera del archivo de eventos.
+ *
+ * @return No devuelve ningun valor.
+*/
+void tracer_init(const char* role);
+
+/**
+ * @brief Registra un evento en el anillo del hilo actual.
+ *
+ * El anillo del hilo se crea en su primer evento. Si el trazador esta deshabilitado la funcion no hace nada.
+ *
+ * @param type Tipo de evento.
+ * @param channel Canal del evento.
+ * @param peer Proceso del otro extremo (0 si no corresponde).
+ * @param vid Cliente virtual del mensaje.
+ * @param seq Numero de secuencia del mensaje.
+ *
+ * @return No devuelve ningun valor.
+*/
+void trace_event(TraceEventType type, int channel, pid_t peer, uint32_t vid, uint32_t seq);
+
+/**
+ * @brief Escribe los anillos de todos los hilos en el archivo de eventos del proceso (TRACE_FILE_BASE<pid>.bin).
+ *
+ * @return No devuelve ningun valor.
+*/
+void tracer_dump(void);
+
+#endif //__TRACER_H__
@@ -0,0 +1,146 @@
+/**
+ * @file Checksum.c
+ * @author Bottini, Franco Nicolas.
+ * @brief Implementacion del checksum de integridad de los mensajes (CRC32C), comun al Server y a los clientes.
+ * @version 1.0
+ * @date Marzo de 2023.
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include "Checksum.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <nmmintrin.h>
+#endif
+
+//Polinomio de Castagnoli (CRC32C) en representacion reflejada.
+#define CRC32C_POLY 0x82F63B78U
+
+//Tablas de la implementacion portable: la tabla k avanza el CRC de un byte seguido de k bytes nulos.
+static uint32_t crc32c_table[8][256];
+
+//Implementacion en uso, elegida por checksum_init.
+static uint32_t (*crc32c_update)(uint32_t crc, const unsigned char* data, size_t len);
+
+//Nombre de la implementacion en uso.
+static const char* crc32c_name = "software";
+
+/**
+ * @brief Calcula el CRC32C con las tablas, de a 8 bytes (slicing-by-8).
+ *
+ * @param crc CRC acumulado (invertido).
+ * @param data Datos a procesar.
+ * @param len Cantidad de bytes.
+ *
+ * @return CRC acumulado (invertido).
+*/
+static uint32_t crc32c_software(uint32_t crc, const unsigned char* data, size_t len)
+{
+    while (len >= 8)
+    {
+        uint32_t low, high;
+
+        memcpy(&low, data, sizeof(low));
+        memcpy(&high, data + 4, sizeof(high));
+
+        low ^= crc;
+
+        crc = crc32c_table[7][low & 0xFF] ^ crc32c_table[6][(low >> 8) & 0xFF] ^ crc32c_table[5][(low >> 16) & 0xFF] ^ crc32c_table[4][low >> 24] ^
+              crc32c_table[3][high & 0xFF] ^ crc32c_table[2][(high >> 8) & 0xFF] ^ crc32c_table[1][(high >> 16) & 0xFF] ^ crc32c_table[0][high >> 24];
+
+        data += 8;
+        len -= 8;
+    }
+
+    while (len--)
+        crc = crc32c_table[0][(crc ^ *data++) & 0xFF] ^ (crc >> 8);
+
+    return crc;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+/**
+ * @brief Calcula el CRC32C con la instruccion crc32 de SSE4.2.
+ *
+ * @param crc CRC acumulado (invertido).
+ * @param data Datos a procesar.
+ * @param len Cantidad de bytes.
+ *
+ * @return CRC acumulado (invertido).
+*/
+__attribute__((target("sse4.2"))) static uint32_t crc32c_hardware(uint32_t crc, const unsigned char* data, size_t len)
+{
+#if defined(__x86_64__)
+    uint64_t wide = crc;
+
+    while (len >= 8)
+    {
+        uint64_t word;
+
+        memcpy(&word, data, sizeof(word));
+        wide = _mm_crc32_u64(wide, word);
+
+        data += 8;
+        len -= 8;
+    }
+
+    crc = (uint32_t)wide;
+#endif
+
+    while (len >= 4)
+    {
+        uint32_t word;
+
+        memcpy(&word, data, sizeof(word));
+        crc = _mm_crc32_u32(crc, word);
+
+        data += 4;
+        len -= 4;
+    }
+
+    while (len--)
+        crc = _mm_crc32_u8(crc, *data++);
+
+    return crc;
+}
+#endif
+
+void checksum_init(void)
+{
+    for (uint32_t i = 0; i < 256; i++)
+    {
+        uint32_t crc = i;
+
+        for (int bit = 0; bit < 8; bit++)
+            crc = crc & 1 ? (crc >> 1) ^ CRC32C_POLY : crc >> 1;
+
+        crc32c_table[0][i] = crc;
+    }
+
+    for (int k = 1; k < 8; k++)
+        for (int i = 0; i < 256; i++)
+            crc32c_table[k][i] = crc32c_table[0][crc32c_table[k - 1][i] & 0xFF] ^ (crc32c_table[k - 1][i] >> 8);
+
+    crc32c_update = crc32c_software;
+    crc32c_name = "software";
+
+#if defined(__x86_64__) || defined(__i386__)
+    if (__builtin_cpu_supports("sse4.2"))
+    {
+        crc32c_update = crc32c_hardware;
+        crc32c_name = "SSE4.2";
+    }
+#endif
+}
+
+uint32_t checksum_message(const char* msg, size_t len)
+{
+    return ~crc32c_update(0xFFFFFFFFU, (const unsigned char*)msg, len);
+}
+
+const char* checksum_impl(void)
+{
+    return crc32c_name;
+}
@@ -9,27 +9,28 @@
  * 
  */
 
-#include "Client.h"
-
-/**
- * @struct flags
- * 
- * Flags de comunicacion con el servidor.
-*/
-struct
-{
-    //Flag de establecimiento de comunicacion con el servidor.
-    int connect;
+#define _GNU_SOURCE
 
-    //Flag que indica al cliente si enviar un mensaje o esperar de acuerdo al estado del canal.
-    int wait;
-} flags;
+#include <sched.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#include "Client.h"
 
-//Puntero que almacena la instancia del cliente creada al ejecutar el programa.
-Client* client;
+//Puntero que almacena la instancia del cliente del hilo (cada hilo de un proceso con clientes virtuales atiende su propio canal).
+_Thread_local Client* client;
 
 //Array auxiliar para obtener un elemento del enumerado 'ChannelType' en formato de cadena.
-const char* ChannelStringType[] = { "FIFO", "SHARED MEMORY", "MESSAGE QUEUE" };
+const char* ChannelStringType[] = { "FIFO", "SHARED MEMORY", "MESSAGE QUEUE", "MAPPED FILE" };
+
+ClientTuning tuning = 
+{
+	.reply_timeout_ms = REPLY_TIMEOUT_MS,
+	.backoff_min_us = BACKOFF_MIN_US,
+	.backoff_max_us = BACKOFF_MAX_US,
+	.credit_block_timeout_ms = CREDIT_BLOCK_TIMEOUT_MS,
+	.restart_wait_ms = SERVER_RESTART_WAIT_MS
+};
 
 void print_help(void)
 {
@@ -38,25 +39,21 @@ void print_help(void)
 	fprintf(stdout, "	- 0: FIFO\n");
 	fprintf(stdout, "	- 1: SHARED MEMORY\n");
 	fprintf(stdout, "	- 2: MESSAGE QUEUE\n");
+	fprintf(stdout, "	- 3: MAPPED FILE\n");
+	fprintf(stdout, "Opcionalmente, un segundo argumento indica la prioridad de los mensajes de un cliente MESSAGE QUEUE:\n");
+	fprintf(stdout, "	- 1: URGENT\n");
+	fprintf(stdout, "	- 2: NORMAL (por defecto)\n");
+	fprintf(stdout, "	- 3: BULK\n");
+	fprintf(stdout, "Para alojar muchos clientes virtuales en un unico proceso: --clients N [--channel-mix a:b:c] [--period-ms P]\n");
 	fprintf(stdout, "\033[0m\n");
 }
 
 void signal_handler(int sig, siginfo_t *info, void* context)
 {
+	UNUSED(info);
 	UNUSED(context);
 
-	if (sig == SIGUSR1)
-	{
-		USRSignalType signal_type = (USRSignalType)info->si_value.sival_int;
-
-		if (signal_type == START_WRITE)
-			flags.wait = 0;
-		else if (signal_type == WAIT)
-			flags.wait = 1;
-
-		flags.connect = 1;
-	}
-    else if(sig == SIGTERM || sig == SIGINT || sig == SIGHUP)
+    if(sig == SIGTERM || sig == SIGINT || sig == SIGHUP)
         end_client();
 }
 
@@ -66,24 +63,38 @@ Client* client_factory(ChannelType type, int server_pid)
 
     client->type = type;
 	client->server_pid = server_pid;
+	client->priority = PRIORITY_NORMAL;
+	client->seq = 0;
+	client->vid = 0;
+	client->ring = NULL;
+	client->mapped = NULL;
     
     switch (type) 
 	{
     	case FIFO:
         	client->send = &fifo_send;
+			client->write = &fifo_write;
 			client->init = NULL;
         	break;
 
       	case SHARED_MEMORY:;
 			client->send = &shared_memory_send;	
+			client->write = &shared_memory_write;
 			client->init = &shared_memory_init;
         	break;
 
       	case MESSAGE_QUEUE:
 			client->send = &message_queue_send;
+			client->write = &message_queue_write;
 			client->init = &message_queue_init;
         	break;
 
+      	case MAPPED_FILE:
+			client->send = &mapped_file_send;
+			client->write = NULL;
+			client->init = &mapped_file_init;
+        	break;
+
       	default:
         	free(client);
         	client = NULL;
@@ -93,13 +104,66 @@ Client* client_factory(ChannelType type, int server_pid)
     return client;
 }
 
-void client_init(int argc, char* argv[])
+void client_configure(void)
+{
+	config_init();
+
+	tuning.reply_timeout_ms = config_long("IPC_REPLY_TIMEOUT_MS", REPLY_TIMEOUT_MS, 1, 60000);
+	tuning.backoff_min_us = config_long("IPC_BACKOFF_MIN_US", BACKOFF_MIN_US, 2, 1000000);
+	tuning.backoff_max_us = config_long("IPC_BACKOFF_MAX_US", BACKOFF_MAX_US, tuning.backoff_min_us, 1000000);
+	tuning.credit_block_timeout_ms = config_long("IPC_CREDIT_BLOCK_TIMEOUT_MS", CREDIT_BLOCK_TIMEOUT_MS, 0, 60000);
+	tuning.restart_wait_ms = config_long("IPC_RESTART_WAIT_MS", SERVER_RESTART_WAIT_MS, 0, 60000);
+	tuning.checksum = (int)config_long("IPC_CHECKSUM", 0, 0, 1);
+
+	checksum_init();
+
+	if (tuning.backoff_max_us < tuning.backoff_min_us)
+		tuning.backoff_max_us = tuning.backoff_min_us;
+}
+
+int read_server_pid(void)
 {
 	FILE *fp;
-    char buffer[11];
-	int server_pid, channel_type;
+	char buffer[11];
+
+	if ((fp = fopen(config_pid_file(), "r")) == NULL)
+		return -1;
+
+	char* line = fgets(buffer, sizeof(buffer), fp);
+
+	fclose(fp);
+
+	return line ? atoi(line) : -1;
+}
+
+int refresh_server_pid(void)
+{
+	struct timespec poll_time = {0, 1000000};
+
+	for (int waited = 0; waited < tuning.restart_wait_ms; waited++)
+	{
+		int pid = read_server_pid();
+
+		if (pid == -1)
+			return 0;
+
+		if (pid != client->server_pid && kill(pid, 0) == 0)
+		{
+			client->server_pid = pid;
+			return 1;
+		}
+
+		nanosleep(&poll_time, NULL);
+	}
+
+	return 0;
+}
 
-	if (argc != 2)
+void client_init(int argc, char* argv[])
+{
+	int server_pid, channel_type, priority = PRIORITY_NORMAL;
+
+	if (argc != 2 && argc != 3)
 	{
 		fprintf(stderr, "\033[1;31mNúmero de argumentos invalido !\033[0m\n");
 		print_help();
@@ -115,17 +179,23 @@ void client_init(int argc, char* argv[])
 		exit(EXIT_FAILURE);
 	}
 
-	if (access(PID_SERVER_FILE, F_OK) == -1)
+	if (argc == 3)
+	{
+		priority = atoi(argv[2]);
+
+		if (priority < PRIORITY_URGENT || priority > PRIORITY_BULK)
+		{
+			fprintf(stderr, "\033[1;31mPrioridad invalida !\033[0m\n");
+			print_help();
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	if ((server_pid = read_server_pid()) == -1)
 	{
 		fprintf(stderr, "\033[1;31mNo se encontró un servidor en ejecucion !\033[0m\n");
 		exit(EXIT_FAILURE);
 	}
-
-    fp = fopen(PID_SERVER_FILE, "r");
-
-	server_pid = atoi(fgets(buffer, sizeof(buffer), fp));
-
-	fclose(fp);
 	
 	client = client_factory((ChannelType)channel_type, server_pid);
 
@@ -136,6 +206,16 @@ void client_init(int argc, char* argv[])
 		exit(EXIT_FAILURE);
 	}
 
+	client->priority = (MsgPriority)priority;
+
+	const char* policy = config_get("IPC_CREDIT_POLICY");
+
+	client->credit_policy = (policy && strcmp(policy, "fail") == 0) ? CREDIT_FAIL_FAST : CREDIT_BLOCK;
+
+	credit_page_init();
+
+	tracer_init("client");
+
 	if (client->type != FIFO)
 		client->init();
 }
@@ -147,9 +227,17 @@ void signal_handler_init(void)
         .sa_sigaction = signal_handler,
         .sa_flags = SA_SIGINFO
     };
+    sigset_t reply_set;
+
     sigemptyset(&sa.sa_mask);
+
+    sigemptyset(&reply_set);
+
+    for (int channel = 0; channel <= MESSAGE_QUEUE; channel++)
+        sigaddset(&reply_set, SIGNAL_REPLY(channel));
+
+    sigprocmask(SIG_BLOCK, &reply_set, NULL);
     
-    sigaction(SIGUSR1, &sa, NULL);
 	sigaction(SIGTERM, &sa, NULL);
     sigaction(SIGINT, &sa, NULL);
     sigaction(SIGHUP, &sa, NULL);
@@ -158,24 +246,70 @@ void signal_handler_init(void)
 void shared_memory_init(void)
 {
 	int shmid;
-    key_t key = ftok("Server.c", 'B');
+    key_t key = config_ipc_key();
 
-    if ((shmid = shmget(key, MSG_MAX_SIZE, 0666)) == -1) 
+    if ((shmid = shmget(key, sizeof(Message), 0666)) == -1) 
 	{
         fprintf(stderr, "\033[1;31mNo se pudo obtener la region de memoria compartida por el servidor !\033[0m\n");
         exit(EXIT_FAILURE);
 	}
     
-	if ((client->shm = shmat(shmid, NULL, 0)) == (char *) -1) 
+	if ((client->shm = shmat(shmid, NULL, 0)) == (Message *) -1) 
 	{
         fprintf(stderr, "\033[1;31mNo se pudo agregar el espacio de memoria compartido al espacio del proceso !\033[0m\n");
         exit(EXIT_FAILURE);
     }
+
+	client->ring = NULL;
+
+	if ((shmid = shmget(ftok(config_fifo_name(), 'R'), sizeof(ShmRing), 0666)) == -1 || (client->ring = shmat(shmid, NULL, 0)) == (ShmRing *) -1)
+	{
+		client->ring = NULL;
+		return;
+	}
+
+	struct shmid_ds segment;
+	unsigned int capacity = client->ring->capacity;
+
+	if (shmctl(shmid, IPC_STAT, &segment) == -1 || capacity == 0 || (capacity & (capacity - 1)) != 0 ||
+		sizeof(ShmRing) + (size_t)capacity * sizeof(ShmRingSlot) > segment.shm_segsz)
+	{
+		shmdt(client->ring);
+		client->ring = NULL;
+		return;
+	}
+
+	client->ring_mask = capacity - 1;
+
+	//Los mensajes van por el anillo, sin solicitar el canal al servidor.
+	client->write = NULL;
+}
+
+void mapped_file_init(void)
+{
+	const char* path = config_get("IPC_MAPPED_FILE");
+	int fd;
+
+	if ((fd = open(path && *path ? path : MAPPED_FILE_NAME, O_RDWR)) == -1)
+	{
+		fprintf(stderr, "\033[1;31mNo se pudo abrir el archivo mapeado del servidor !\033[0m\n");
+		exit(EXIT_FAILURE);
+	}
+
+	client->mapped = mmap(NULL, sizeof(MappedFile), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+	close(fd);
+
+	if (client->mapped == MAP_FAILED)
+	{
+		fprintf(stderr, "\033[1;31mNo se pudo mapear el archivo del servidor al espacio del proceso !\033[0m\n");
+		exit(EXIT_FAILURE);
+	}
 }
 
 void message_queue_init(void)
 {
-	key_t key = ftok("Server.c", 'B');
+	key_t key = config_ipc_key();
 
 	if ((client->msgid = msgget(key, 0666)) == -1) 
 	{
@@ -184,104 +318,520 @@ void message_queue_init(void)
 	}
 }
 
-int request_send(void)
+/**
+ * @brief Excluye de la afinidad del proceso los CPUs que el servidor reservo para sus hilos (IPC_CPU_ISOLATE).
+ * 
+ * Si la exclusion dejaria al proceso sin CPUs, se conserva la afinidad actual.
+ * 
+ * @return No devuelve ningún valor.
+*/
+static void avoid_server_cpus(void)
 {
-	flags.connect = 0;
+	cpu_set_t set;
+	int reserved = 0;
+
+	if (sched_getaffinity(0, sizeof(set), &set) == -1)
+		return;
+
+	for (size_t cpu = 0; cpu < CPU_SETSIZE && cpu < CPU_MASK_WORDS * 64; cpu++)
+	{
+		if (!(client->credit_page->isolated_cpus[cpu / 64] >> (cpu % 64) & 1) || !CPU_ISSET(cpu, &set))
+			continue;
+
+		CPU_CLR(cpu, &set);
+		reserved++;
+	}
+
+	if (reserved == 0)
+		return;
+
+	if (CPU_COUNT(&set) == 0)
+	{
+		fprintf(stderr, "\033[1;31mTodos los CPUs del cliente estan reservados para el servidor, se conserva la afinidad actual\033[0m\n");
+		return;
+	}
+
+	sched_setaffinity(0, sizeof(set), &set);
+}
+
+void credit_page_init(void)
+{
+	int shmid;
+	key_t key = ftok(config_fifo_name(), 'C');
+
+	if ((shmid = shmget(key, sizeof(CreditPage), 0666)) == -1) 
+	{
+		fprintf(stderr, "\033[1;31mNo se pudo obtener la pagina de control de creditos del servidor !\033[0m\n");
+		exit(EXIT_FAILURE);
+	}
+
+	if ((client->credit_page = shmat(shmid, NULL, 0)) == (CreditPage *) -1) 
+	{
+		fprintf(stderr, "\033[1;31mNo se pudo agregar la pagina de control de creditos al espacio del proceso !\033[0m\n");
+		exit(EXIT_FAILURE);
+	}
+
+	avoid_server_cpus();
+
+	const char* env = config_get("IPC_CLIENT_WEIGHT");
+	int weight = env ? atoi(env) : 1;
+
+	if (weight < 1 || weight > GRANT_WEIGHT_MAX)
+	{
+		fprintf(stderr, "\033[1;31mIPC_CLIENT_WEIGHT debe estar entre 1 y %d !\033[0m\n", GRANT_WEIGHT_MAX);
+		exit(EXIT_FAILURE);
+	}
+
+	client->credit = NULL;
+
+	for (int i = 0; i < CREDIT_SLOTS && !client->credit; i++)
+	{
+		CreditSlot* slot = &client->credit_page->slots[((unsigned int)getpid() + (unsigned int)i) % CREDIT_SLOTS];
+		int owner = atomic_load(&slot->pid);
 
-	sigqueue(client->server_pid, SIGUSR1, (union sigval) { .sival_int = (int)client->type | (int)START_WRITE << 2 });
+		if (owner > 0 || !atomic_compare_exchange_strong(&slot->pid, &owner, getpid()))
+			continue;
 
-	time_t start_time = time(NULL);
+		//La entrada se inicializa despues de ganarla: otro cliente que compita por ella no puede pisar sus contadores.
+		atomic_store(&slot->inflight_msgs, 0);
+		atomic_store(&slot->inflight_bytes, 0);
+		atomic_store(&slot->weight, weight);
+
+		client->credit = slot;
+	}
+}
+
+int try_credits(int bytes)
+{
+	if (!client->credit)
+		return 1;
 
-    while (difftime(time(NULL), start_time) < 1 && !flags.connect) { continue; }
+	int window_msgs = atomic_load(&client->credit_page->window_msgs);
+	int window_bytes = atomic_load(&client->credit_page->window_bytes);
 
-	if(!flags.connect)
+	if (atomic_load(&client->credit->inflight_msgs) >= window_msgs || atomic_load(&client->credit->inflight_bytes) + bytes > window_bytes)
 		return 0;
-	else if(flags.wait)
+
+	atomic_fetch_add(&client->credit->inflight_msgs, 1);
+	atomic_fetch_add(&client->credit->inflight_bytes, bytes);
+
+	return 1;
+}
+
+int acquire_credits(int bytes)
+{
+	if (!client->credit)
+		return 1;
+
+	struct timespec poll_time = {0, 1000000};
+
+	for (int waited = 0; waited <= tuning.credit_block_timeout_ms; waited++)
 	{
-		struct timespec wait_time = {0, rand() % 1000000 + 10000};
+		if (try_credits(bytes))
+			return 1;
+
+		if (client->credit_policy == CREDIT_FAIL_FAST)
+			break;
+
+		nanosleep(&poll_time, NULL);
+	}
+
+	atomic_fetch_add(&client->credit->dropped, 1);
+
+	return 0;
+}
+
+int send_control(int sig, int value)
+{
+	struct timespec backoff = {0, 50000};
+
+	for (int attempt = 0; attempt <= SIGNAL_QUEUE_RETRIES; attempt++)
+	{
+		if (sigqueue(client->server_pid, sig, (union sigval) { .sival_int = value }) == 0)
+			return 1;
+
+		int error = errno;
+
+		if (error == ESRCH && refresh_server_pid())
+			continue;
+
+		if (error != EAGAIN)
+			break;
+
+		atomic_fetch_add(&client->credit_page->signal_overflows, 1);
+
+		nanosleep(&backoff, NULL);
+
+		backoff.tv_nsec *= 2;
+	}
+
+	return 0;
+}
+
+void refund_credits(int bytes)
+{
+	if (!client->credit)
+		return;
+
+	atomic_fetch_sub(&client->credit->inflight_msgs, 1);
+	atomic_fetch_sub(&client->credit->inflight_bytes, bytes);
+}
+
+int wait_reply(USRSignalType* response)
+{
+	sigset_t reply_set;
+	siginfo_t info;
+	struct timespec start, now, remaining;
+
+	sigemptyset(&reply_set);
+	sigaddset(&reply_set, SIGNAL_REPLY(client->type));
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	while (1)
+	{
+		clock_gettime(CLOCK_MONOTONIC, &now);
+
+		long elapsed_ns = (now.tv_sec - start.tv_sec) * 1000000000L + (now.tv_nsec - start.tv_nsec);
+		long left_ns = tuning.reply_timeout_ms * 1000000L - elapsed_ns;
+
+		if (left_ns <= 0)
+			return 0;
+
+		remaining.tv_sec = left_ns / 1000000000L;
+		remaining.tv_nsec = left_ns % 1000000000L;
+
+		if (sigtimedwait(&reply_set, &info, &remaining) == SIGNAL_REPLY(client->type))
+		{
+			if (((uint32_t)info.si_value.sival_int >> CONTROL_VID_SHIFT & CONTROL_VID_MASK) != (client->vid & CONTROL_VID_MASK))
+				continue;
+
+			*response = (USRSignalType)(info.si_value.sival_int & 3);
+			return 1;
+		}
+
+		if (errno != EINTR)
+			return 0;
+	}
+}
+
+int request_send(int bytes)
+{
+	sigset_t reply_set;
+	struct timespec no_wait = {0, 0};
+	USRSignalType response;
+	long backoff_us = tuning.backoff_min_us;
+
+	sigemptyset(&reply_set);
+	sigaddset(&reply_set, SIGNAL_REPLY(client->type));
+
+	while (1)
+	{
+		if (!acquire_credits(bytes))
+			break;
+
+		while (sigtimedwait(&reply_set, NULL, &no_wait) == SIGNAL_REPLY(client->type))
+			continue;
+
+		if (!request_start(bytes))
+			break;
+
+		if (!wait_reply(&response))
+		{
+			trace_event(TRACE_TIMEOUT, client->type, 0, client->vid, client->seq);
+
+			if (read_server_pid() != client->server_pid && refresh_server_pid())
+			{
+				refund_credits(bytes);
+				continue;
+			}
+
+			break;
+		}
+
+		trace_event(response == START_WRITE ? TRACE_GRANT : TRACE_WAIT, client->type, 0, client->vid, client->seq);
+
+		if (response == START_WRITE)
+			return 1;
+
+		long delay_us = backoff_us / 2 + rand() % (backoff_us / 2 + 1);
+		struct timespec wait_time = { delay_us / 1000000L, (delay_us % 1000000L) * 1000L };
 
 		nanosleep(&wait_time, NULL);
 
-		request_send();
+		if (backoff_us < tuning.backoff_max_us)
+			backoff_us = backoff_us * 2 < tuning.backoff_max_us ? backoff_us * 2 : tuning.backoff_max_us;
 	}
 
-	return 1;
+	client->seq++;
+
+	return 0;
+}
+
+int request_start(int bytes)
+{
+	trace_event(TRACE_REQUEST, client->type, 0, client->vid, client->seq);
+
+	if (send_control(SIGNAL_START_WRITE, (int)client->type | (int)client->priority << CONTROL_PRIORITY_SHIFT | bytes << CONTROL_BYTES_SHIFT | (int)(client->vid & CONTROL_VID_MASK) << CONTROL_VID_SHIFT))
+		return 1;
+
+	refund_credits(bytes);
+
+	return 0;
 }
 
-void fifo_send(const char* msg)
+void fill_header(MsgHeader* header)
 {
-	if (!request_send())
+	header->pid = getpid();
+	header->vid = client->vid;
+	header->seq = client->seq++;
+	header->flags = 0;
+
+	clock_gettime(CLOCK_MONOTONIC, &header->timestamp);
+}
+
+/**
+ * @brief Completa el checksum de la cabecera de un mensaje, si el cliente envia checksums.
+ * 
+ * @param header Cabecera ya completada con fill_header.
+ * @param msg Contenido del mensaje.
+ * @param len Longitud del contenido, sin el caracter nulo final.
+ * 
+ * @return No devuelve ningun valor.
+*/
+static inline void message_checksum(MsgHeader* header, const char* msg, size_t len)
+{
+	if (!tuning.checksum)
 		return;
+
+	header->crc = checksum_message(msg, len);
+	header->flags |= MSG_FLAG_CHECKSUM;
+}
+
+int fifo_send(const char* msg)
+{
+	if (!request_send((int)strlen(msg) + 1))
+		return 0;
+
+	return fifo_write(msg);
+}
+
+int fifo_write(const char* msg)
+{
+	Message message;
+
+	fill_header(&message.header);
+
+	message_checksum(&message.header, msg, strlen(msg));
 	
-	sigqueue(client->server_pid, SIGUSR1, (union sigval) { .sival_int = (int)client->type | (int)END_WRITE << 2 });
+	trace_event(TRACE_END_WRITE, client->type, 0, message.header.vid, message.header.seq);
+
+	send_control(SIGNAL_END_WRITE, (int)client->type | (int)END_WRITE << 2);
 
-	int fd = open(FIFO_NAME, O_WRONLY);
+	int fd = open(config_fifo_name(), O_WRONLY);
 
-	write(fd, msg, strlen(msg) + 1);
+	strcpy(message.msg, msg);
+
+	write(fd, &message, sizeof(message.header) + strlen(msg) + 1);
 
 	close(fd);
+
+	trace_event(TRACE_WRITE, client->type, 0, message.header.vid, message.header.seq);
+
+	return 1;
 }
 
-void message_queue_send(const char* msg)
+int message_queue_send(const char* msg)
 {
-	if (!request_send())
-		return;
+	if (!request_send((int)strlen(msg) + 1))
+		return 0;
+
+	return message_queue_write(msg);
+}
 
+int message_queue_write(const char* msg)
+{
 	MsgQueueElemnet mq;
 
-	mq.type = 1;
+	fill_header(&mq.header);
+
+	message_checksum(&mq.header, msg, strlen(msg));
+
+	mq.type = client->priority;
 
 	strcpy(mq.msg, msg);
 
-	msgsnd(client->msgid, &mq, strlen(mq.msg) + 1, 0);
+	msgsnd(client->msgid, &mq, sizeof(mq.header) + strlen(mq.msg) + 1, 0);
+
+	trace_event(TRACE_WRITE, client->type, 0, mq.header.vid, mq.header.seq);
+	trace_event(TRACE_END_WRITE, client->type, 0, mq.header.vid, mq.header.seq);
 
-	sigqueue(client->server_pid, SIGUSR1, (union sigval) { .sival_int = (int)client->type | (int)END_WRITE << 2 });
+	send_control(SIGNAL_END_WRITE, (int)client->type | (int)END_WRITE << 2);
+
+	return 1;
 }
 
-void shared_memory_send(const char* msg)
+MappedSlot* find_mapped_slot(void)
 {
-	if (!request_send())
-		return;
+	unsigned long long key = (unsigned long long)getpid() << 32 | client->vid;
+	uint32_t index = (uint32_t)((key ^ key >> 29) * 2654435761U) & (MAPPED_SLOTS - 1);
 
-	strcpy(client->shm, msg);
+	for (int i = 0; i < MAPPED_SLOTS; i++)
+	{
+		MappedSlot* slot = &client->mapped->slots[(index + (uint32_t)i) & (MAPPED_SLOTS - 1)];
+		unsigned long long owner = atomic_load(&slot->owner);
 
-	sigqueue(client->server_pid, SIGUSR1, (union sigval) { .sival_int = (int)client->type | (int)END_WRITE << 2 });
+		if (owner == key || (owner == 0 && atomic_compare_exchange_strong(&slot->owner, &owner, key)))
+			return slot;
+	}
+
+	return NULL;
 }
 
-void end_client(void)
+int mapped_file_send(const char* msg)
 {
-	fprintf(stderr, "\n\033[1;31mSe detuvo la ejecucion del servidor -> Cliente %s (%d) detenido !\033[0m\n", ChannelStringType[client->type], getpid());
-	
-	free(client);
-	
-	exit(EXIT_SUCCESS);
+	MsgHeader header;
+	MappedSlot* slot = find_mapped_slot();
+	uint32_t len = (uint32_t)strnlen(msg, MAPPED_VALUE_MAX - 1);
+
+	fill_header(&header);
+
+	message_checksum(&header, msg, len);
+
+	if (!slot)
+		return 0;
+
+	unsigned int sequence = atomic_load_explicit(&slot->sequence, memory_order_relaxed);
+
+	atomic_store_explicit(&slot->sequence, sequence + 1, memory_order_relaxed);
+	atomic_thread_fence(memory_order_release);
+
+	slot->header = header;
+	slot->len = len;
+	memcpy(slot->value, msg, len);
+	slot->value[len] = '\0';
+
+	atomic_store_explicit(&slot->sequence, sequence + 2, memory_order_release);
+
+	unsigned long long pos = atomic_fetch_add(&client->mapped->append_head, 1);
+	MappedRecord* record = &client->mapped->records[pos & (MAPPED_APPEND_RECORDS - 1)];
+
+	atomic_store_explicit(&record->sequence, 2 * pos + 1, memory_order_relaxed);
+	atomic_thread_fence(memory_order_release);
+
+	record->header = header;
+	record->len = len;
+	memcpy(record->value, msg, len);
+	record->value[len] = '\0';
+
+	atomic_store_explicit(&record->sequence, 2 * pos + 2, memory_order_release);
+
+	trace_event(TRACE_WRITE, client->type, 0, header.vid, header.seq);
+
+	return 1;
 }
 
-int main(int argc, char* argv[])
+int shared_memory_ring_send(const char* msg)
 {
-	client_init(argc, argv);
+	int bytes = (int)strlen(msg) + 1;
 
-	signal_handler_init();
-
-	int n = 0;
+	if (!acquire_credits(bytes))
+	{
+		client->seq++;
+		return 0;
+	}
 
-	sleep((unsigned int)(rand() % 3));
+	unsigned int pos = atomic_load(&client->ring->head);
+	ShmRingSlot* slot;
 
 	while (1)
 	{
-		char aux[11];
+		slot = &client->ring->slots[pos & client->ring_mask];
 
-		sprintf(aux, "%d", n);
+		int diff = (int)(atomic_load_explicit(&slot->sequence, memory_order_acquire) - pos);
 
-		client->send(aux);
-		
-		n++;
+		if (diff == 0 && atomic_compare_exchange_weak(&client->ring->head, &pos, pos + 1))
+			break;
 
-		sleep((unsigned int)(rand() % 5 + 1));
+		if (diff < 0)
+		{
+			refund_credits(bytes);
 
-		if (access(PID_SERVER_FILE, F_OK) == -1)
-			end_client();
+			atomic_fetch_add(&client->ring->full, 1);
+			client->seq++;
+
+			return 0;
+		}
+
+		if (diff > 0)
+			pos = atomic_load(&client->ring->head);
 	}
 
-	return 0;
-}
\ No newline at end of file
+	fill_header(&slot->message.header);
+
+	message_checksum(&slot->message.header, msg, (size_t)bytes - 1);
+
+	strcpy(slot->message.msg, msg);
+
+	slot->bytes = bytes;
+
+	atomic_store_explicit(&slot->sequence, pos + 1, memory_order_release);
+
+	trace_event(TRACE_WRITE, client->type, 0, client->vid, client->seq - 1);
+
+	int parked = 1;
+
+	if (atomic_compare_exchange_strong(&client->ring->parked, &parked, 0))
+		syscall(SYS_futex, &client->ring->parked, FUTEX_WAKE, 1, NULL, NULL, 0);
+
+	return 1;
+}
+
+int shared_memory_send(const char* msg)
+{
+	if (client->ring)
+		return shared_memory_ring_send(msg);
+
+	if (!request_send((int)strlen(msg) + 1))
+		return 0;
+
+	return shared_memory_write(msg);
+}
+
+int shared_memory_write(const char* msg)
+{
+	fill_header(&client->shm->header);
+
+	message_checksum(&client->shm->header, msg, strlen(msg));
+
+	strcpy(client->shm->msg, msg);
+
+	trace_event(TRACE_WRITE, client->type, 0, client->vid, client->seq - 1);
+	trace_event(TRACE_END_WRITE, client->type, 0, client->vid, client->seq - 1);
+
+	send_control(SIGNAL_END_WRITE, (int)client->type | (int)END_WRITE << 2);
+
+	return 1;
+}
+
+void end_client(void)
+{
+	fprintf(stderr, "\n\033[1;31mSe detuvo la ejecucion del servidor -> Cliente %s (%d) detenido !\033[0m\n", ChannelStringType[client->type], getpid());
+
+	if (client->credit)
+		atomic_store(&client->credit->pid, -1);
+
+	shmdt(client->credit_page);
+
+	if (client->ring)
+		shmdt(client->ring);
+
+	if (client->mapped)
+		munmap(client->mapped, sizeof(MappedFile));
+
+	tracer_dump();
+	
+	free(client);
+	
+	exit(EXIT_SUCCESS);
+}
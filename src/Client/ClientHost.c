@@ -0,0 +1,638 @@
+/**
+ * @file ClientHost.c
+ * @author Bottini, Franco Nicolas.
+ * @brief Implementacion del modo host de clientes virtuales del Cliente IPC.
+ * @version 1.0
+ * @date Marzo de 2023.
+ * 
+ * @copyright Copyright (c) 2023
+ * 
+ */
+
+#include <sys/mman.h>
+#include "ClientHost.h"
+
+/**
+ * @struct host
+ * 
+ * Estructura que almacena el estado del proceso host de clientes virtuales.
+*/
+struct
+{
+    //Canales del host, uno por hilo.
+    HostChannel channels[CHANNEL_COUNT];
+
+    //PID del servidor.
+    int server_pid;
+
+    //Periodo medio de envio de cada cliente virtual, en nanosegundos.
+    int64_t period_ns;
+
+    //Cliente del hilo principal, dueño de la entrada de creditos que comparten todos los hilos.
+    Client* owner;
+
+    //Indica a los hilos que deben terminar.
+    atomic_int stop;
+} host;
+
+void print_host_help(void)
+{
+    fprintf(stdout, "\n\033[1;34m");
+    fprintf(stdout, "Modo host: un unico proceso aloja N clientes virtuales repartidos entre los canales:\n");
+    fprintf(stdout, "	--clients N           cantidad de clientes virtuales\n");
+    fprintf(stdout, "	--channel-mix a:b:c[:d] peso de FIFO, SHARED MEMORY, MESSAGE QUEUE y MAPPED FILE (por defecto 1:1:1:0)\n");
+    fprintf(stdout, "	--period-ms P         periodo medio de envio de cada cliente virtual (por defecto %d)\n", HOST_PERIOD_MS);
+    fprintf(stdout, "\033[0m\n");
+}
+
+/**
+ * @brief Devuelve el tiempo monotono actual en nanosegundos.
+ * 
+ * @return Tiempo actual en nanosegundos.
+ */
+static int64_t host_now_ns(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (int64_t)now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+/**
+ * @brief Intercambia dos clientes virtuales del heap de un canal y actualiza sus posiciones.
+ * 
+ * @param channel Canal del host.
+ * @param a Posicion del primer cliente virtual.
+ * @param b Posicion del segundo cliente virtual.
+ * 
+ * @return No devuelve ningún valor.
+ */
+static void heap_swap(HostChannel* channel, int a, int b)
+{
+    VirtualClient* heap = channel->clients;
+    VirtualClient aux = heap[a];
+
+    heap[a] = heap[b];
+    heap[b] = aux;
+
+    channel->position[heap[a].vid - channel->first_vid] = a;
+    channel->position[heap[b].vid - channel->first_vid] = b;
+}
+
+/**
+ * @brief Reubica hacia abajo un cliente virtual del heap de un canal hasta restablecer el orden por vencimiento.
+ * 
+ * @param channel Canal del host.
+ * @param index Posicion del cliente virtual a reubicar.
+ * 
+ * @return No devuelve ningún valor.
+ */
+static void heap_sift_down(HostChannel* channel, int index)
+{
+    VirtualClient* heap = channel->clients;
+
+    while (1)
+    {
+        int smallest = index, left = 2 * index + 1, right = left + 1;
+
+        if (left < channel->count && heap[left].next_ns < heap[smallest].next_ns)
+            smallest = left;
+
+        if (right < channel->count && heap[right].next_ns < heap[smallest].next_ns)
+            smallest = right;
+
+        if (smallest == index)
+            return;
+
+        heap_swap(channel, index, smallest);
+
+        index = smallest;
+    }
+}
+
+/**
+ * @brief Reubica un cliente virtual del heap de un canal cuyo vencimiento cambio, hacia arriba o hacia abajo.
+ * 
+ * @param channel Canal del host.
+ * @param index Posicion del cliente virtual a reubicar.
+ * 
+ * @return No devuelve ningún valor.
+ */
+static void heap_update(HostChannel* channel, int index)
+{
+    VirtualClient* heap = channel->clients;
+
+    while (index > 0 && heap[index].next_ns < heap[(index - 1) / 2].next_ns)
+    {
+        heap_swap(channel, index, (index - 1) / 2);
+
+        index = (index - 1) / 2;
+    }
+
+    heap_sift_down(channel, index);
+}
+
+/**
+ * @brief Calcula el instante del proximo envio de un cliente virtual, uniforme en [P/2, 3P/2) a partir de 'from'.
+ * 
+ * @param from Instante de referencia, en nanosegundos.
+ * 
+ * @return Instante del proximo envio, en nanosegundos.
+ */
+static int64_t next_send(int64_t from)
+{
+    double jitter = (double)rand() / ((double)RAND_MAX + 1.0);
+
+    return from + host.period_ns / 2 + (int64_t)(jitter * (double)host.period_ns);
+}
+
+/**
+ * @brief Suma al promedio el tiempo transcurrido con las solicitudes en vuelo actuales y aplica un cambio.
+ * 
+ * @param channel Canal del host.
+ * @param delta Cambio de las solicitudes en vuelo (+1 o -1).
+ * @param now Instante actual, en nanosegundos.
+ * 
+ * @return No devuelve ningún valor.
+ */
+static void track_outstanding(HostChannel* channel, int delta, int64_t now)
+{
+    channel->outstanding_ns += channel->outstanding * (now - channel->mark_ns);
+    channel->mark_ns = now;
+    channel->outstanding += delta;
+
+    if (channel->outstanding > channel->max_outstanding)
+        channel->max_outstanding = channel->outstanding;
+}
+
+/**
+ * @brief Descarta el mensaje en curso de un cliente virtual y agenda su proximo envio.
+ * 
+ * @param channel Canal del host.
+ * @param next Cliente virtual.
+ * @param now Instante actual, en nanosegundos.
+ * 
+ * @return No devuelve ningún valor.
+ */
+static void drop_message(HostChannel* channel, VirtualClient* next, int64_t now)
+{
+    next->seq++;
+    next->state = VIRTUAL_IDLE;
+    next->next_ns = next_send(now);
+
+    channel->dropped++;
+}
+
+/**
+ * @brief Procesa el evento vencido de un cliente virtual de un canal con handshake, sin esperar al servidor.
+ * 
+ * Formatea el mensaje al llegar su instante de envio, reserva los creditos (reintentando cada HOST_CREDIT_RETRY_MS hasta
+ * el limite de la politica) y envia la solicitud; una solicitud sin respuesta en IPC_REPLY_TIMEOUT_MS se reintenta si el
+ * servidor se reinicio en caliente y se descarta en caso contrario.
+ * 
+ * @param channel Canal del host.
+ * @param next Cliente virtual con el evento vencido.
+ * @param now Instante actual, en nanosegundos.
+ * 
+ * @return No devuelve ningún valor.
+ */
+static void host_due(HostChannel* channel, VirtualClient* next, int64_t now)
+{
+    client->vid = next->vid;
+    client->seq = next->seq;
+
+    switch (next->state)
+    {
+        case VIRTUAL_IDLE:
+            snprintf(next->msg, sizeof(next->msg), "%d", next->counter++);
+            next->backoff_us = tuning.backoff_min_us;
+            next->state = VIRTUAL_CREDITS;
+            next->since_ns = now;
+            break;
+
+        case VIRTUAL_BACKOFF:
+            next->state = VIRTUAL_CREDITS;
+            next->since_ns = now;
+            break;
+
+        case VIRTUAL_REQUESTED:
+            track_outstanding(channel, -1, now);
+            channel->timeouts++;
+
+            trace_event(TRACE_TIMEOUT, client->type, 0, client->vid, client->seq);
+
+            if (read_server_pid() != client->server_pid && refresh_server_pid())
+            {
+                refund_credits((int)strlen(next->msg) + 1);
+
+                next->state = VIRTUAL_CREDITS;
+                next->since_ns = now;
+                break;
+            }
+
+            drop_message(channel, next, now);
+            return;
+
+        case VIRTUAL_CREDITS:
+            break;
+    }
+
+    int bytes = (int)strlen(next->msg) + 1;
+
+    if (!try_credits(bytes))
+    {
+        if (client->credit_policy == CREDIT_FAIL_FAST || now - next->since_ns >= tuning.credit_block_timeout_ms * 1000000LL)
+        {
+            atomic_fetch_add(&client->credit->dropped, 1);
+            drop_message(channel, next, now);
+        }
+        else
+            next->next_ns = now + HOST_CREDIT_RETRY_MS * 1000000LL;
+
+        return;
+    }
+
+    if (!request_start(bytes))
+    {
+        drop_message(channel, next, now);
+        return;
+    }
+
+    track_outstanding(channel, 1, now);
+
+    next->state = VIRTUAL_REQUESTED;
+    next->next_ns = now + tuning.reply_timeout_ms * 1000000LL;
+}
+
+/**
+ * @brief Procesa una respuesta del servidor en un canal con handshake.
+ * 
+ * La respuesta se asigna al cliente virtual que indica su valor; las que no corresponden a una solicitud en vuelo (llegadas
+ * despues de su vencimiento) se ignoran. Con START_WRITE el mensaje se escribe de inmediato; con WAIT la solicitud se
+ * reintenta tras un retroceso exponencial con jitter entre IPC_BACKOFF_MIN_US e IPC_BACKOFF_MAX_US.
+ * 
+ * @param channel Canal del host.
+ * @param value Valor de la señal de respuesta.
+ * @param now Instante actual, en nanosegundos.
+ * 
+ * @return No devuelve ningún valor.
+ */
+static void host_reply(HostChannel* channel, int value, int64_t now)
+{
+    uint32_t offset = ((uint32_t)value >> CONTROL_VID_SHIFT & CONTROL_VID_MASK) - channel->first_vid;
+
+    if (offset >= (uint32_t)channel->count)
+        return;
+
+    int index = channel->position[offset];
+    VirtualClient* next = &channel->clients[index];
+    USRSignalType response = (USRSignalType)(value & 3);
+
+    if (next->state != VIRTUAL_REQUESTED)
+        return;
+
+    track_outstanding(channel, -1, now);
+
+    client->vid = next->vid;
+    client->seq = next->seq;
+
+    trace_event(response == START_WRITE ? TRACE_GRANT : TRACE_WAIT, client->type, 0, client->vid, client->seq);
+
+    if (response == START_WRITE)
+    {
+        client->write(next->msg);
+
+        next->seq = client->seq;
+        next->state = VIRTUAL_IDLE;
+        next->next_ns = next_send(now);
+
+        channel->sent++;
+    }
+    else
+    {
+        long delay_us = next->backoff_us / 2 + rand() % (next->backoff_us / 2 + 1);
+
+        next->state = VIRTUAL_BACKOFF;
+        next->next_ns = now + delay_us * 1000LL;
+
+        if (next->backoff_us < tuning.backoff_max_us)
+            next->backoff_us = next->backoff_us * 2 < tuning.backoff_max_us ? next->backoff_us * 2 : tuning.backoff_max_us;
+    }
+
+    heap_update(channel, index);
+}
+
+/**
+ * @brief Bucle de eventos de un canal con handshake: solicita el canal por todos los clientes virtuales vencidos sin esperar
+ * las respuestas, y las atiende a medida que llegan en la SIGNAL_REPLY del canal.
+ * 
+ * @param channel Canal del host.
+ * 
+ * @return No devuelve ningún valor.
+ */
+static void host_channel_events(HostChannel* channel)
+{
+    sigset_t reply_set;
+    siginfo_t info;
+    int64_t start = host_now_ns();
+
+    sigemptyset(&reply_set);
+    sigaddset(&reply_set, SIGNAL_REPLY(channel->type));
+
+    channel->mark_ns = start;
+
+    while (!atomic_load(&host.stop))
+    {
+        int64_t now = host_now_ns();
+
+        while (channel->clients[0].next_ns <= now)
+        {
+            host_due(channel, &channel->clients[0], now);
+            heap_sift_down(channel, 0);
+        }
+
+        int64_t wait_ns = channel->clients[0].next_ns - now;
+
+        if (wait_ns > HOST_POLL_MS * 1000000LL)
+            wait_ns = HOST_POLL_MS * 1000000LL;
+
+        struct timespec wait_time = { (time_t)(wait_ns / 1000000000LL), (long)(wait_ns % 1000000000LL) };
+
+        if (sigtimedwait(&reply_set, &info, &wait_time) == SIGNAL_REPLY(channel->type))
+            host_reply(channel, info.si_value.sival_int, host_now_ns());
+    }
+
+    int64_t end = host_now_ns();
+
+    track_outstanding(channel, 0, end);
+
+    channel->elapsed_ns = end - start;
+}
+
+/**
+ * @brief Bucle de un canal sin handshake (MAPPED FILE o el anillo de SHARED MEMORY): envia los mensajes de sus clientes
+ * virtuales en orden de vencimiento, cada envio se completa sin esperar al servidor.
+ * 
+ * @param channel Canal del host.
+ * 
+ * @return No devuelve ningún valor.
+ */
+static void host_channel_schedule(HostChannel* channel)
+{
+    char msg[12];
+
+    while (!atomic_load(&host.stop))
+    {
+        VirtualClient* next = &channel->clients[0];
+        int64_t wait_ns = next->next_ns - host_now_ns();
+
+        if (wait_ns > 0)
+        {
+            int64_t nap_ns = wait_ns < HOST_POLL_MS * 1000000LL ? wait_ns : HOST_POLL_MS * 1000000LL;
+            struct timespec nap = { (time_t)(nap_ns / 1000000000LL), (long)(nap_ns % 1000000000LL) };
+
+            nanosleep(&nap, NULL);
+            continue;
+        }
+
+        client->vid = next->vid;
+        client->seq = next->seq;
+
+        snprintf(msg, sizeof(msg), "%d", next->counter++);
+
+        if (client->send(msg))
+            channel->sent++;
+        else
+            channel->dropped++;
+
+        next->seq = client->seq;
+        next->next_ns = next_send(host_now_ns());
+
+        heap_sift_down(channel, 0);
+    }
+}
+
+/**
+ * @brief Hilo de un canal del host: atiende a sus clientes virtuales con un bucle de eventos si el canal tiene handshake,
+ * o en orden de vencimiento si no lo tiene.
+ * 
+ * @param arg Puntero al HostChannel atendido.
+ * 
+ * @return NULL.
+ */
+static void* host_channel_thread(void* arg)
+{
+    HostChannel* channel = arg;
+
+    client = client_factory(channel->type, host.server_pid);
+
+    client->credit_page = host.owner->credit_page;
+    client->credit = host.owner->credit;
+    client->credit_policy = host.owner->credit_policy;
+
+    if (client->init)
+        client->init();
+
+    if (client->write)
+        host_channel_events(channel);
+    else
+        host_channel_schedule(channel);
+
+    if (client->type == SHARED_MEMORY)
+    {
+        shmdt(client->shm);
+
+        if (client->ring)
+            shmdt(client->ring);
+    }
+
+    if (client->mapped)
+        munmap(client->mapped, sizeof(MappedFile));
+
+    free(client);
+
+    return NULL;
+}
+
+/**
+ * @brief Interpreta los argumentos del modo host.
+ * 
+ * @param argc Número de argumentos proporcionados.
+ * @param argv Arreglo de argumentos proporcionados.
+ * @param clients Cantidad de clientes virtuales.
+ * @param mix Peso de cada canal.
+ * 
+ * @return 1 si los argumentos son validos, 0 en caso contrario.
+ */
+static int parse_host_args(int argc, char* argv[], int* clients, int mix[CHANNEL_COUNT])
+{
+    long period_ms = HOST_PERIOD_MS;
+
+    *clients = 0;
+
+    for (int i = 0; i < CHANNEL_COUNT; i++)
+        mix[i] = i == MAPPED_FILE ? 0 : 1;
+
+    for (int i = 1; i < argc; i += 2)
+    {
+        if (i + 1 >= argc)
+            return 0;
+
+        if (strcmp(argv[i], "--clients") == 0)
+            *clients = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--period-ms") == 0)
+            period_ms = atol(argv[i + 1]);
+        else if (strcmp(argv[i], "--channel-mix") == 0)
+        {
+            mix[MAPPED_FILE] = 0;
+
+            if (sscanf(argv[i + 1], "%d:%d:%d:%d", &mix[FIFO], &mix[SHARED_MEMORY], &mix[MESSAGE_QUEUE], &mix[MAPPED_FILE]) < 3)
+                return 0;
+        }
+        else
+            return 0;
+    }
+
+    host.period_ns = (int64_t)period_ms * 1000000LL;
+
+    int weight = 0;
+
+    for (int i = 0; i < CHANNEL_COUNT; i++)
+    {
+        if (mix[i] < 0)
+            return 0;
+
+        weight += mix[i];
+    }
+
+    return *clients > 0 && *clients <= CONTROL_VID_MASK && period_ms > 0 && weight > 0;
+}
+
+void client_host_run(int argc, char* argv[])
+{
+    int clients, mix[CHANNEL_COUNT], weight = 0, assigned = 0, signal;
+    uint32_t vid = 1;
+    sigset_t set;
+    struct timespec poll_time = {1, 0};
+
+    if (!parse_host_args(argc, argv, &clients, mix))
+    {
+        fprintf(stderr, "\033[1;31mArgumentos invalidos !\033[0m\n");
+        print_host_help();
+        exit(EXIT_FAILURE);
+    }
+
+    if ((host.server_pid = read_server_pid()) == -1)
+    {
+        fprintf(stderr, "\033[1;31mNo se encontró un servidor en ejecucion !\033[0m\n");
+        exit(EXIT_FAILURE);
+    }
+
+    srand((unsigned int)getpid());
+
+    client = host.owner = client_factory(FIFO, host.server_pid);
+
+    const char* policy = config_get("IPC_CREDIT_POLICY");
+
+    client->credit_policy = (policy && strcmp(policy, "fail") == 0) ? CREDIT_FAIL_FAST : CREDIT_BLOCK;
+
+    credit_page_init();
+
+    tracer_init("client");
+
+    int last = 0;
+
+    for (int i = 0; i < CHANNEL_COUNT; i++)
+    {
+        weight += mix[i];
+
+        if (mix[i] > 0)
+            last = i;
+    }
+
+    int64_t now = host_now_ns();
+
+    for (int i = 0; i < CHANNEL_COUNT; i++)
+    {
+        HostChannel* channel = &host.channels[i];
+
+        channel->type = (ChannelType)i;
+        channel->count = i == last ? clients - assigned : (int)((long)clients * mix[i] / weight);
+        channel->clients = calloc((size_t)(channel->count ? channel->count : 1), sizeof(VirtualClient));
+        channel->position = calloc((size_t)(channel->count ? channel->count : 1), sizeof(int));
+        channel->first_vid = vid;
+
+        assigned += channel->count;
+
+        for (int j = 0; j < channel->count; j++)
+        {
+            channel->position[j] = j;
+            channel->clients[j].vid = vid++;
+            channel->clients[j].next_ns = now + (int64_t)((double)rand() / ((double)RAND_MAX + 1.0) * (double)host.period_ns);
+        }
+
+        for (int j = channel->count / 2 - 1; j >= 0; j--)
+            heap_sift_down(channel, j);
+    }
+
+    sigemptyset(&set);
+    sigaddset(&set, SIGTERM);
+    sigaddset(&set, SIGINT);
+    sigaddset(&set, SIGHUP);
+
+    for (int i = 0; i <= MESSAGE_QUEUE; i++)
+        sigaddset(&set, SIGNAL_REPLY(i));
+
+    sigprocmask(SIG_BLOCK, &set, NULL);
+
+    for (int i = 0; i < CHANNEL_COUNT; i++)
+        if (host.channels[i].count > 0 && pthread_create(&host.channels[i].thread, NULL, host_channel_thread, &host.channels[i]) != 0)
+        {
+            fprintf(stderr, "\033[1;31mNo se pudo iniciar el hilo del canal %s !\033[0m\n", ChannelStringType[i]);
+            exit(EXIT_FAILURE);
+        }
+
+    fprintf(stdout, "\033[1;34mHost de clientes virtuales -> PID: %d, %d clientes (FIFO %d, SHARED MEMORY %d, MESSAGE QUEUE %d, MAPPED FILE %d)\033[0m\n",
+            getpid(), clients, host.channels[FIFO].count, host.channels[SHARED_MEMORY].count, host.channels[MESSAGE_QUEUE].count,
+            host.channels[MAPPED_FILE].count);
+
+    for (int i = 0; i <= MESSAGE_QUEUE; i++)
+        sigdelset(&set, SIGNAL_REPLY(i));
+
+    do
+        signal = sigtimedwait(&set, NULL, &poll_time);
+    while (signal == -1 && access(config_pid_file(), F_OK) != -1);
+
+    atomic_store(&host.stop, 1);
+
+    for (int i = 0; i < CHANNEL_COUNT; i++)
+    {
+        HostChannel* channel = &host.channels[i];
+
+        if (channel->count > 0)
+            pthread_join(channel->thread, NULL);
+
+        fprintf(stderr, "\033[1;31m%-13s: %d clientes virtuales, %ld mensajes enviados, %ld descartados", ChannelStringType[i], channel->count, channel->sent, channel->dropped);
+
+        if (channel->elapsed_ns > 0)
+            fprintf(stderr, ", %ld sin respuesta, solicitudes en vuelo: media %.2f, max %d", channel->timeouts,
+                    (double)channel->outstanding_ns / (double)channel->elapsed_ns, channel->max_outstanding);
+
+        fprintf(stderr, "\033[0m\n");
+
+        free(channel->clients);
+        free(channel->position);
+    }
+
+    if (client->credit)
+        atomic_store(&client->credit->pid, -1);
+
+    shmdt(client->credit_page);
+
+    tracer_dump();
+
+    free(client);
+
+    exit(EXIT_SUCCESS);
+}
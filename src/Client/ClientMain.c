@@ -0,0 +1,46 @@
+/**
+ * @file ClientMain.c
+ * @author Bottini, Franco Nicolas.
+ * @brief Punto de entrada del Cliente IPC.
+ * @version 1.0.1
+ * @date Marzo de 2023.
+ * 
+ * @copyright Copyright (c) 2023
+ * 
+ */
+
+#include "ClientHost.h"
+
+int main(int argc, char* argv[])
+{
+	client_configure();
+
+	if (argc > 1 && strncmp(argv[1], "--", 2) == 0)
+		client_host_run(argc, argv);
+
+	client_init(argc, argv);
+
+	signal_handler_init();
+
+	int n = 0;
+
+	sleep((unsigned int)(rand() % 3));
+
+	while (1)
+	{
+		char aux[11];
+
+		sprintf(aux, "%d", n);
+
+		client->send(aux);
+		
+		n++;
+
+		sleep((unsigned int)(rand() % 5 + 1));
+
+		if (access(config_pid_file(), F_OK) == -1)
+			end_client();
+	}
+
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,315 @@
+/**
+ * @file Config.c
+ * @author Bottini, Franco Nicolas.
+ * @brief Implementacion de la configuracion en tiempo de ejecucion, comun al Server y a los clientes.
+ * @version 1.0
+ * @date Marzo de 2023.
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <ctype.h>
+#include "Config.h"
+
+/**
+ * Clave de configuracion admitida.
+*/
+typedef struct ConfigKey
+{
+    //Nombre de la clave, igual al de la variable de entorno.
+    const char* name;
+
+    //1 si el servidor aplica los cambios de la clave al recargar la configuracion (SIGHUP).
+    int reloadable;
+} ConfigKey;
+
+//Claves admitidas en el archivo de configuracion.
+static const ConfigKey config_keys[] =
+{
+    { "IPC_FIFO_NAME", 0 },
+    { "IPC_PID_FILE", 0 },
+    { "IPC_KEY_PATH", 0 },
+    { "IPC_KEY_ID", 0 },
+    { "IPC_CREDIT_POLICY", 0 },
+    { "IPC_CLIENT_WEIGHT", 0 },
+    { "IPC_REPLY_TIMEOUT_MS", 0 },
+    { "IPC_BACKOFF_MIN_US", 0 },
+    { "IPC_BACKOFF_MAX_US", 0 },
+    { "IPC_CREDIT_BLOCK_TIMEOUT_MS", 0 },
+    { "IPC_RESTART_WAIT_MS", 0 },
+    { "IPC_EVENT_TRACE", 0 },
+    { "IPC_PROFILE", 0 },
+    { "IPC_MAPPED_FILE", 0 },
+    { "IPC_MAPPED_MODE", 0 },
+    { "IPC_SHM_SIZE", 0 },
+    { "IPC_SHM_HUGEPAGES", 0 },
+    { "IPC_SHM_NUMA_NODE", 0 },
+    { "IPC_SHM_LOWLAT", 0 },
+    { "IPC_SHM_CPU", 0 },
+    { "IPC_JOURNAL_DIR", 0 },
+    { "IPC_TRACE_FILE", 0 },
+    { "IPC_PIPELINE", 0 },
+    { "IPC_FILTER_NUMERIC", 0 },
+    { "IPC_FORWARD_FILE", 0 },
+    { "IPC_CPU_RECEIVE", 0 },
+    { "IPC_CPU_STATS", 0 },
+    { "IPC_CPU_LOG", 0 },
+    { "IPC_CPU_ISOLATE", 0 },
+    { "IPC_SCHED_FIFO", 0 },
+    { "IPC_CHECKSUM", 0 },
+    { "IPC_SLAB_PAGES", 0 },
+    { "IPC_PIPELINE_QUEUE_SIZE", 0 },
+    { "IPC_MQ_BRIDGE_DEPTH", 0 },
+    { "IPC_TRACE_RING_EVENTS", 0 },
+    { "IPC_LOCK_TIMEOUT_MS", 1 },
+    { "IPC_DISPATCH_BUDGET", 1 },
+    { "IPC_PIPELINE_BATCH", 1 },
+    { "IPC_GRANT_QUANTUM_BYTES", 1 },
+    { "IPC_GRANT_QUEUE_TIMEOUT_MS", 1 },
+    { "IPC_GRANT_IDLE_RESET_MS", 1 },
+    { "IPC_JOURNAL_SYNC_MSGS", 1 },
+    { "IPC_JOURNAL_SYNC_MS", 1 },
+    { "IPC_DASHBOARD_MS", 1 },
+    { "IPC_VERBOSE_SAMPLE", 1 },
+    { "IPC_MAPPED_SAMPLE_MS", 1 },
+    { "IPC_SHM_SPIN_US", 1 }
+};
+
+//Cantidad de claves admitidas.
+#define CONFIG_KEYS ((int)(sizeof(config_keys) / sizeof(config_keys[0])))
+
+/**
+ * Valor de una clave leido del archivo de configuracion.
+*/
+typedef struct ConfigValue
+{
+    //1 si la clave esta definida en el archivo.
+    int set;
+
+    //Valor de la clave.
+    char value[CONFIG_VALUE_MAX];
+} ConfigValue;
+
+/**
+ * @struct config
+ *
+ * Estructura que almacena los valores leidos del archivo de configuracion.
+*/
+struct
+{
+    //Path del archivo de configuracion.
+    char path[256];
+
+    //Valores de las claves definidas en el archivo.
+    ConfigValue values[CONFIG_KEYS];
+} config;
+
+/**
+ * @brief Busca una clave en la tabla de claves admitidas.
+ *
+ * @param name Nombre de la clave.
+ *
+ * @return Indice de la clave, o -1 si la clave no existe.
+*/
+static int config_find(const char* name)
+{
+    for (int i = 0; i < CONFIG_KEYS; i++)
+        if (strcmp(config_keys[i].name, name) == 0)
+            return i;
+
+    return -1;
+}
+
+/**
+ * @brief Quita los espacios al principio y al final de una cadena.
+ *
+ * @param text Cadena a recortar (se modifica).
+ *
+ * @return Puntero al primer caracter no blanco.
+*/
+static char* config_trim(char* text)
+{
+    char *end;
+
+    while (isspace((unsigned char)*text))
+        text++;
+
+    end = text + strlen(text);
+
+    while (end > text && isspace((unsigned char)end[-1]))
+        *--end = '\0';
+
+    return text;
+}
+
+/**
+ * @brief Lee el archivo de configuracion.
+ *
+ * @param values Destino de los valores leidos (se borra antes de leer).
+ *
+ * @return 1 si el archivo existe. 0 en caso contrario.
+*/
+static int config_load(ConfigValue values[CONFIG_KEYS])
+{
+    char line[CONFIG_VALUE_MAX + 128];
+    FILE *fp;
+
+    memset(values, 0, sizeof(ConfigValue) * CONFIG_KEYS);
+
+    if ((fp = fopen(config.path, "r")) == NULL)
+        return 0;
+
+    for (int number = 1; fgets(line, sizeof(line), fp) != NULL; number++)
+    {
+        char *text = config_trim(line), *separator = strchr(text, '=');
+
+        if (*text == '\0' || *text == '#')
+            continue;
+
+        if (!separator)
+        {
+            fprintf(stderr, "\033[1;31m%s:%d: se esperaba 'CLAVE = valor'\033[0m\n", config.path, number);
+            continue;
+        }
+
+        *separator = '\0';
+
+        char *name = config_trim(text), *value = config_trim(separator + 1);
+        int index = config_find(name);
+
+        if (index == -1)
+        {
+            fprintf(stderr, "\033[1;31m%s:%d: clave desconocida %s\033[0m\n", config.path, number, name);
+            continue;
+        }
+
+        values[index].set = 1;
+        snprintf(values[index].value, sizeof(values[index].value), "%s", value);
+    }
+
+    fclose(fp);
+
+    return 1;
+}
+
+void config_init(void)
+{
+    const char* path = getenv("IPC_CONFIG");
+
+    snprintf(config.path, sizeof(config.path), "%s", path && *path ? path : CONFIG_FILE_DEFAULT);
+
+    if (!config_load(config.values) && path && *path)
+        fprintf(stderr, "\033[1;31mNo se pudo abrir el archivo de configuracion %s: %s\033[0m\n", config.path, strerror(errno));
+}
+
+const char* config_get(const char* name)
+{
+    const char* env = getenv(name);
+    int index = config_find(name);
+
+    if (env)
+        return env;
+
+    return index != -1 && config.values[index].set ? config.values[index].value : NULL;
+}
+
+long config_long(const char* name, long fallback, long min, long max)
+{
+    const char* value = config_get(name);
+    char *end;
+
+    if (!value || !*value)
+        return fallback;
+
+    errno = 0;
+
+    long number = strtol(value, &end, 10);
+
+    if (errno != 0 || *config_trim(end) != '\0' || number < min || number > max)
+    {
+        fprintf(stderr, "\033[1;31mValor invalido para %s: %s (debe estar entre %ld y %ld), se utiliza %ld\033[0m\n", name, value, min, max, fallback);
+        return fallback;
+    }
+
+    return number;
+}
+
+long config_pow2(const char* name, long fallback, long min, long max)
+{
+    long number = config_long(name, fallback, min, max);
+
+    if (number & (number - 1))
+    {
+        fprintf(stderr, "\033[1;31mValor invalido para %s: %ld (debe ser una potencia de 2), se utiliza %ld\033[0m\n", name, number, fallback);
+        return fallback;
+    }
+
+    return number;
+}
+
+const char* config_fifo_name(void)
+{
+    const char* name = config_get("IPC_FIFO_NAME");
+
+    return name && *name ? name : FIFO_NAME;
+}
+
+const char* config_pid_file(void)
+{
+    const char* name = config_get("IPC_PID_FILE");
+
+    return name && *name ? name : PID_SERVER_FILE;
+}
+
+key_t config_ipc_key(void)
+{
+    const char* path = config_get("IPC_KEY_PATH");
+
+    return ftok(path && *path ? path : CONFIG_KEY_PATH, (int)config_long("IPC_KEY_ID", CONFIG_KEY_ID, 1, 255));
+}
+
+int config_reload(void)
+{
+    ConfigValue values[CONFIG_KEYS];
+    int changed = 0;
+
+    if (!config_load(values))
+    {
+        fprintf(stdout, "\033[1;31mNo se pudo abrir el archivo de configuracion %s, se conserva la configuracion actual\033[0m\n", config.path);
+        fflush(stdout);
+        return 0;
+    }
+
+    for (int i = 0; i < CONFIG_KEYS; i++)
+    {
+        ConfigValue *current = &config.values[i];
+        const char* name = config_keys[i].name;
+
+        if (current->set == values[i].set && (!current->set || strcmp(current->value, values[i].value) == 0))
+            continue;
+
+        if (getenv(name))
+        {
+            fprintf(stdout, "  %s: definida en el entorno, se ignora el archivo\n", name);
+            continue;
+        }
+
+        if (!config_keys[i].reloadable)
+        {
+            fprintf(stdout, "\033[1;31m  %s: requiere reiniciar el servidor, se conserva %s\033[0m\n", name, current->set ? current->value : "(por defecto)");
+            continue;
+        }
+
+        fprintf(stdout, "  %s: %s -> %s\n", name, current->set ? current->value : "(por defecto)", values[i].set ? values[i].value : "(por defecto)");
+
+        *current = values[i];
+        changed++;
+    }
+
+    fprintf(stdout, "\033[1;34mConfiguracion recargada de %s: %d cambios aplicados\033[0m\n", config.path, changed);
+
+    fflush(stdout);
+
+    return changed;
+}
@@ -0,0 +1,298 @@
+/**
+ * @file Replay.c
+ * @author Bottini, Franco Nicolas.
+ * @brief Herramienta de reinyeccion de trazas de trafico grabadas por el Server IPC.
+ * @version 1.0
+ * @date Marzo de 2023.
+ * 
+ * @copyright Copyright (c) 2023
+ * 
+ */
+
+#include "Replay.h"
+
+/**
+ * @struct trace
+ * 
+ * Estructura que almacena la traza cargada y la velocidad de reinyeccion.
+*/
+struct
+{
+    //Registros de la traza.
+    TrafficRecord *records;
+
+    //Cantidad de registros de la traza.
+    size_t count;
+
+    //Duracion de la traza, en nanosegundos.
+    uint64_t span_ns;
+
+    //Factor de velocidad de reinyeccion. 0 reinyecta a la maxima velocidad posible.
+    double speed;
+} trace;
+
+/**
+ * @brief Calcula la diferencia entre dos instantes en nanosegundos.
+ * 
+ * @param end Instante final.
+ * @param start Instante inicial.
+ * 
+ * @return Diferencia en nanosegundos.
+*/
+static int64_t elapsed_ns(const struct timespec* end, const struct timespec* start)
+{
+    return (int64_t)(end->tv_sec - start->tv_sec) * 1000000000LL + (int64_t)(end->tv_nsec - start->tv_nsec);
+}
+
+void print_replay_help(void)
+{
+	fprintf(stdout, "\n\033[1;34m");
+	fprintf(stdout, "Uso: Replay <traza> [velocidad]\n");
+	fprintf(stdout, "	- traza: archivo grabado por el servidor con IPC_TRACE_FILE.\n");
+	fprintf(stdout, "	- velocidad: factor de velocidad de reinyeccion (1 por defecto, N para N veces mas rapido) o 'max'.\n");
+	fprintf(stdout, "\033[0m\n");
+}
+
+void load_trace(const char* path)
+{
+    FILE *fp;
+    uint32_t magic;
+    struct stat st;
+
+    if ((fp = fopen(path, "rb")) == NULL || fstat(fileno(fp), &st) == -1)
+    {
+        fprintf(stderr, "\033[1;31mNo se pudo abrir la traza %s: %s\033[0m\n", path, strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+
+    if (fread(&magic, sizeof(magic), 1, fp) != 1 || magic != TRAFFIC_TRACE_MAGIC)
+    {
+        fprintf(stderr, "\033[1;31mEl archivo %s no es una traza de trafico valida !\033[0m\n", path);
+        exit(EXIT_FAILURE);
+    }
+
+    trace.count = ((size_t)st.st_size - sizeof(magic)) / sizeof(TrafficRecord);
+    trace.records = malloc(trace.count * sizeof(TrafficRecord) + 1);
+    trace.count = fread(trace.records, sizeof(TrafficRecord), trace.count, fp);
+
+    fclose(fp);
+
+    for (size_t i = 0; i < trace.count; i++)
+        trace.span_ns += trace.records[i].delta_ns;
+}
+
+void replay_channel(ChannelType channel_type, int server_pid, const struct timespec* start, int report)
+{
+    ReplayReport result = { .channel = (int)channel_type };
+    char msg[MSG_MAX_SIZE];
+    uint64_t offset_ns = 0;
+    struct timespec now;
+
+    client = client_factory(channel_type, server_pid);
+
+    const char* policy = config_get("IPC_CREDIT_POLICY");
+
+    client->credit_policy = (policy && strcmp(policy, "fail") == 0) ? CREDIT_FAIL_FAST : CREDIT_BLOCK;
+
+    credit_page_init();
+
+    if (client->init)
+        client->init();
+
+    signal_handler_init();
+
+    for (size_t i = 0; i < trace.count; i++)
+    {
+        const TrafficRecord* record = &trace.records[i];
+
+        offset_ns += record->delta_ns;
+
+        if (record->channel != (uint16_t)channel_type)
+            continue;
+
+        result.scheduled++;
+
+        if (trace.speed > 0)
+        {
+            uint64_t scaled_ns = (uint64_t)((double)offset_ns / trace.speed);
+            struct timespec at = 
+            {
+                .tv_sec = start->tv_sec + (time_t)(scaled_ns / 1000000000ULL),
+                .tv_nsec = start->tv_nsec + (long)(scaled_ns % 1000000000ULL)
+            };
+
+            if (at.tv_nsec >= 1000000000L)
+            {
+                at.tv_sec++;
+                at.tv_nsec -= 1000000000L;
+            }
+
+            while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &at, NULL) == EINTR) { continue; }
+
+            clock_gettime(CLOCK_MONOTONIC, &now);
+
+            int64_t lag = elapsed_ns(&now, &at);
+
+            if (lag > 0)
+            {
+                result.lag_sum_ns += lag;
+
+                if (lag > result.lag_max_ns)
+                    result.lag_max_ns = lag;
+            }
+        }
+
+        size_t size = record->size > 1 && record->size <= MSG_MAX_SIZE ? record->size : 2;
+
+        snprintf(msg, size, "%0*ld", (int)size - 1, result.scheduled - 1);
+
+        if (channel_type == MESSAGE_QUEUE && record->priority >= PRIORITY_URGENT && record->priority <= PRIORITY_BULK)
+            client->priority = (MsgPriority)record->priority;
+
+        if (client->send(msg))
+            result.sent++;
+        else
+            result.failed++;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    result.elapsed_ns = elapsed_ns(&now, start);
+
+    write(report, &result, sizeof(result));
+}
+
+void print_replay_report(const ReplayReport* reports, int count, int64_t elapsed_ns)
+{
+    long scheduled = 0, sent = 0, failed = 0;
+    double target_s = trace.speed > 0 ? (double)trace.span_ns / trace.speed / 1e9 : 0.0;
+    double actual_s = (double)elapsed_ns / 1e9;
+
+    fprintf(stdout, "\033[1;34m\n");
+    fprintf(stdout, "REPLAY -> %zu mensajes, duracion grabada %.3f s, velocidad ", trace.count, (double)trace.span_ns / 1e9);
+
+    if (trace.speed > 0)
+        fprintf(stdout, "%.2fx\n\n", trace.speed);
+    else
+        fprintf(stdout, "maxima\n\n");
+
+    fprintf(stdout, "CANAL           PROGRAMADOS   ENVIADOS   FALLIDOS   LAG PROM (us)   LAG MAX (us)\n");
+
+    for (int i = 0; i < count; i++)
+    {
+        const ReplayReport* r = &reports[i];
+        double lag_avg = r->scheduled ? (double)r->lag_sum_ns / (double)r->scheduled / 1000.0 : 0.0;
+
+        fprintf(stdout, "%-15s %11ld %10ld %10ld %15.1f %14.1f\n", ChannelStringType[r->channel], r->scheduled, r->sent, r->failed, lag_avg, (double)r->lag_max_ns / 1000.0);
+
+        scheduled += r->scheduled;
+        sent += r->sent;
+        failed += r->failed;
+    }
+
+    fprintf(stdout, "\n");
+    fprintf(stdout, "TOTAL          : %ld programados, %ld enviados, %ld fallidos\n", scheduled, sent, failed);
+    fprintf(stdout, "DURACION       : %.3f s (objetivo %.3f s)\n", actual_s, target_s);
+
+    if (actual_s > 0)
+        fprintf(stdout, "TASA LOGRADA   : %.2f m/s\n", (double)sent / actual_s);
+
+    if (target_s > 0)
+    {
+        fprintf(stdout, "TASA OBJETIVO  : %.2f m/s\n", (double)scheduled / target_s);
+        fprintf(stdout, "RITMO          : %.1f %% del objetivo\n", actual_s > 0 ? target_s / actual_s * 100.0 : 100.0);
+    }
+
+    fprintf(stdout, "\033[0m\n");
+}
+
+int main(int argc, char* argv[])
+{
+    ReplayReport reports[CHANNEL_COUNT];
+    int channels[CHANNEL_COUNT] = { 0 };
+    int pipefd[2], server_pid, count = 0;
+    struct timespec start, end;
+
+    client_configure();
+
+    if (argc != 2 && argc != 3)
+    {
+        fprintf(stderr, "\033[1;31mNúmero de argumentos invalido !\033[0m\n");
+        print_replay_help();
+        exit(EXIT_FAILURE);
+    }
+
+    trace.speed = argc == 3 ? (strcmp(argv[2], "max") == 0 ? 0.0 : atof(argv[2])) : 1.0;
+
+    if (argc == 3 && strcmp(argv[2], "max") != 0 && trace.speed <= 0)
+    {
+        fprintf(stderr, "\033[1;31mVelocidad invalida !\033[0m\n");
+        print_replay_help();
+        exit(EXIT_FAILURE);
+    }
+
+    load_trace(argv[1]);
+
+    if ((server_pid = read_server_pid()) == -1)
+    {
+        fprintf(stderr, "\033[1;31mNo se encontró un servidor en ejecucion !\033[0m\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (size_t i = 0; i < trace.count; i++)
+        if (trace.records[i].channel < CHANNEL_COUNT)
+            channels[trace.records[i].channel] = 1;
+
+    if (pipe(pipefd) == -1)
+    {
+        fprintf(stderr, "\033[1;31mNo se pudo crear el pipe de los reportes: %s\033[0m\n", strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (int channel = 0; channel < CHANNEL_COUNT; channel++)
+    {
+        if (!channels[channel])
+            continue;
+
+        pid_t pid = fork();
+
+        if (pid == -1)
+        {
+            fprintf(stderr, "\033[1;31mNo se pudo crear el proceso de reproduccion del canal %s: %s\033[0m\n", ChannelStringType[channel], strerror(errno));
+            exit(EXIT_FAILURE);
+        }
+
+        if (pid == 0)
+        {
+            close(pipefd[0]);
+
+            replay_channel((ChannelType)channel, server_pid, &start, pipefd[1]);
+
+            exit(EXIT_SUCCESS);
+        }
+
+        count++;
+    }
+
+    close(pipefd[1]);
+
+    for (int i = 0; i < count; i++)
+        wait(NULL);
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    count = 0;
+
+    while (count < CHANNEL_COUNT && read(pipefd[0], &reports[count], sizeof(ReplayReport)) == sizeof(ReplayReport))
+        count++;
+
+    close(pipefd[0]);
+
+    print_replay_report(reports, count, elapsed_ns(&end, &start));
+
+    free(trace.records);
+
+    return 0;
+}
@@ -0,0 +1,662 @@
+/**
+ * @file Aggregator.c
+ * @author Bottini, Franco Nicolas.
+ * @brief Implementacion de la agregacion de lecturas numericas del Server IPC.
+ * @version 1.0
+ * @date Marzo de 2023.
+ * 
+ * @copyright Copyright (c) 2023
+ * 
+ */
+
+#include "Aggregator.h"
+
+/**
+ * Entrada de la tabla de agregados por cliente.
+*/
+typedef struct AggClient
+{
+    //PID del cliente (0 si la entrada esta libre).
+    pid_t pid;
+
+    //Identificador del cliente virtual dentro del proceso.
+    uint32_t vid;
+
+    //Canal de la ultima lectura del cliente.
+    ChannelType channel;
+
+    //Instante de la ultima lectura del cliente, en nanosegundos.
+    int64_t last_ns;
+
+    //Ventana a la que corresponde el resumen 'current'.
+    long window;
+
+    //Resumen de la ventana 'window'.
+    AggSummary current;
+
+    //Resumen de la ventana anterior a 'window'.
+    AggSummary last;
+} AggClient;
+
+/**
+ * Resumen de un cliente en la instantanea de los agregados.
+*/
+typedef struct AggClientRow
+{
+    //PID del cliente.
+    pid_t pid;
+
+    //Identificador del cliente virtual dentro del proceso.
+    uint32_t vid;
+
+    //Canal de la ultima lectura del cliente.
+    ChannelType channel;
+
+    //Resumen de la ultima ventana cerrada.
+    AggSummary last;
+} AggClientRow;
+
+/**
+ * @struct aggregates
+ * 
+ * Estructura que almacena los resumenes de la ventana actual y de la ultima ventana cerrada de cada canal y de cada cliente.
+*/
+struct
+{
+    //Numero de la ventana actual (segundos de CLOCK_MONOTONIC / AGG_WINDOW_SEC).
+    long window;
+
+    //Resumen de la ventana actual por canal.
+    AggSummary current[CHANNEL_COUNT];
+
+    //Resumen de la ultima ventana cerrada por canal.
+    AggSummary last[CHANNEL_COUNT];
+
+    //Sketch de cuantiles de la ventana actual por canal.
+    QuantileSketch current_sketch[CHANNEL_COUNT];
+
+    //Sketch de cuantiles de la ultima ventana cerrada por canal.
+    QuantileSketch last_sketch[CHANNEL_COUNT];
+
+    //Tabla de clientes con direccionamiento abierto y sondeo lineal.
+    AggClient clients[AGG_TABLE_SIZE];
+
+    //Cantidad de clientes registrados en la tabla.
+    int client_count;
+
+    //Proxima entrada de la tabla a revisar para liberar clientes terminados o inactivos.
+    uint32_t sweep;
+
+    //Entradas liberadas por terminar el proceso del cliente.
+    long exited;
+
+    //Entradas liberadas por inactividad.
+    long idle;
+
+    //Lecturas de clientes que no entraron en la tabla por estar llena.
+    long untracked;
+
+    //Cantidad de mensajes que no son lecturas numericas.
+    long invalid;
+} aggregates;
+
+/**
+ * @struct aggregate_snapshot
+ * 
+ * Estructura que almacena una copia de los agregados, tomada bajo el lock del servidor para imprimirla fuera de el.
+*/
+struct
+{
+    //Resumen de la ventana actual por canal.
+    AggSummary current[CHANNEL_COUNT];
+
+    //Resumen de la ultima ventana cerrada por canal.
+    AggSummary last[CHANNEL_COUNT];
+
+    //Sketch de cuantiles de la ventana actual por canal.
+    QuantileSketch current_sketch[CHANNEL_COUNT];
+
+    //Sketch de cuantiles de la ultima ventana cerrada por canal.
+    QuantileSketch last_sketch[CHANNEL_COUNT];
+
+    //Resumen de la ultima ventana cerrada de cada cliente.
+    AggClientRow clients[AGG_TABLE_LOAD];
+
+    //Cantidad de clientes en 'clients'.
+    int client_count;
+
+    //Entradas liberadas por terminar el proceso del cliente.
+    long exited;
+
+    //Entradas liberadas por inactividad.
+    long idle;
+
+    //Lecturas de clientes que no entraron en la tabla por estar llena.
+    long untracked;
+
+    //Cantidad de mensajes que no son lecturas numericas.
+    long invalid;
+} aggregate_snapshot;
+
+//Array auxiliar para obtener un elemento del enumerado 'ChannelType' en formato de cadena.
+extern const char* ChannelStringType[];
+
+/**
+ * @brief Convierte 8 digitos ASCII a su valor numerico en paralelo (SWAR).
+ * 
+ * @param chunk 8 caracteres cargados en un entero en orden little-endian.
+ * 
+ * @return Valor de los 8 digitos.
+*/
+static uint64_t parse_eight_digits(uint64_t chunk)
+{
+    chunk -= 0x3030303030303030ULL;
+    chunk = (chunk * 10) + (chunk >> 8);
+    chunk = (((chunk & 0x000000FF000000FFULL) * (100 + (1000000ULL << 32))) + (((chunk >> 16) & 0x000000FF000000FFULL) * (1 + (10000ULL << 32)))) >> 32;
+
+    return chunk;
+}
+
+/**
+ * @brief Determina si 8 caracteres cargados en un entero son todos digitos ASCII.
+ * 
+ * @param chunk 8 caracteres cargados en un entero.
+ * 
+ * @return 1 si son todos digitos. 0 en caso contrario.
+*/
+static int is_eight_digits(uint64_t chunk)
+{
+    return (((chunk & 0xF0F0F0F0F0F0F0F0ULL) | (((chunk + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) == 0x3333333333333333ULL);
+}
+
+int parse_reading(const char* msg, size_t len, double* value)
+{
+    size_t i = 0, digits = 0;
+    uint64_t integer = 0;
+    int negative = 0;
+
+    if (len && (msg[0] == '-' || msg[0] == '+'))
+    {
+        negative = msg[0] == '-';
+        i++;
+    }
+
+    while (len - i >= 8 && digits + 8 <= 16)
+    {
+        uint64_t chunk;
+
+        memcpy(&chunk, msg + i, sizeof(chunk));
+
+        if (!is_eight_digits(chunk))
+            break;
+
+        integer = integer * 100000000ULL + parse_eight_digits(chunk);
+        i += 8;
+        digits += 8;
+    }
+
+    while (i < len && msg[i] >= '0' && msg[i] <= '9' && digits < 19)
+    {
+        integer = integer * 10 + (uint64_t)(msg[i] - '0');
+        i++;
+        digits++;
+    }
+
+    if (i == len && digits > 0)
+    {
+        *value = negative ? -(double)integer : (double)integer;
+        return 1;
+    }
+
+    char buffer[MSG_MAX_SIZE + 1], *end;
+
+    if (len == 0 || len > MSG_MAX_SIZE)
+        return 0;
+
+    memcpy(buffer, msg, len);
+    buffer[len] = '\0';
+
+    *value = strtod(buffer, &end);
+
+    return end == buffer + len && isfinite(*value);
+}
+
+/**
+ * @brief Agrega una lectura a un resumen.
+ * 
+ * @param summary Resumen a actualizar.
+ * @param value Lectura.
+ * 
+ * @return No devuelve ningun valor.
+*/
+static void summary_add(AggSummary* summary, double value)
+{
+    if (summary->count == 0 || value < summary->min)
+        summary->min = value;
+
+    if (summary->count == 0 || value > summary->max)
+        summary->max = value;
+
+    summary->sum += value;
+    summary->count++;
+}
+
+/**
+ * @brief Agrega una lectura a un sketch de cuantiles.
+ * 
+ * @param sketch Sketch a actualizar.
+ * @param value Lectura.
+ * 
+ * @return No devuelve ningun valor.
+*/
+static void sketch_add(QuantileSketch* sketch, double value)
+{
+    int exponent;
+    double mantissa = frexp(fabs(value), &exponent);
+
+    sketch->count++;
+
+    if (value == 0 || exponent - 1 < AGG_SKETCH_MIN_EXP)
+    {
+        sketch->zero++;
+        return;
+    }
+
+    int row = exponent - 1 - AGG_SKETCH_MIN_EXP;
+    int column = (int)((mantissa * 2.0 - 1.0) * AGG_SKETCH_SUBBUCKETS);
+
+    if (row >= AGG_SKETCH_EXPONENTS)
+    {
+        row = AGG_SKETCH_EXPONENTS - 1;
+        column = AGG_SKETCH_SUBBUCKETS - 1;
+    }
+
+    if (value > 0)
+        sketch->positive[row * AGG_SKETCH_SUBBUCKETS + column]++;
+    else
+        sketch->negative[row * AGG_SKETCH_SUBBUCKETS + column]++;
+}
+
+/**
+ * @brief Obtiene el valor representativo (punto medio) de un bucket del sketch.
+ * 
+ * @param bucket Indice del bucket.
+ * 
+ * @return Modulo del valor representativo del bucket.
+*/
+static double sketch_bucket_value(int bucket)
+{
+    int row = bucket / AGG_SKETCH_SUBBUCKETS;
+    int column = bucket % AGG_SKETCH_SUBBUCKETS;
+
+    return ldexp(1.0 + ((double)column + 0.5) / AGG_SKETCH_SUBBUCKETS, row + AGG_SKETCH_MIN_EXP);
+}
+
+double sketch_quantile(const QuantileSketch* sketch, double q)
+{
+    if (sketch->count == 0)
+        return 0.0;
+
+    uint64_t rank = (uint64_t)(q * (double)(sketch->count - 1));
+    uint64_t seen = 0;
+
+    for (int i = AGG_SKETCH_BUCKETS - 1; i >= 0; i--)
+        if ((seen += sketch->negative[i]) > rank)
+            return -sketch_bucket_value(i);
+
+    if ((seen += sketch->zero) > rank)
+        return 0.0;
+
+    for (int i = 0; i < AGG_SKETCH_BUCKETS; i++)
+        if ((seen += sketch->positive[i]) > rank)
+            return sketch_bucket_value(i);
+
+    return sketch_bucket_value(AGG_SKETCH_BUCKETS - 1);
+}
+
+void sketch_merge(QuantileSketch* dst, const QuantileSketch* src)
+{
+    for (int i = 0; i < AGG_SKETCH_BUCKETS; i++)
+    {
+        dst->positive[i] += src->positive[i];
+        dst->negative[i] += src->negative[i];
+    }
+
+    dst->zero += src->zero;
+    dst->count += src->count;
+}
+
+/**
+ * @brief Obtiene el instante actual con la resolucion del reloj de baja precision, suficiente para ventanas e inactividad.
+ * 
+ * @return Instante actual en nanosegundos.
+*/
+static int64_t aggregate_now_ns(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &now);
+
+    return (int64_t)now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+/**
+ * @brief Cierra la ventana actual si ya transcurrio AGG_WINDOW_SEC desde su comienzo.
+ * 
+ * @param now Instante actual en nanosegundos.
+ * 
+ * @return No devuelve ningun valor.
+*/
+static void rotate_window(int64_t now)
+{
+    long window = (long)(now / 1000000000LL) / AGG_WINDOW_SEC;
+
+    if (window == aggregates.window)
+        return;
+
+    for (int i = 0; i < CHANNEL_COUNT; i++)
+    {
+        if (window == aggregates.window + 1)
+        {
+            aggregates.last[i] = aggregates.current[i];
+            aggregates.last_sketch[i] = aggregates.current_sketch[i];
+        }
+        else
+        {
+            memset(&aggregates.last[i], 0, sizeof(AggSummary));
+            memset(&aggregates.last_sketch[i], 0, sizeof(QuantileSketch));
+        }
+
+        memset(&aggregates.current[i], 0, sizeof(AggSummary));
+        memset(&aggregates.current_sketch[i], 0, sizeof(QuantileSketch));
+    }
+
+    aggregates.window = window;
+}
+
+/**
+ * @brief Obtiene la posicion inicial de un cliente en la tabla.
+ * 
+ * @param pid PID del cliente.
+ * @param vid Identificador del cliente virtual dentro del proceso.
+ * 
+ * @return Posicion inicial del sondeo lineal.
+*/
+static inline uint32_t aggregate_home(pid_t pid, uint32_t vid)
+{
+    return (((uint32_t)pid ^ vid * 0x9E3779B9U) * 2654435761U) & (AGG_TABLE_SIZE - 1);
+}
+
+/**
+ * @brief Libera una entrada de la tabla, desplazando hacia atras las entradas siguientes de la misma secuencia de
+ * sondeo para que ninguna busqueda se corte antes de encontrarlas.
+ * 
+ * @param hole Posicion de la entrada a liberar.
+ * 
+ * @return No devuelve ningun valor.
+*/
+static void remove_aggregate_client(uint32_t hole)
+{
+    for (uint32_t next = (hole + 1) & (AGG_TABLE_SIZE - 1); aggregates.clients[next].pid != 0; next = (next + 1) & (AGG_TABLE_SIZE - 1))
+    {
+        AggClient *entry = &aggregates.clients[next];
+        uint32_t home = aggregate_home(entry->pid, entry->vid);
+
+        if (((next - home) & (AGG_TABLE_SIZE - 1)) < ((next - hole) & (AGG_TABLE_SIZE - 1)))
+            continue;
+
+        aggregates.clients[hole] = *entry;
+        hole = next;
+    }
+
+    memset(&aggregates.clients[hole], 0, sizeof(AggClient));
+    aggregates.client_count--;
+}
+
+/**
+ * @brief Revisa las proximas AGG_SWEEP_STEP entradas de la tabla y libera las de clientes terminados o inactivos.
+ * 
+ * Solo se consulta si el proceso existe (kill con la señal 0) para los clientes sin lecturas durante AGG_IDLE_CHECK_MS.
+ * 
+ * @param now Instante actual en nanosegundos.
+ * 
+ * @return No devuelve ningun valor.
+*/
+static void sweep_aggregates(int64_t now)
+{
+    for (int i = 0; i < AGG_SWEEP_STEP; i++)
+    {
+        AggClient *entry = &aggregates.clients[aggregates.sweep];
+        int64_t idle_ns = now - entry->last_ns;
+
+        if (entry->pid != 0 && idle_ns > AGG_EVICT_MS * 1000000LL)
+        {
+            remove_aggregate_client(aggregates.sweep);
+            aggregates.idle++;
+            continue;
+        }
+
+        if (entry->pid != 0 && idle_ns > AGG_IDLE_CHECK_MS * 1000000LL && kill(entry->pid, 0) == -1 && errno == ESRCH)
+        {
+            remove_aggregate_client(aggregates.sweep);
+            aggregates.exited++;
+            continue;
+        }
+
+        aggregates.sweep = (aggregates.sweep + 1) & (AGG_TABLE_SIZE - 1);
+    }
+}
+
+/**
+ * @brief Busca (o crea) la entrada de un cliente en la tabla y la lleva a la ventana actual.
+ * 
+ * @param pid PID del cliente.
+ * @param vid Identificador del cliente virtual dentro del proceso.
+ * 
+ * @return Puntero a la entrada del cliente o NULL si la tabla esta llena.
+*/
+static AggClient* find_aggregate_client(pid_t pid, uint32_t vid)
+{
+    uint32_t index = aggregate_home(pid, vid);
+
+    for (int i = 0; i < AGG_TABLE_SIZE; i++)
+    {
+        AggClient *entry = &aggregates.clients[(index + (uint32_t)i) & (AGG_TABLE_SIZE - 1)];
+
+        if (entry->pid == 0)
+        {
+            if (aggregates.client_count >= AGG_TABLE_LOAD)
+                return NULL;
+
+            *entry = (AggClient) { .pid = pid, .vid = vid, .window = aggregates.window };
+            aggregates.client_count++;
+        }
+
+        if (entry->pid != pid || entry->vid != vid)
+            continue;
+
+        if (entry->window != aggregates.window)
+        {
+            if (entry->window == aggregates.window - 1)
+                entry->last = entry->current;
+            else
+                memset(&entry->last, 0, sizeof(AggSummary));
+
+            memset(&entry->current, 0, sizeof(AggSummary));
+            entry->window = aggregates.window;
+        }
+
+        return entry;
+    }
+
+    return NULL;
+}
+
+void aggregate_msg(ChannelType channel_type, pid_t pid, uint32_t vid, const char* msg, size_t len)
+{
+    double value;
+
+    aggregate_reading(channel_type, pid, vid, parse_reading(msg, len, &value) ? &value : NULL);
+}
+
+void aggregate_reading(ChannelType channel_type, pid_t pid, uint32_t vid, const double* value)
+{
+    if (channel_type >= CHANNEL_COUNT)
+        return;
+
+    if (!value)
+    {
+        aggregates.invalid++;
+        return;
+    }
+
+    int64_t now = aggregate_now_ns();
+
+    rotate_window(now);
+
+    summary_add(&aggregates.current[channel_type], *value);
+    sketch_add(&aggregates.current_sketch[channel_type], *value);
+
+    if (pid <= 0)
+        return;
+
+    sweep_aggregates(now);
+
+    AggClient *entry = find_aggregate_client(pid, vid);
+
+    if (!entry)
+    {
+        aggregates.untracked++;
+        return;
+    }
+
+    entry->channel = channel_type;
+    entry->last_ns = now;
+    summary_add(&entry->current, *value);
+}
+
+/**
+ * @brief Imprime por un determinado output un resumen y, opcionalmente, los cuantiles de su sketch.
+ * 
+ * @param fp File descriptor del archivo de salida.
+ * @param label Etiqueta del resumen.
+ * @param summary Resumen a imprimir.
+ * @param sketch Sketch de cuantiles, NULL si no se imprimen cuantiles.
+ * 
+ * @return No devuelve ningun valor.
+*/
+static void print_summary(FILE *fp, const char* label, const AggSummary* summary, const QuantileSketch* sketch)
+{
+    fprintf(fp, "  %-13s: n %ld", label, summary->count);
+
+    if (summary->count)
+        fprintf(fp, ", sum %.6g, min %.6g, max %.6g, avg %.6g", summary->sum, summary->min, summary->max, summary->sum / (double)summary->count);
+
+    if (sketch && sketch->count)
+        fprintf(fp, ", p50 %.6g, p90 %.6g, p99 %.6g", sketch_quantile(sketch, 0.5), sketch_quantile(sketch, 0.9), sketch_quantile(sketch, 0.99));
+
+    fprintf(fp, "\n");
+}
+
+/**
+ * @brief Imprime por un determinado output el total de los canales, combinando sus resumenes y sus sketches.
+ * 
+ * @param fp File descriptor del archivo de salida.
+ * @param summaries Resumenes de cada canal.
+ * @param sketches Sketches de cada canal.
+ * 
+ * @return No devuelve ningun valor.
+*/
+static void print_total(FILE *fp, const AggSummary* summaries, const QuantileSketch* sketches)
+{
+    QuantileSketch total_sketch = { 0 };
+    AggSummary total = { 0 };
+
+    for (int i = 0; i < CHANNEL_COUNT; i++)
+    {
+        if (summaries[i].count == 0)
+            continue;
+
+        if (total.count == 0 || summaries[i].min < total.min)
+            total.min = summaries[i].min;
+
+        if (total.count == 0 || summaries[i].max > total.max)
+            total.max = summaries[i].max;
+
+        total.sum += summaries[i].sum;
+        total.count += summaries[i].count;
+
+        sketch_merge(&total_sketch, &sketches[i]);
+    }
+
+    print_summary(fp, "TOTAL", &total, &total_sketch);
+}
+
+void snapshot_aggregates(void)
+{
+    rotate_window(aggregate_now_ns());
+
+    memcpy(aggregate_snapshot.current, aggregates.current, sizeof(aggregates.current));
+    memcpy(aggregate_snapshot.last, aggregates.last, sizeof(aggregates.last));
+    memcpy(aggregate_snapshot.current_sketch, aggregates.current_sketch, sizeof(aggregates.current_sketch));
+    memcpy(aggregate_snapshot.last_sketch, aggregates.last_sketch, sizeof(aggregates.last_sketch));
+
+    aggregate_snapshot.exited = aggregates.exited;
+    aggregate_snapshot.idle = aggregates.idle;
+    aggregate_snapshot.untracked = aggregates.untracked;
+    aggregate_snapshot.invalid = aggregates.invalid;
+    aggregate_snapshot.client_count = 0;
+
+    for (int i = 0; i < AGG_TABLE_SIZE && aggregate_snapshot.client_count < AGG_TABLE_LOAD; i++)
+    {
+        const AggClient *entry = &aggregates.clients[i];
+        AggClientRow *row = &aggregate_snapshot.clients[aggregate_snapshot.client_count];
+
+        if (entry->pid == 0)
+            continue;
+
+        *row = (AggClientRow) { .pid = entry->pid, .vid = entry->vid, .channel = entry->channel };
+
+        if (entry->window == aggregates.window)
+            row->last = entry->last;
+        else if (entry->window == aggregates.window - 1)
+            row->last = entry->current;
+
+        aggregate_snapshot.client_count++;
+    }
+}
+
+void print_aggregate_stats(FILE *fp)
+{
+    fprintf(fp, "AGREGADOS      : ventana de %d s (%ld mensajes no numericos)\n", AGG_WINDOW_SEC, aggregate_snapshot.invalid);
+
+    fprintf(fp, " Ultima ventana cerrada:\n");
+
+    for (int i = 0; i < CHANNEL_COUNT; i++)
+        print_summary(fp, ChannelStringType[i], &aggregate_snapshot.last[i], &aggregate_snapshot.last_sketch[i]);
+
+    print_total(fp, aggregate_snapshot.last, aggregate_snapshot.last_sketch);
+
+    fprintf(fp, " Ventana actual (parcial):\n");
+
+    for (int i = 0; i < CHANNEL_COUNT; i++)
+        print_summary(fp, ChannelStringType[i], &aggregate_snapshot.current[i], &aggregate_snapshot.current_sketch[i]);
+
+    print_total(fp, aggregate_snapshot.current, aggregate_snapshot.current_sketch);
+
+    if (fp == stdout)
+        return;
+
+    fprintf(fp, "AGREGADOS POR CLIENTE (%d clientes, %ld terminados, %ld inactivos, %ld lecturas sin registrar, ultima ventana cerrada):\n",
+            aggregate_snapshot.client_count, aggregate_snapshot.exited, aggregate_snapshot.idle, aggregate_snapshot.untracked);
+
+    for (int i = 0; i < aggregate_snapshot.client_count; i++)
+    {
+        const AggClientRow *row = &aggregate_snapshot.clients[i];
+        char label[64];
+
+        snprintf(label, sizeof(label), "%d vid %u %s", row->pid, row->vid, ChannelStringType[row->channel]);
+
+        print_summary(fp, label, &row->last, NULL);
+    }
+}
@@ -0,0 +1,190 @@
+/**
+ * @file Credits.c
+ * @author Bottini, Franco Nicolas.
+ * @brief Implementacion del control de flujo basado en creditos del Server IPC.
+ * @version 1.0
+ * @date Marzo de 2023.
+ * 
+ * @copyright Copyright (c) 2023
+ * 
+ */
+
+#include "Credits.h"
+#include "HotRestart.h"
+
+/**
+ * @struct credits
+ * 
+ * Estructura que almacena la pagina de control de creditos y las reservas de cada canal.
+*/
+struct
+{
+    //Identificador del segmento de memoria compartida de la pagina de control.
+    int shmid;
+
+    //Puntero a la pagina de control.
+    CreditPage *page;
+
+    //ID del proceso que reservo creditos para cada canal.
+    pid_t lease_pid[CHANNEL_COUNT];
+
+    //Bytes reservados por la solicitud que ocupa cada canal.
+    int lease_bytes[CHANNEL_COUNT];
+
+    //Mensajes drenados desde el ultimo crecimiento de la ventana.
+    int drained;
+
+    //Cantidad de solicitudes cuyos creditos fueron devueltos.
+    atomic_long released;
+} credits;
+
+/**
+ * @brief Busca la entrada de la pagina de control asociada a un cliente.
+ * 
+ * @param pid ID del proceso del cliente.
+ * 
+ * @return Puntero a la entrada del cliente o NULL si el cliente no registro una entrada.
+*/
+static CreditSlot* find_credit_slot(pid_t pid)
+{
+    if (!credits.page || pid <= 0)
+        return NULL;
+
+    for (int i = 0; i < CREDIT_SLOTS; i++)
+    {
+        CreditSlot *slot = &credits.page->slots[((unsigned int)pid + (unsigned int)i) % CREDIT_SLOTS];
+        int owner = atomic_load(&slot->pid);
+
+        if (owner == pid)
+            return slot;
+
+        if (owner == 0)
+            break;
+    }
+
+    return NULL;
+}
+
+void create_credit_page(void)
+{
+    key_t key = ftok(config_fifo_name(), 'C');
+
+    if ((credits.shmid = shmget(key, sizeof(CreditPage), IPC_CREAT | 0666)) == -1)
+    {
+        fprintf(stderr, "\033[1;31mFallo la creacion de la pagina de control de creditos: %s\033[0m\n", strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+
+    if ((credits.page = shmat(credits.shmid, NULL, 0)) == (CreditPage *) -1)
+    {
+        fprintf(stderr, "\033[1;31mNo se pudo agregar la pagina de control de creditos al espacio del proceso: %s\033[0m\n", strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+
+    if (hot_restart_adopting())
+        return;
+
+    memset(credits.page, 0, sizeof(CreditPage));
+
+    atomic_store(&credits.page->window_msgs, CREDIT_WINDOW_MSGS);
+    atomic_store(&credits.page->window_bytes, CREDIT_WINDOW_MSGS * CREDIT_BYTES_PER_MSG);
+}
+
+void lease_credits(ChannelType channel_type, pid_t pid, int bytes)
+{
+    credits.lease_pid[channel_type] = pid;
+    credits.lease_bytes[channel_type] = bytes;
+}
+
+void release_credits(pid_t pid, int bytes)
+{
+    CreditSlot *slot = find_credit_slot(pid);
+
+    if (!slot)
+        return;
+
+    atomic_fetch_sub(&slot->inflight_msgs, 1);
+    atomic_fetch_sub(&slot->inflight_bytes, bytes);
+
+    atomic_fetch_add_explicit(&credits.released, 1, memory_order_relaxed);
+}
+
+void release_lease(ChannelType channel_type, int timeout)
+{
+    if (!credits.lease_pid[channel_type])
+        return;
+
+    release_credits(credits.lease_pid[channel_type], credits.lease_bytes[channel_type]);
+
+    credits.lease_pid[channel_type] = 0;
+    credits.lease_bytes[channel_type] = 0;
+
+    int window = atomic_load(&credits.page->window_msgs);
+
+    if (timeout)
+    {
+        window = window > 1 ? window / 2 : 1;
+        credits.drained = 0;
+    }
+    else if (++credits.drained >= window && window < CREDIT_WINDOW_MAX)
+    {
+        window++;
+        credits.drained = 0;
+    }
+
+    atomic_store(&credits.page->window_msgs, window);
+    atomic_store(&credits.page->window_bytes, window * CREDIT_BYTES_PER_MSG);
+}
+
+void publish_isolated_cpus(const uint64_t mask[CPU_MASK_WORDS])
+{
+    if (credits.page)
+        memcpy(credits.page->isolated_cpus, mask, sizeof(credits.page->isolated_cpus));
+}
+
+int get_client_weight(pid_t pid)
+{
+    CreditSlot *slot = find_credit_slot(pid);
+    int weight = slot ? atomic_load(&slot->weight) : 1;
+
+    return weight < 1 ? 1 : (weight > GRANT_WEIGHT_MAX ? GRANT_WEIGHT_MAX : weight);
+}
+
+long get_client_signal_overflows(void)
+{
+    return credits.page ? atomic_load(&credits.page->signal_overflows) : 0;
+}
+
+void print_credit_stats(FILE *fp)
+{
+    int clients = 0;
+    long inflight = 0, dropped = 0;
+
+    if (!credits.page)
+        return;
+
+    for (int i = 0; i < CREDIT_SLOTS; i++)
+    {
+        CreditSlot *slot = &credits.page->slots[i];
+
+        if (atomic_load(&slot->pid) > 0)
+        {
+            clients++;
+            inflight += atomic_load(&slot->inflight_msgs);
+        }
+
+        dropped += atomic_load(&slot->dropped);
+    }
+
+    fprintf(fp, "CREDIT WINDOW  : %d msgs / %d bytes\n", atomic_load(&credits.page->window_msgs), atomic_load(&credits.page->window_bytes));
+    fprintf(fp, "CREDIT CLIENTS : %d (%ld en vuelo, %ld liberados)\n", clients, inflight, atomic_load(&credits.released));
+    fprintf(fp, "CLIENT DROPS   : %ld\n", dropped);
+}
+
+void remove_credit_page(void)
+{
+    shmdt(credits.page);
+
+    if (!hot_restart_handing_off())
+        shmctl(credits.shmid, IPC_RMID, NULL);
+}
@@ -0,0 +1,376 @@
+/**
+ * @file Dashboard.c
+ * @author Bottini, Franco Nicolas.
+ * @brief Implementacion del tablero de estadisticas de refresco fijo del Server IPC.
+ * @version 1.0
+ * @date Marzo de 2023.
+ * 
+ * @copyright Copyright (c) 2023
+ * 
+ */
+
+#include "Dashboard.h"
+#include "ServerUtils.h"
+#include "RateMeter.h"
+#include "Profiler.h"
+#include "Placement.h"
+
+/**
+ * @struct dashboard
+ * 
+ * Estructura que almacena la instantanea que lee el tablero y el estado de su hilo de refresco.
+*/
+struct
+{
+    //Periodo de refresco en milisegundos (0 si el tablero esta deshabilitado).
+    atomic_long period_ms;
+
+    //Se muestra uno de cada 'sample' mensajes (0 si no se muestran mensajes).
+    atomic_long sample;
+
+    //1 si la salida es una terminal y el tablero se redibuja en el lugar.
+    int tty;
+
+    //Hilo de refresco.
+    pthread_t thread;
+
+    //Indica al hilo de refresco que debe terminar.
+    atomic_int stop;
+
+    //Instante de inicio del servidor.
+    struct timespec start;
+
+    //Mensajes recibidos por canal.
+    atomic_long received[CHANNEL_COUNT];
+
+    //Timeouts por canal.
+    atomic_long timeouts[CHANNEL_COUNT];
+
+    //Histograma de latencias de entrega por canal.
+    atomic_long latency[CHANNEL_COUNT][DASHBOARD_LATENCY_BUCKETS];
+
+    //Proceso que ocupa cada canal (0 si esta libre).
+    atomic_int holder[CHANNEL_COUNT];
+
+    //Mensajes vistos por el muestreo.
+    atomic_long seen;
+
+    //Protege los mensajes muestreados.
+    pthread_mutex_t recent_mutex;
+
+    //Ultimos mensajes muestreados, en un buffer circular.
+    char recent[DASHBOARD_RECENT][128];
+
+    //Cantidad de mensajes muestreados.
+    long recent_count;
+} dashboard = { .recent_mutex = PTHREAD_MUTEX_INITIALIZER };
+
+//Array auxiliar para obtener un elemento del enumerado 'ChannelType' en formato de cadena.
+extern const char* ChannelStringType[];
+
+/**
+ * @brief Obtiene el bucket del histograma de latencias que corresponde a una latencia.
+ * 
+ * @param us Latencia en microsegundos.
+ * 
+ * @return Indice del bucket.
+*/
+static int latency_bucket(uint64_t us)
+{
+    if (us == 0)
+        return 0;
+
+    int exponent = 63 - __builtin_clzll(us);
+    int sub = (int)(exponent >= 2 ? (us >> (exponent - 2)) & 3 : (us << (2 - exponent)) & 3);
+    int index = 1 + exponent * 4 + sub;
+
+    return index < DASHBOARD_LATENCY_BUCKETS ? index : DASHBOARD_LATENCY_BUCKETS - 1;
+}
+
+/**
+ * @brief Obtiene la latencia representativa (limite inferior) de un bucket del histograma.
+ * 
+ * @param index Indice del bucket.
+ * 
+ * @return Latencia en microsegundos.
+*/
+static double bucket_value(int index)
+{
+    if (index == 0)
+        return 0.0;
+
+    int exponent = (index - 1) / 4, sub = (index - 1) % 4;
+
+    return ldexp(1.0 + sub / 4.0, exponent);
+}
+
+/**
+ * @brief Calcula un percentil de latencia de un canal a partir de su histograma.
+ * 
+ * @param channel_type Canal.
+ * @param q Percentil buscado (entre 0 y 1).
+ * 
+ * @return Latencia del percentil en microsegundos (0 si no hay mensajes).
+*/
+static double latency_percentile(ChannelType channel_type, double q)
+{
+    long counts[DASHBOARD_LATENCY_BUCKETS], total = 0, accumulated = 0;
+
+    for (int i = 0; i < DASHBOARD_LATENCY_BUCKETS; i++)
+        total += counts[i] = atomic_load_explicit(&dashboard.latency[channel_type][i], memory_order_relaxed);
+
+    if (total == 0)
+        return 0.0;
+
+    long target = (long)ceil(q * (double)total);
+
+    for (int i = 0; i < DASHBOARD_LATENCY_BUCKETS; i++)
+        if ((accumulated += counts[i]) >= target)
+            return bucket_value(i);
+
+    return bucket_value(DASHBOARD_LATENCY_BUCKETS - 1);
+}
+
+/**
+ * @brief Escribe las estadisticas completas en el archivo de estadisticas.
+ * 
+ * Solo la copia de la instantanea se hace con el lock del servidor tomado; el formato y la escritura del archivo se hacen
+ * despues de liberarlo, para no frenar al despachador.
+ * 
+ * @return No devuelve ningun valor.
+*/
+static void write_stats_file(void)
+{
+    ProfileSample sample;
+
+    server_lock();
+    snapshot_stats();
+    server_unlock();
+
+    profile_begin(&sample);
+
+    FILE *fp = fopen(get_stats_file(), "w");
+
+    if (fp)
+    {
+        print_stats(fp);
+        fclose(fp);
+    }
+
+    profile_end(PROFILE_STATS_FILE, &sample, 0);
+}
+
+/**
+ * @brief Dibuja el tablero a partir de la instantanea.
+ * 
+ * @return No devuelve ningun valor.
+*/
+static void draw_dashboard(void)
+{
+    struct timespec now;
+    long total = 0, total_timeouts = 0;
+    double bytes_rate;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    long uptime = now.tv_sec - dashboard.start.tv_sec;
+
+    if (dashboard.tty)
+        fprintf(stdout, "\033[H\033[J");
+
+    fprintf(stdout, "\x1b[36m");
+    fprintf(stdout, "\033[1;34mServer -> PID: %d, activo %02ld:%02ld:%02ld, refresco %ld ms\033[0m\x1b[36m\n\n", getpid(), uptime / 3600, uptime / 60 % 60, uptime % 60, atomic_load(&dashboard.period_ms));
+    fprintf(stdout, "%-13s  %10s  %9s  %9s  %9s  %9s  %9s  %8s  %8s\n", "CANAL", "MENSAJES", "m/s", "KB/s", "p50 us", "p90 us", "p99 us", "TIMEOUTS", "LOCK");
+
+    for (int i = 0; i < CHANNEL_COUNT; i++)
+    {
+        long received = atomic_load(&dashboard.received[i]);
+        long timeouts = atomic_load(&dashboard.timeouts[i]);
+        double rate = rate_meter_rate(i, 0, &bytes_rate);
+        int holder = atomic_load(&dashboard.holder[i]);
+        char lock[12] = "-";
+
+        if (holder)
+            snprintf(lock, sizeof(lock), "%d", holder);
+
+        fprintf(stdout, "%-13s  %10ld  %9.1f  %9.1f  %9.1f  %9.1f  %9.1f  %8ld  %8s\n", ChannelStringType[i], received, rate, bytes_rate / 1024.0,
+                latency_percentile((ChannelType)i, 0.50), latency_percentile((ChannelType)i, 0.90), latency_percentile((ChannelType)i, 0.99), timeouts, lock);
+
+        total += received;
+        total_timeouts += timeouts;
+    }
+
+    double total_rate = rate_meter_rate(RATE_TOTAL, 0, &bytes_rate);
+
+    fprintf(stdout, "%-13s  %10ld  %9.1f  %9.1f  %9s  %9s  %9s  %8ld\n", "TOTAL", total, total_rate, bytes_rate / 1024.0, "", "", "", total_timeouts);
+
+    long sample = atomic_load(&dashboard.sample);
+
+    if (sample > 0)
+    {
+        pthread_mutex_lock(&dashboard.recent_mutex);
+
+        fprintf(stdout, "\nUltimos mensajes (1 de cada %ld):\n", sample);
+
+        long first = dashboard.recent_count > DASHBOARD_RECENT ? dashboard.recent_count - DASHBOARD_RECENT : 0;
+
+        for (long i = first; i < dashboard.recent_count; i++)
+            fprintf(stdout, "  %s\n", dashboard.recent[i % DASHBOARD_RECENT]);
+
+        pthread_mutex_unlock(&dashboard.recent_mutex);
+    }
+
+    fprintf(stdout, "\033[0m");
+
+    if (!dashboard.tty)
+        fprintf(stdout, "\n");
+
+    fflush(stdout);
+}
+
+/**
+ * @brief Hilo de refresco: redibuja el tablero y actualiza el archivo de estadisticas a periodo fijo.
+ * 
+ * @param arg No se utiliza.
+ * 
+ * @return NULL.
+*/
+static void* dashboard_thread(void* arg)
+{
+    UNUSED(arg);
+
+    struct timespec next = dashboard.start;
+
+    while (!atomic_load(&dashboard.stop))
+    {
+        long period_ms = atomic_load(&dashboard.period_ms);
+
+        next.tv_nsec += period_ms % 1000 * 1000000L;
+        next.tv_sec += period_ms / 1000 + next.tv_nsec / 1000000000L;
+        next.tv_nsec %= 1000000000L;
+
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL) == EINTR) { continue; }
+
+        ProfileSample sample;
+
+        profile_begin(&sample);
+        draw_dashboard();
+        profile_end(PROFILE_TERMINAL, &sample, 0);
+
+        write_stats_file();
+    }
+
+    return NULL;
+}
+
+void dashboard_init(void)
+{
+    sigset_t all, previous;
+
+    atomic_store(&dashboard.period_ms, config_long("IPC_DASHBOARD_MS", DASHBOARD_PERIOD_MS, 0, 3600000));
+    dashboard.tty = isatty(STDOUT_FILENO);
+
+    dashboard_configure();
+
+    clock_gettime(CLOCK_MONOTONIC, &dashboard.start);
+
+    if (atomic_load(&dashboard.period_ms) == 0)
+        return;
+
+    sigfillset(&all);
+    pthread_sigmask(SIG_BLOCK, &all, &previous);
+
+    if (pthread_create(&dashboard.thread, NULL, dashboard_thread, NULL) != 0)
+    {
+        fprintf(stderr, "\033[1;31mNo se pudo iniciar el hilo del tablero\033[0m\n");
+        exit(EXIT_FAILURE);
+    }
+
+    placement_thread(dashboard.thread, THREAD_STATS, "tablero");
+
+    pthread_sigmask(SIG_SETMASK, &previous, NULL);
+}
+
+void dashboard_configure(void)
+{
+    long period_ms = config_long("IPC_DASHBOARD_MS", DASHBOARD_PERIOD_MS, 0, 3600000);
+
+    atomic_store(&dashboard.sample, config_long("IPC_VERBOSE_SAMPLE", 0, 0, 1000000000));
+
+    if (period_ms == atomic_load(&dashboard.period_ms))
+        return;
+
+    if (period_ms == 0 || atomic_load(&dashboard.period_ms) == 0)
+        fprintf(stderr, "\033[1;31mEl tablero solo se habilita o deshabilita al iniciar el servidor\033[0m\n");
+    else
+        atomic_store(&dashboard.period_ms, period_ms);
+}
+
+int dashboard_enabled(void)
+{
+    return atomic_load(&dashboard.period_ms) > 0;
+}
+
+void dashboard_record(ChannelType channel_type, pid_t pid, const char* msg, int timeout)
+{
+    if (channel_type >= CHANNEL_COUNT)
+        return;
+
+    atomic_fetch_add(timeout ? &dashboard.timeouts[channel_type] : &dashboard.received[channel_type], 1);
+
+    long sample = atomic_load(&dashboard.sample);
+
+    if (sample <= 0 || atomic_fetch_add(&dashboard.seen, 1) % sample != 0)
+        return;
+
+    pthread_mutex_lock(&dashboard.recent_mutex);
+
+    char *line = dashboard.recent[dashboard.recent_count++ % DASHBOARD_RECENT];
+
+    if (timeout)
+        snprintf(line, sizeof(dashboard.recent[0]), "Timeout ! -> Cliente %s (%d)", ChannelStringType[channel_type], pid);
+    else
+        snprintf(line, sizeof(dashboard.recent[0]), "Mensaje Recibido ! -> Cliente %s (%d) -> MSG: %.64s", ChannelStringType[channel_type], pid, msg);
+
+    pthread_mutex_unlock(&dashboard.recent_mutex);
+}
+
+void dashboard_latency(ChannelType channel_type, const struct timespec* sent)
+{
+    struct timespec now;
+
+    if (channel_type >= CHANNEL_COUNT)
+        return;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    int64_t us = (int64_t)(now.tv_sec - sent->tv_sec) * 1000000LL + (now.tv_nsec - sent->tv_nsec) / 1000;
+
+    atomic_fetch_add_explicit(&dashboard.latency[channel_type][latency_bucket(us > 0 ? (uint64_t)us : 0)], 1, memory_order_relaxed);
+}
+
+void dashboard_lock_holder(ChannelType channel_type, pid_t pid)
+{
+    if (channel_type < CHANNEL_COUNT)
+        atomic_store(&dashboard.holder[channel_type], pid);
+}
+
+void dashboard_close(void)
+{
+    if (!dashboard_enabled())
+        return;
+
+    atomic_store(&dashboard.stop, 1);
+
+    pthread_join(dashboard.thread, NULL);
+
+    server_lock();
+    snapshot_stats();
+    server_unlock();
+
+    print_stats(stdout);
+
+    write_stats_file();
+
+    atomic_store(&dashboard.period_ms, 0);
+}
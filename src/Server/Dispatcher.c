@@ -0,0 +1,169 @@
+/**
+ * @file Dispatcher.c
+ * @author Bottini, Franco Nicolas.
+ * @brief Implementacion del despachador de eventos del Server IPC.
+ * @version 1.0
+ * @date Marzo de 2023.
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <sys/epoll.h>
+#include "Dispatcher.h"
+
+/**
+ * @struct dispatcher
+ *
+ * Estructura que almacena el estado del despachador de eventos.
+*/
+struct
+{
+    //File descriptor de la instancia de epoll.
+    int epfd;
+
+    //Fuentes registradas.
+    DispatchSource* sources[DISPATCH_SOURCES_MAX];
+
+    //Cantidad de fuentes registradas.
+    int count;
+
+    //Cantidad maxima de eventos que una fuente atiende por turno (1..DISPATCH_BUDGET).
+    int budget;
+
+    //Indice de la fuente por la que comienza la proxima vuelta.
+    int cursor;
+
+    //1 para las fuentes que agotaron su presupuesto en la vuelta anterior y se atienden aunque epoll no las informe.
+    int backlog[DISPATCH_SOURCES_MAX];
+
+    //Cantidad de fuentes con presupuesto agotado en la vuelta anterior.
+    int backlogged;
+
+    //Indica al bucle que debe terminar.
+    atomic_int stop;
+
+    //Vueltas del bucle.
+    long loops;
+
+    //Maxima cantidad de fuentes listas en una misma vuelta.
+    int max_ready;
+} dispatcher = { .epfd = -1 };
+
+void dispatcher_init(void)
+{
+    if ((dispatcher.epfd = epoll_create1(EPOLL_CLOEXEC)) == -1)
+    {
+        fprintf(stderr, "\033[1;31mFallo la creacion del despachador de eventos: %s\033[0m\n", strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+
+    dispatcher_configure();
+}
+
+void dispatcher_configure(void)
+{
+    dispatcher.budget = (int)config_long("IPC_DISPATCH_BUDGET", DISPATCH_BUDGET, 1, DISPATCH_BUDGET);
+}
+
+void dispatcher_register(DispatchSource* source)
+{
+    struct epoll_event event = { .events = EPOLLIN, .data.u32 = (uint32_t)dispatcher.count };
+
+    if (dispatcher.count == DISPATCH_SOURCES_MAX || epoll_ctl(dispatcher.epfd, EPOLL_CTL_ADD, source->fd, &event) == -1)
+    {
+        fprintf(stderr, "\033[1;31mNo se pudo registrar la fuente %s en el despachador: %s\033[0m\n", source->name, strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+
+    dispatcher.sources[dispatcher.count++] = source;
+}
+
+void dispatcher_run(void)
+{
+    struct epoll_event events[DISPATCH_SOURCES_MAX];
+
+    while (!atomic_load(&dispatcher.stop))
+    {
+        int ready = epoll_wait(dispatcher.epfd, events, DISPATCH_SOURCES_MAX, dispatcher.backlogged ? 0 : -1);
+        int pending[DISPATCH_SOURCES_MAX];
+
+        if (ready == -1)
+        {
+            if (errno == EINTR)
+                continue;
+
+            fprintf(stderr, "\033[1;31mFallo la espera del despachador de eventos: %s\033[0m\n", strerror(errno));
+            exit(EXIT_FAILURE);
+        }
+
+        dispatcher.loops++;
+
+        if (ready > dispatcher.max_ready)
+            dispatcher.max_ready = ready;
+
+        memcpy(pending, dispatcher.backlog, sizeof(pending));
+
+        for (int i = 0; i < ready; i++)
+            pending[events[i].data.u32] = 1;
+
+        dispatcher.backlogged = 0;
+
+        for (int i = 0; i < dispatcher.count && !atomic_load(&dispatcher.stop); i++)
+        {
+            int index = (dispatcher.cursor + i) % dispatcher.count;
+            DispatchSource* source = dispatcher.sources[index];
+
+            dispatcher.backlog[index] = 0;
+
+            if (!pending[index])
+                continue;
+
+            int handled = source->drain(source, dispatcher.budget);
+
+            source->turns++;
+            source->handled += handled;
+
+            if (handled >= dispatcher.budget)
+            {
+                source->exhausted++;
+                dispatcher.backlog[index] = 1;
+                dispatcher.backlogged++;
+            }
+        }
+
+        dispatcher.cursor = (dispatcher.cursor + 1) % dispatcher.count;
+    }
+}
+
+void dispatcher_stop(void)
+{
+    atomic_store(&dispatcher.stop, 1);
+}
+
+void print_dispatcher_stats(FILE *fp)
+{
+    if (dispatcher.epfd == -1)
+        return;
+
+    fprintf(fp, "DESPACHADOR    : epoll, %d fuentes, %d eventos por turno, %ld vueltas, hasta %d fuentes listas por vuelta\n", dispatcher.count, dispatcher.budget,
+            dispatcher.loops, dispatcher.max_ready);
+
+    for (int i = 0; i < dispatcher.count; i++)
+    {
+        DispatchSource* source = dispatcher.sources[i];
+
+        fprintf(fp, "  %-13s: %ld eventos en %ld turnos (%.2f por turno), %ld turnos sin presupuesto\n", source->name, source->handled, source->turns,
+                source->turns ? (double)source->handled / (double)source->turns : 0.0, source->exhausted);
+    }
+}
+
+void dispatcher_close(void)
+{
+    if (dispatcher.epfd == -1)
+        return;
+
+    close(dispatcher.epfd);
+
+    dispatcher.epfd = -1;
+}
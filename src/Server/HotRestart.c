@@ -0,0 +1,226 @@
+/**
+ * @file HotRestart.c
+ * @author Bottini, Franco Nicolas.
+ * @brief Implementacion del reinicio en caliente del Server IPC.
+ * @version 1.0
+ * @date Marzo de 2023.
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include "HotRestart.h"
+
+//Numero magico de la region de estado.
+#define RESTART_MAGIC 0x48435049U
+
+/**
+ * Region de memoria compartida que sobrevive al servidor: identifica al duenio de los recursos IPC y transporta el
+ * estado que el servidor saliente entrega al entrante.
+*/
+typedef struct RestartRegion
+{
+    //Numero magico (RESTART_MAGIC).
+    uint32_t magic;
+
+    //Cantidad de reinicios en caliente.
+    int generation;
+
+    //ID del proceso del servidor duenio de los recursos IPC.
+    atomic_int owner;
+
+    //ID del proceso del servidor que pidio la entrega (0 si no hay una entrega pendiente).
+    atomic_int successor;
+
+    //1 cuando el servidor saliente completo la entrega.
+    atomic_int ready;
+
+    //Posicion y tamaño de cada seccion dentro de 'data' (tamaño 0 si la seccion no se guardo).
+    struct { size_t offset; size_t size; } sections[RESTART_SECTIONS];
+
+    //Bytes utilizados de 'data'.
+    size_t used;
+
+    //Datos de las secciones.
+    unsigned char data[RESTART_DATA_SIZE];
+} RestartRegion;
+
+/**
+ * @struct restart
+ *
+ * Estructura que almacena el estado del reinicio en caliente del proceso.
+*/
+struct
+{
+    //Identificador del segmento de la region de estado.
+    int shmid;
+
+    //Region de estado.
+    RestartRegion *region;
+
+    //1 si el servidor adopto los recursos de un servidor anterior.
+    int adopting;
+
+    //1 si el servidor esta entregando sus recursos a un sucesor.
+    int handing_off;
+} restart;
+
+void hot_restart_init(void)
+{
+    const char* enabled = getenv("IPC_HOT_RESTART");
+    key_t key = ftok("data", 'H');
+
+    restart.adopting = enabled && strcmp(enabled, "1") == 0;
+
+    if (!restart.adopting && access(config_pid_file(), F_OK) != -1)
+    {
+        fprintf(stderr, "\033[1;31mYa existe un servidor en ejecucion ! (IPC_HOT_RESTART=1 para reemplazarlo)\033[0m\n");
+        exit(EXIT_FAILURE);
+    }
+
+    if ((restart.shmid = shmget(key, sizeof(RestartRegion), restart.adopting ? 0600 : IPC_CREAT | 0600)) == -1 ||
+        (restart.region = shmat(restart.shmid, NULL, 0)) == (RestartRegion *) -1)
+    {
+        if (restart.adopting)
+            fprintf(stderr, "\033[1;31mNo hay un servidor en ejecucion para el reinicio en caliente !\033[0m\n");
+        else
+            fprintf(stderr, "\033[1;31mFallo la creacion de la region de estado: %s\033[0m\n", strerror(errno));
+
+        exit(EXIT_FAILURE);
+    }
+
+    if (!restart.adopting)
+    {
+        memset(restart.region, 0, sizeof(RestartRegion));
+
+        restart.region->magic = RESTART_MAGIC;
+        atomic_store(&restart.region->owner, getpid());
+
+        return;
+    }
+
+    pid_t owner = atomic_load(&restart.region->owner);
+
+    if (restart.region->magic != RESTART_MAGIC || owner <= 0 || kill(owner, 0) == -1)
+    {
+        fprintf(stderr, "\033[1;31mNo hay un servidor en ejecucion para el reinicio en caliente !\033[0m\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+void hot_restart_handoff(void)
+{
+    struct timespec poll_time = {0, 1000000};
+    pid_t owner;
+
+    if (!restart.adopting)
+        return;
+
+    owner = atomic_load(&restart.region->owner);
+
+    atomic_store(&restart.region->ready, 0);
+    atomic_store(&restart.region->successor, getpid());
+
+    if (kill(owner, SIGNAL_HANDOFF) == -1)
+    {
+        fprintf(stderr, "\033[1;31mNo se pudo pedir la entrega al servidor %d: %s\033[0m\n", owner, strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+
+    for (int waited = 0; !atomic_load(&restart.region->ready); waited++)
+    {
+        if (waited >= RESTART_TIMEOUT_MS || (kill(owner, 0) == -1 && !atomic_load(&restart.region->ready)))
+        {
+            fprintf(stderr, "\033[1;31mEl servidor %d no completo la entrega de los recursos !\033[0m\n", owner);
+            exit(EXIT_FAILURE);
+        }
+
+        nanosleep(&poll_time, NULL);
+    }
+
+    restart.region->generation++;
+
+    atomic_store(&restart.region->owner, getpid());
+    atomic_store(&restart.region->successor, 0);
+
+    fprintf(stdout, "\033[1;34mReinicio en caliente: recursos recibidos del servidor %d (generacion %d)\033[0m\n", owner, restart.region->generation);
+}
+
+int hot_restart_adopting(void)
+{
+    return restart.adopting;
+}
+
+int hot_restart_request(pid_t sender)
+{
+    if (!restart.region || restart.handing_off || sender <= 0 || sender != atomic_load(&restart.region->successor))
+        return 0;
+
+    restart.handing_off = 1;
+
+    memset(restart.region->sections, 0, sizeof(restart.region->sections));
+    restart.region->used = 0;
+
+    return 1;
+}
+
+int hot_restart_handing_off(void)
+{
+    return restart.handing_off;
+}
+
+void restart_save(RestartSection section, const void* data, size_t size)
+{
+    RestartRegion *region = restart.region;
+
+    if (!region || !restart.handing_off)
+        return;
+
+    if (region->used + size > RESTART_DATA_SIZE)
+    {
+        fprintf(stderr, "\033[1;31mLa seccion %d no entra en la region de estado y no se traspasa\033[0m\n", (int)section);
+        return;
+    }
+
+    memcpy(region->data + region->used, data, size);
+
+    region->sections[section].offset = region->used;
+    region->sections[section].size = size;
+    region->used += size;
+}
+
+size_t restart_load(RestartSection section, void* data, size_t capacity)
+{
+    RestartRegion *region = restart.region;
+
+    if (!region || !restart.adopting)
+        return 0;
+
+    size_t size = region->sections[section].size;
+
+    if (size == 0 || size > capacity)
+        return 0;
+
+    memcpy(data, region->data + region->sections[section].offset, size);
+
+    return size;
+}
+
+void hot_restart_close(void)
+{
+    if (!restart.region)
+        return;
+
+    if (restart.handing_off)
+    {
+        atomic_store(&restart.region->ready, 1);
+        shmdt(restart.region);
+    }
+    else
+    {
+        shmdt(restart.region);
+        shmctl(restart.shmid, IPC_RMID, NULL);
+    }
+
+    restart.region = NULL;
+}
@@ -0,0 +1,533 @@
+/**
+ * @file Journal.c
+ * @author Bottini, Franco Nicolas.
+ * @brief Implementacion del journal de mensajes del Server IPC.
+ * @version 1.0
+ * @date Marzo de 2023.
+ * 
+ * @copyright Copyright (c) 2023
+ * 
+ */
+
+#include <dirent.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include "Journal.h"
+#include "Placement.h"
+
+/**
+ * Segmento completo que espera ser sincronizado, recortado y cerrado por el hilo de sincronizacion.
+*/
+typedef struct JournalSegment
+{
+    //Puntero al segmento mapeado en memoria (NULL si no hay segmento).
+    char *base;
+
+    //File descriptor del segmento.
+    int fd;
+
+    //Bytes utilizados del segmento.
+    size_t offset;
+} JournalSegment;
+
+/**
+ * @struct journal
+ * 
+ * Estructura que almacena el estado del journal: segmento mapeado actual, indice, politica de sincronizacion y el hilo que
+ * sincroniza a disco fuera del camino de recepcion.
+*/
+struct
+{
+    //Indica si el journal esta habilitado.
+    int enabled;
+
+    //Directorio donde se guardan los segmentos y el indice.
+    char dir[256];
+
+    //File descriptor del segmento actual.
+    int fd;
+
+    //Puntero al segmento actual mapeado en memoria.
+    char *base;
+
+    //Numero del segmento actual.
+    uint32_t segment;
+
+    //Desplazamiento del proximo registro dentro del segmento actual.
+    size_t offset;
+
+    //Desplazamiento hasta el cual el segmento actual esta sincronizado a disco.
+    size_t synced;
+
+    //File descriptor del indice.
+    int index_fd;
+
+    //Numero de secuencia del proximo registro, continua entre segmentos y entre ejecuciones.
+    uint64_t seq;
+
+    //Registros agregados desde la ultima sincronizacion.
+    long pending;
+
+    //Cantidad de registros que dispara una sincronizacion.
+    long sync_msgs;
+
+    //Tiempo (en milisegundos) que dispara una sincronizacion.
+    long sync_ms;
+
+    //Instante de la ultima sincronizacion.
+    struct timespec last_sync;
+
+    //Cantidad de sincronizaciones realizadas.
+    long syncs;
+
+    //Cantidad de bytes escritos en los segmentos.
+    long bytes;
+
+    //Segmento completo pendiente de cierre (base NULL si no hay ninguno).
+    JournalSegment retired;
+
+    //Segmento que el hilo de sincronizacion esta escribiendo a disco sin el mutex (NULL si ninguno).
+    char *busy;
+
+    //Hilo de sincronizacion.
+    pthread_t flusher;
+
+    //Despierta al hilo de sincronizacion (CLOCK_MONOTONIC).
+    pthread_cond_t wake;
+
+    //Se señala cada vez que el hilo de sincronizacion termina de escribir un segmento.
+    pthread_cond_t done;
+
+    //Indica al hilo de sincronizacion que debe terminar.
+    int stop;
+
+    //Mutex que protege el estado del journal. Nunca se retiene durante una escritura a disco.
+    pthread_mutex_t mutex;
+} journal = { .fd = -1, .index_fd = -1, .mutex = PTHREAD_MUTEX_INITIALIZER, .done = PTHREAD_COND_INITIALIZER };
+
+/**
+ * @brief Obtiene una marca de tiempo en nanosegundos a partir de un timespec.
+ * 
+ * @param ts Instante a convertir.
+ * 
+ * @return Instante en nanosegundos.
+*/
+static int64_t timespec_to_ns(const struct timespec* ts)
+{
+    return (int64_t)ts->tv_sec * 1000000000LL + (int64_t)ts->tv_nsec;
+}
+
+/**
+ * @brief Sincroniza, desmapea y recorta al tamaño utilizado un segmento del journal.
+ * 
+ * Escribe a disco, por lo que no se debe invocar con el mutex del journal tomado salvo al cerrar el journal.
+ * 
+ * @param segment Segmento a cerrar.
+ * 
+ * @return No devuelve ningun valor.
+*/
+static void journal_finish_segment(const JournalSegment* segment)
+{
+    if (segment->offset)
+        msync(segment->base, segment->offset, MS_SYNC);
+
+    munmap(segment->base, JOURNAL_SEGMENT_SIZE);
+
+    ftruncate(segment->fd, (off_t)segment->offset);
+    fdatasync(segment->fd);
+    close(segment->fd);
+}
+
+/**
+ * @brief Cierra el segmento retirado y sincroniza la porcion escrita del segmento actual.
+ * 
+ * Se invoca desde el hilo de sincronizacion con el mutex tomado; lo libera mientras escribe a disco, por lo que la
+ * recepcion sigue agregando registros durante la sincronizacion.
+ * 
+ * @return No devuelve ningun valor.
+*/
+static void journal_commit(void)
+{
+    if (journal.retired.base)
+    {
+        JournalSegment retired = journal.retired;
+
+        journal.retired.base = NULL;
+        journal.busy = retired.base;
+
+        pthread_mutex_unlock(&journal.mutex);
+        journal_finish_segment(&retired);
+        pthread_mutex_lock(&journal.mutex);
+
+        journal.busy = NULL;
+        journal.syncs++;
+
+        pthread_cond_broadcast(&journal.done);
+    }
+
+    if (journal.base && journal.offset > journal.synced)
+    {
+        char *base = journal.base;
+        uint32_t segment = journal.segment;
+        size_t start = journal.synced & ~((size_t)sysconf(_SC_PAGESIZE) - 1), end = journal.offset;
+
+        journal.pending = 0;
+        journal.busy = base;
+
+        pthread_mutex_unlock(&journal.mutex);
+        msync(base + start, end - start, MS_SYNC);
+        pthread_mutex_lock(&journal.mutex);
+
+        journal.busy = NULL;
+        journal.syncs++;
+
+        if (journal.segment == segment)
+            journal.synced = end;
+
+        pthread_cond_broadcast(&journal.done);
+    }
+
+    journal.pending = 0;
+
+    clock_gettime(CLOCK_MONOTONIC, &journal.last_sync);
+}
+
+/**
+ * @brief Hilo de sincronizacion: agrupa los registros pendientes y los escribe a disco cada IPC_JOURNAL_SYNC_MSGS registros
+ * o IPC_JOURNAL_SYNC_MS milisegundos, y cierra los segmentos completos.
+ * 
+ * @param arg No se utiliza.
+ * 
+ * @return NULL.
+*/
+static void* journal_flusher(void* arg)
+{
+    UNUSED(arg);
+
+    pthread_mutex_lock(&journal.mutex);
+
+    while (!journal.stop)
+    {
+        struct timespec deadline = journal.last_sync;
+
+        deadline.tv_nsec += journal.sync_ms % 1000 * 1000000L;
+        deadline.tv_sec += journal.sync_ms / 1000 + deadline.tv_nsec / 1000000000L;
+        deadline.tv_nsec %= 1000000000L;
+
+        if (!journal.retired.base && journal.pending < journal.sync_msgs && pthread_cond_timedwait(&journal.wake, &journal.mutex, &deadline) != ETIMEDOUT)
+            continue;
+
+        journal_commit();
+    }
+
+    pthread_mutex_unlock(&journal.mutex);
+
+    return NULL;
+}
+
+/**
+ * @brief Crea, preasigna y mapea en memoria un nuevo segmento del journal.
+ * 
+ * @param segment Numero del segmento a crear.
+ * 
+ * @return No devuelve ningun valor.
+*/
+static void journal_open_segment(uint32_t segment)
+{
+    char path[300];
+
+    snprintf(path, sizeof(path), "%s/segment_%06u.log", journal.dir, segment);
+
+    if ((journal.fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644)) == -1)
+    {
+        fprintf(stderr, "\033[1;31mNo se pudo crear el segmento del journal %s: %s\033[0m\n", path, strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+
+    if (posix_fallocate(journal.fd, 0, JOURNAL_SEGMENT_SIZE) != 0 && ftruncate(journal.fd, JOURNAL_SEGMENT_SIZE) == -1)
+    {
+        fprintf(stderr, "\033[1;31mNo se pudo preasignar el segmento del journal %s: %s\033[0m\n", path, strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+
+    if ((journal.base = mmap(NULL, JOURNAL_SEGMENT_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, journal.fd, 0)) == MAP_FAILED)
+    {
+        fprintf(stderr, "\033[1;31mNo se pudo mapear el segmento del journal %s: %s\033[0m\n", path, strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+
+    journal.segment = segment;
+    journal.offset = 0;
+    journal.synced = 0;
+}
+
+/**
+ * @brief Retira el segmento actual, que ya no admite el proximo registro, y abre el siguiente.
+ * 
+ * El segmento retirado lo cierra el hilo de sincronizacion. Solo si todavia no cerro el anterior (dos segmentos completos
+ * en un mismo periodo de sincronizacion) se cierra aqui, esperando si el hilo lo esta escribiendo. Se debe invocar con el
+ * mutex del journal tomado.
+ * 
+ * @return No devuelve ningun valor.
+*/
+static void journal_rotate(void)
+{
+    if (journal.retired.base)
+    {
+        JournalSegment retired = journal.retired;
+
+        journal.retired.base = NULL;
+
+        while (journal.busy == retired.base)
+            pthread_cond_wait(&journal.done, &journal.mutex);
+
+        journal_finish_segment(&retired);
+    }
+
+    journal.retired = (JournalSegment) { journal.base, journal.fd, journal.offset };
+    journal.base = NULL;
+    journal.fd = -1;
+
+    journal_open_segment(journal.segment + 1);
+
+    pthread_cond_signal(&journal.wake);
+}
+
+/**
+ * @brief Obtiene el numero del proximo segmento a crear a partir de los segmentos existentes en el directorio del journal.
+ * 
+ * @return Numero del proximo segmento.
+*/
+static uint32_t journal_next_segment(void)
+{
+    uint32_t next = 0, number;
+    struct dirent *entry;
+    DIR *dp = opendir(journal.dir);
+
+    if (!dp)
+        return 0;
+
+    while ((entry = readdir(dp)) != NULL)
+        if (sscanf(entry->d_name, "segment_%u.log", &number) == 1 && number >= next)
+            next = number + 1;
+
+    closedir(dp);
+
+    return next;
+}
+
+/**
+ * @brief Obtiene el numero de secuencia que sigue al ultimo registro del journal existente en el directorio.
+ * 
+ * Parte de la ultima entrada del indice y recorre su segmento hasta el ultimo registro valido.
+ * 
+ * @return Numero de secuencia del proximo registro (0 si el journal esta vacio).
+*/
+static uint64_t journal_next_seq(void)
+{
+    JournalIndexEntry entry;
+    JournalRecord record;
+    struct stat info;
+    char path[300];
+    uint64_t next = 0;
+
+    snprintf(path, sizeof(path), "%s/index", journal.dir);
+
+    int fd = open(path, O_RDONLY);
+
+    if (fd == -1)
+        return 0;
+
+    if (fstat(fd, &info) == -1 || info.st_size < (off_t)sizeof(entry) ||
+        pread(fd, &entry, sizeof(entry), info.st_size - info.st_size % (off_t)sizeof(entry) - (off_t)sizeof(entry)) != sizeof(entry))
+    {
+        close(fd);
+        return 0;
+    }
+
+    close(fd);
+
+    next = entry.seq;
+
+    snprintf(path, sizeof(path), "%s/segment_%06u.log", journal.dir, entry.segment);
+
+    if ((fd = open(path, O_RDONLY)) == -1)
+        return next;
+
+    for (off_t offset = entry.offset; pread(fd, &record, sizeof(record), offset) == sizeof(record) && record.magic == JOURNAL_MAGIC;
+         offset += (off_t)(sizeof(record) + ((record.length + 7) & ~7U)))
+        next = record.seq + 1;
+
+    close(fd);
+
+    return next;
+}
+
+void journal_init(void)
+{
+    const char* dir = config_get("IPC_JOURNAL_DIR");
+    char path[300];
+
+    if (!dir || !*dir)
+        return;
+
+    snprintf(journal.dir, sizeof(journal.dir), "%s", dir);
+
+    if (mkdir(journal.dir, S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH) == -1 && errno != EEXIST)
+    {
+        fprintf(stderr, "\033[1;31mNo se pudo crear el directorio del journal %s: %s\033[0m\n", journal.dir, strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+
+    snprintf(path, sizeof(path), "%s/index", journal.dir);
+
+    if ((journal.index_fd = open(path, O_WRONLY | O_CREAT | O_APPEND, 0644)) == -1)
+    {
+        fprintf(stderr, "\033[1;31mNo se pudo abrir el indice del journal %s: %s\033[0m\n", path, strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+
+    journal.seq = journal_next_seq();
+
+    journal_open_segment(journal_next_segment());
+
+    pthread_condattr_t attr;
+    sigset_t all, previous;
+
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&journal.wake, &attr);
+    pthread_condattr_destroy(&attr);
+
+    clock_gettime(CLOCK_MONOTONIC, &journal.last_sync);
+
+    journal.enabled = 1;
+
+    journal_configure();
+
+    sigfillset(&all);
+    pthread_sigmask(SIG_BLOCK, &all, &previous);
+
+    if (pthread_create(&journal.flusher, NULL, journal_flusher, NULL) != 0)
+    {
+        fprintf(stderr, "\033[1;31mNo se pudo iniciar el hilo de sincronizacion del journal\033[0m\n");
+        exit(EXIT_FAILURE);
+    }
+
+    placement_thread(journal.flusher, THREAD_LOG, "journal");
+
+    pthread_sigmask(SIG_SETMASK, &previous, NULL);
+}
+
+void journal_configure(void)
+{
+    pthread_mutex_lock(&journal.mutex);
+
+    journal.sync_msgs = config_long("IPC_JOURNAL_SYNC_MSGS", JOURNAL_SYNC_MSGS, 1, 1000000);
+    journal.sync_ms = config_long("IPC_JOURNAL_SYNC_MS", JOURNAL_SYNC_MS, 1, 60000);
+
+    if (journal.enabled)
+        pthread_cond_signal(&journal.wake);
+
+    pthread_mutex_unlock(&journal.mutex);
+}
+
+void journal_append(ChannelType channel_type, const MsgHeader* header, const char* msg, size_t len)
+{
+    struct timespec now;
+
+    if (!journal.enabled)
+        return;
+
+    if (len > UINT32_MAX)
+        len = UINT32_MAX;
+
+    size_t record_size = sizeof(JournalRecord) + ((len + 7) & ~(size_t)7);
+
+    if (record_size > JOURNAL_SEGMENT_SIZE)
+        return;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    pthread_mutex_lock(&journal.mutex);
+
+    if (journal.offset + record_size > JOURNAL_SEGMENT_SIZE)
+        journal_rotate();
+
+    JournalRecord *record = (JournalRecord *)(journal.base + journal.offset);
+
+    if (journal.offset == 0 || journal.seq % JOURNAL_INDEX_STRIDE == 0)
+    {
+        JournalIndexEntry entry = { journal.segment, (uint32_t)journal.offset, journal.seq, timespec_to_ns(&now) };
+
+        write(journal.index_fd, &entry, sizeof(entry));
+    }
+
+    memcpy(record + 1, msg, len);
+
+    record->length = (uint32_t)len;
+    record->seq = journal.seq++;
+    record->sent_ns = timespec_to_ns(&header->timestamp);
+    record->recv_ns = timespec_to_ns(&now);
+    record->pid = header->pid;
+    record->channel = (uint16_t)channel_type;
+    record->reserved = 0;
+    record->vid = header->vid;
+    record->client_seq = header->seq;
+    record->magic = JOURNAL_MAGIC;
+
+    journal.offset += record_size;
+    journal.bytes += (long)record_size;
+
+    if (++journal.pending == journal.sync_msgs)
+        pthread_cond_signal(&journal.wake);
+
+    pthread_mutex_unlock(&journal.mutex);
+}
+
+void print_journal_stats(FILE *fp)
+{
+    if (!journal.enabled)
+        return;
+
+    pthread_mutex_lock(&journal.mutex);
+
+    fprintf(fp, "JOURNAL        : %lu registros, %ld bytes, %ld syncs (segmento %u)\n", (unsigned long)journal.seq, journal.bytes, journal.syncs, journal.segment);
+
+    pthread_mutex_unlock(&journal.mutex);
+}
+
+void journal_close(void)
+{
+    if (!journal.enabled)
+        return;
+
+    pthread_mutex_lock(&journal.mutex);
+
+    journal.stop = 1;
+    pthread_cond_signal(&journal.wake);
+
+    pthread_mutex_unlock(&journal.mutex);
+
+    pthread_join(journal.flusher, NULL);
+
+    pthread_mutex_lock(&journal.mutex);
+
+    if (journal.retired.base)
+        journal_finish_segment(&journal.retired);
+
+    journal_finish_segment(&(JournalSegment) { journal.base, journal.fd, journal.offset });
+
+    journal.retired.base = NULL;
+    journal.base = NULL;
+    journal.fd = -1;
+
+    pthread_cond_destroy(&journal.wake);
+
+    fdatasync(journal.index_fd);
+    close(journal.index_fd);
+
+    journal.enabled = 0;
+
+    pthread_mutex_unlock(&journal.mutex);
+}
@@ -0,0 +1,374 @@
+/**
+ * @file MappedFile.c
+ * @author Bottini, Franco Nicolas.
+ * @brief Implementacion del canal de archivo mapeado en memoria del Server IPC.
+ * @version 1.0
+ * @date Marzo de 2023.
+ * 
+ * @copyright Copyright (c) 2023
+ * 
+ */
+
+#include <sys/mman.h>
+#include "MappedFile.h"
+#include "ServerUtils.h"
+#include "Pipeline.h"
+#include "HotRestart.h"
+#include "Placement.h"
+#include "Slab.h"
+
+//Reintentos de lectura de una entrada cuyo seqlock cambio durante la copia.
+#define MAPPED_READ_RETRIES 4
+
+/**
+ * Copia consistente de un valor leido del archivo mapeado.
+*/
+typedef struct MappedCopy
+{
+    //Cabecera del valor.
+    MsgHeader header;
+
+    //Longitud del valor.
+    uint32_t len;
+
+    //Valor, terminado en nulo.
+    char value[MAPPED_VALUE_MAX];
+} MappedCopy;
+
+/**
+ * @struct mapped
+ * 
+ * Estructura que almacena el estado del canal de archivo mapeado.
+*/
+struct
+{
+    //Path del archivo mapeado.
+    char path[256];
+
+    //Contenido del archivo mapeado (NULL si no se creo).
+    MappedFile *file;
+
+    //Modo de consumo.
+    MappedMode mode;
+
+    //Periodo de muestreo en milisegundos.
+    atomic_long sample_ms;
+
+    //Hilo de muestreo.
+    pthread_t thread;
+
+    //Indica al hilo de muestreo que debe terminar.
+    atomic_int stop;
+
+    //Ultimo valor del seqlock entregado de cada entrada.
+    unsigned int delivered_sequence[MAPPED_SLOTS];
+
+    //Proxima posicion a leer de la region de anexado.
+    unsigned long long append_tail;
+
+    //Copias del lote en construccion.
+    MappedCopy copies[PIPELINE_BATCH_MAX];
+
+    //Lote en construccion.
+    MsgBatch batch;
+
+    //Clientes con una entrada en la tabla en el ultimo muestreo.
+    atomic_long producers;
+
+    //Valores entregados al pipeline.
+    atomic_long delivered;
+
+    //Actualizaciones reemplazadas por una posterior antes de ser muestreadas (modo latest).
+    atomic_long superseded;
+
+    //Actualizaciones sobreescritas en la region de anexado antes de ser leidas (modo append).
+    atomic_long overrun;
+
+    //Lecturas descartadas por no obtener una copia consistente.
+    atomic_long torn;
+
+    //Entradas liberadas por pertenecer a clientes que ya no existen.
+    atomic_long reaped;
+
+    //Actualizaciones publicadas al cerrar el archivo, para el reporte final.
+    unsigned long long updates;
+} mapped;
+
+/**
+ * @brief Entrega al pipeline el lote en construccion.
+ * 
+ * @return No devuelve ningun valor.
+*/
+static void flush_batch(void)
+{
+    if (mapped.batch.count == 0)
+        return;
+
+    server_lock();
+    pipeline_run(&mapped.batch);
+    server_unlock();
+
+    atomic_fetch_add(&mapped.delivered, mapped.batch.count);
+
+    mapped.batch.count = 0;
+}
+
+/**
+ * @brief Agrega al lote en construccion la copia de la posicion siguiente y, si el lote se completa, lo entrega al pipeline.
+ * 
+ * @return No devuelve ningun valor.
+*/
+static void push_copy(void)
+{
+    MappedCopy *copy = &mapped.copies[mapped.batch.count];
+
+    copy->value[copy->len] = '\0';
+
+    mapped.batch.views[mapped.batch.count++] = (MsgView)
+    {
+        .channel = MAPPED_FILE,
+        .header = &copy->header,
+        .msg = copy->value,
+        .len = copy->len,
+        .sampled = mapped.mode == MAPPED_LATEST
+    };
+
+    if (mapped.batch.count >= pipeline_batch_limit())
+        flush_batch();
+}
+
+/**
+ * @brief Muestrea la tabla de ultimos valores y entrega los valores que cambiaron desde el muestreo anterior.
+ * 
+ * @param reap 1 si se deben liberar las entradas de clientes que ya no existen.
+ * 
+ * @return No devuelve ningun valor.
+*/
+static void sample_latest(int reap)
+{
+    long producers = 0;
+
+    for (int i = 0; i < MAPPED_SLOTS; i++)
+    {
+        MappedSlot *slot = &mapped.file->slots[i];
+        unsigned long long owner = atomic_load_explicit(&slot->owner, memory_order_acquire);
+
+        if (!owner)
+            continue;
+
+        producers++;
+
+        for (int attempt = 0; attempt < MAPPED_READ_RETRIES; attempt++)
+        {
+            unsigned int before = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+
+            if (before & 1)
+                continue;
+
+            if (before == mapped.delivered_sequence[i])
+            {
+                if (reap && kill((pid_t)(owner >> 32), 0) == -1 && errno == ESRCH)
+                {
+                    atomic_store(&slot->owner, 0);
+                    atomic_fetch_add(&mapped.reaped, 1);
+                }
+
+                break;
+            }
+
+            MappedCopy *copy = &mapped.copies[mapped.batch.count];
+
+            copy->header = slot->header;
+            copy->len = slot->len < MAPPED_VALUE_MAX ? slot->len : MAPPED_VALUE_MAX - 1;
+            memcpy(copy->value, slot->value, copy->len);
+
+            atomic_thread_fence(memory_order_acquire);
+
+            if (atomic_load_explicit(&slot->sequence, memory_order_relaxed) != before)
+            {
+                if (attempt == MAPPED_READ_RETRIES - 1)
+                    atomic_fetch_add(&mapped.torn, 1);
+
+                continue;
+            }
+
+            atomic_fetch_add(&mapped.superseded, (before - mapped.delivered_sequence[i]) / 2 - 1);
+
+            mapped.delivered_sequence[i] = before;
+
+            push_copy();
+
+            break;
+        }
+    }
+
+    atomic_store(&mapped.producers, producers);
+}
+
+/**
+ * @brief Consume las actualizaciones publicadas en la region de anexado desde el muestreo anterior.
+ * 
+ * @return No devuelve ningun valor.
+*/
+static void drain_append(void)
+{
+    unsigned long long head = atomic_load_explicit(&mapped.file->append_head, memory_order_acquire);
+
+    if (head - mapped.append_tail > MAPPED_APPEND_RECORDS)
+    {
+        atomic_fetch_add(&mapped.overrun, (long)(head - mapped.append_tail - MAPPED_APPEND_RECORDS));
+        mapped.append_tail = head - MAPPED_APPEND_RECORDS;
+    }
+
+    while (mapped.append_tail < head)
+    {
+        MappedRecord *record = &mapped.file->records[mapped.append_tail & (MAPPED_APPEND_RECORDS - 1)];
+        unsigned long long expected = 2 * mapped.append_tail + 2;
+        unsigned long long before = atomic_load_explicit(&record->sequence, memory_order_acquire);
+
+        if (before < expected)
+            break;
+
+        if (before == expected)
+        {
+            MappedCopy *copy = &mapped.copies[mapped.batch.count];
+
+            copy->header = record->header;
+            copy->len = record->len < MAPPED_VALUE_MAX ? record->len : MAPPED_VALUE_MAX - 1;
+            memcpy(copy->value, record->value, copy->len);
+
+            atomic_thread_fence(memory_order_acquire);
+
+            if (atomic_load_explicit(&record->sequence, memory_order_relaxed) == before)
+                push_copy();
+            else
+                atomic_fetch_add(&mapped.overrun, 1);
+        }
+        else
+            atomic_fetch_add(&mapped.overrun, 1);
+
+        mapped.append_tail++;
+    }
+}
+
+/**
+ * @brief Hilo de muestreo del archivo mapeado.
+ * 
+ * @param arg No se utiliza.
+ * 
+ * @return NULL.
+*/
+static void* mapped_sampler(void* arg)
+{
+    UNUSED(arg);
+
+    struct timespec next;
+    long samples = 0;
+
+    clock_gettime(CLOCK_MONOTONIC, &next);
+
+    while (!atomic_load(&mapped.stop))
+    {
+        long sample_ms = atomic_load(&mapped.sample_ms);
+
+        next.tv_nsec += sample_ms % 1000 * 1000000L;
+        next.tv_sec += sample_ms / 1000 + next.tv_nsec / 1000000000L;
+        next.tv_nsec %= 1000000000L;
+
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL) == EINTR) { continue; }
+
+        if (mapped.mode == MAPPED_LATEST)
+            sample_latest(++samples % MAPPED_REAP_SAMPLES == 0);
+        else
+            drain_append();
+
+        flush_batch();
+    }
+
+    slab_thread_flush();
+
+    return NULL;
+}
+
+void mapped_file_init(void)
+{
+    const char* path = config_get("IPC_MAPPED_FILE");
+    const char* mode = config_get("IPC_MAPPED_MODE");
+    sigset_t all, previous;
+    int fd;
+
+    snprintf(mapped.path, sizeof(mapped.path), "%s", path && *path ? path : MAPPED_FILE_NAME);
+
+    mapped.mode = mode && strcmp(mode, "append") == 0 ? MAPPED_APPEND : MAPPED_LATEST;
+
+    mapped_file_configure();
+
+    if ((fd = open(mapped.path, O_RDWR | O_CREAT | (hot_restart_adopting() ? 0 : O_TRUNC), 0666)) == -1 || ftruncate(fd, sizeof(MappedFile)) == -1)
+    {
+        fprintf(stderr, "\033[1;31mFallo la creacion del archivo mapeado %s: %s\033[0m\n", mapped.path, strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+
+    mapped.file = mmap(NULL, sizeof(MappedFile), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+    close(fd);
+
+    if (mapped.file == MAP_FAILED)
+    {
+        fprintf(stderr, "\033[1;31mNo se pudo mapear el archivo %s: %s\033[0m\n", mapped.path, strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+
+    if (hot_restart_adopting() && !restart_load(RESTART_MAPPED_TAIL, &mapped.append_tail, sizeof(mapped.append_tail)))
+        mapped.append_tail = atomic_load(&mapped.file->append_head);
+
+    sigfillset(&all);
+    pthread_sigmask(SIG_BLOCK, &all, &previous);
+
+    if (pthread_create(&mapped.thread, NULL, mapped_sampler, NULL) != 0)
+    {
+        fprintf(stderr, "\033[1;31mNo se pudo iniciar el muestreo del archivo mapeado\033[0m\n");
+        exit(EXIT_FAILURE);
+    }
+
+    placement_thread(mapped.thread, THREAD_RECEIVE, "muestreo MAP");
+
+    pthread_sigmask(SIG_SETMASK, &previous, NULL);
+}
+
+void mapped_file_configure(void)
+{
+    atomic_store(&mapped.sample_ms, config_long("IPC_MAPPED_SAMPLE_MS", MAPPED_SAMPLE_MS, 1, 60000));
+}
+
+void print_mapped_stats(FILE *fp)
+{
+    if (!mapped.path[0])
+        return;
+
+    fprintf(fp, "MAPPED FILE    : modo %s cada %ld ms, %llu actualizaciones, %ld entregadas\n", mapped.mode == MAPPED_LATEST ? "latest" : "append",
+            mapped.sample_ms, mapped.file ? atomic_load(&mapped.file->append_head) : mapped.updates, atomic_load(&mapped.delivered));
+    fprintf(fp, "  %-13s: %ld productores, %ld reemplazadas, %ld sobreescritas, %ld inconsistentes, %ld liberadas\n", "tabla",
+            atomic_load(&mapped.producers), atomic_load(&mapped.superseded), atomic_load(&mapped.overrun), atomic_load(&mapped.torn), atomic_load(&mapped.reaped));
+}
+
+void mapped_file_close(void)
+{
+    if (!mapped.file)
+        return;
+
+    atomic_store(&mapped.stop, 1);
+
+    pthread_join(mapped.thread, NULL);
+
+    mapped.updates = atomic_load(&mapped.file->append_head);
+
+    restart_save(RESTART_MAPPED_TAIL, &mapped.append_tail, sizeof(mapped.append_tail));
+
+    munmap(mapped.file, sizeof(MappedFile));
+
+    if (!hot_restart_handing_off())
+        unlink(mapped.path);
+
+    mapped.file = NULL;
+}
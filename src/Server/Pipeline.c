@@ -0,0 +1,758 @@
+/**
+ * @file Pipeline.c
+ * @author Bottini, Franco Nicolas.
+ * @brief Implementacion del pipeline de procesamiento de mensajes del Server IPC.
+ * @version 1.0
+ * @date Marzo de 2023.
+ * 
+ * @copyright Copyright (c) 2023
+ * 
+ */
+
+#include "Pipeline.h"
+#include "ServerUtils.h"
+#include "SeqTracker.h"
+#include "Aggregator.h"
+#include "Journal.h"
+#include "Recorder.h"
+#include "Dashboard.h"
+#include "Profiler.h"
+#include "Tracer.h"
+#include "Placement.h"
+#include "Slab.h"
+
+/**
+ * Copia de un mensaje encolado para una etapa asincronica.
+*/
+typedef struct PipelineSlot
+{
+    //Vista del mensaje, sus punteros se redirigen a la copia al procesarla.
+    MsgView view;
+
+    //Copia de la cabecera del mensaje.
+    MsgHeader header;
+
+    //Copia del contenido del mensaje, en un buffer del slab del tamaño del mensaje.
+    char *msg;
+} PipelineSlot;
+
+/**
+ * Etapa registrada, disponible para armar el pipeline.
+*/
+typedef struct StageDescriptor
+{
+    //Nombre de la etapa.
+    const char* name;
+
+    //Manejador de la etapa.
+    StageHandler handler;
+
+    //1 si la etapa puede ejecutarse en un hilo propio.
+    int async_capable;
+} StageDescriptor;
+
+/**
+ * Etapa activa del pipeline.
+*/
+typedef struct PipelineStage
+{
+    //Nombre de la etapa.
+    const char* name;
+
+    //Manejador de la etapa.
+    StageHandler handler;
+
+    //1 si la etapa se ejecuta en un hilo propio.
+    int async;
+
+    //Cantidad de mensajes procesados por la etapa.
+    atomic_long processed;
+
+    //Tiempo total consumido por la etapa, en nanosegundos.
+    atomic_long busy_ns;
+
+    //Punto de medicion de la instrumentacion (-1 si esta deshabilitada).
+    int probe;
+
+    //Cola acotada de la etapa asincronica.
+    PipelineSlot *slots;
+
+    //Proxima posicion a escribir de la cola (solo la modifica el receptor).
+    atomic_uint head;
+
+    //Proxima posicion a leer de la cola (solo la modifica el hilo de la etapa).
+    atomic_uint tail;
+
+    //Semaforo con la cantidad de mensajes encolados: lo incrementa el hilo que entrega el mensaje (despachador, consumidor del anillo o muestreo del archivo mapeado).
+    sem_t items;
+
+    //Hilo de la etapa asincronica.
+    pthread_t thread;
+
+    //Indica al hilo de la etapa que debe terminar una vez vaciada la cola.
+    atomic_int stop;
+
+    //Mensajes descartados por encontrar la cola llena o sin buffers libres en el slab.
+    atomic_long dropped;
+
+    //Maxima ocupacion observada de la cola.
+    atomic_uint high_water;
+} PipelineStage;
+
+/**
+ * @struct pipeline
+ * 
+ * Estructura que almacena las etapas registradas y las etapas activas del pipeline.
+*/
+struct
+{
+    //Etapas registradas.
+    StageDescriptor registry[PIPELINE_MAX_STAGES];
+
+    //Cantidad de etapas registradas.
+    int registered;
+
+    //Etapas activas, en orden de ejecucion.
+    PipelineStage stages[PIPELINE_MAX_STAGES];
+
+    //Cantidad de etapas activas.
+    int count;
+
+    //Cantidad maxima de mensajes por lote de los consumidores propios del servidor (1..PIPELINE_BATCH_MAX).
+    atomic_int batch;
+
+    //Capacidad de la cola de cada etapa asincronica (IPC_PIPELINE_QUEUE_SIZE, potencia de 2).
+    unsigned int queue_size;
+} pipeline = { .batch = PIPELINE_BATCH_MAX, .queue_size = PIPELINE_QUEUE_SIZE };
+
+/**
+ * @struct integrity
+ * 
+ * Estructura que almacena los resultados de la verificacion de los checksums de cada canal.
+*/
+struct
+{
+    //Mensajes de cada canal cuyo checksum coincidio.
+    atomic_long verified[CHANNEL_COUNT];
+
+    //Mensajes de cada canal descartados porque su checksum no coincidio.
+    atomic_long corrupt[CHANNEL_COUNT];
+
+    //Punto de medicion de la instrumentacion (-1 si esta deshabilitada).
+    int probe;
+} integrity = { .probe = -1 };
+
+/**
+ * @struct forward
+ * 
+ * Estructura que almacena el destino de la etapa 'forward'.
+*/
+struct
+{
+    //Archivo (o FIFO) al que se reenvian los mensajes.
+    FILE *fp;
+} forward;
+
+/**
+ * @brief Calcula la diferencia entre dos instantes en nanosegundos.
+ * 
+ * @param end Instante final.
+ * @param start Instante inicial.
+ * 
+ * @return Diferencia en nanosegundos.
+*/
+static long elapsed_ns(const struct timespec* end, const struct timespec* start)
+{
+    return (end->tv_sec - start->tv_sec) * 1000000000L + (end->tv_nsec - start->tv_nsec);
+}
+
+/**
+ * @brief Etapa 'decode': interpreta cada mensaje como una lectura numerica una unica vez.
+ * 
+ * @param batch Lote a procesar.
+ * 
+ * @return No devuelve ningun valor.
+*/
+static void stage_decode(MsgBatch* batch)
+{
+    for (int i = 0; i < batch->count; i++)
+    {
+        MsgView *view = &batch->views[i];
+
+        if (view->dropped)
+            continue;
+
+        view->numeric = parse_reading(view->msg, view->len, &view->value);
+        view->decoded = 1;
+    }
+}
+
+/**
+ * @brief Etapa 'filter': descarta los mensajes vacios o sin remitente y, si IPC_FILTER_NUMERIC vale 1, los que no son lecturas numericas.
+ * 
+ * @param batch Lote a procesar.
+ * 
+ * @return No devuelve ningun valor.
+*/
+static void stage_filter(MsgBatch* batch)
+{
+    static int numeric_only = -1;
+
+    if (numeric_only == -1)
+    {
+        const char* value = config_get("IPC_FILTER_NUMERIC");
+
+        numeric_only = value && strcmp(value, "1") == 0;
+    }
+
+    for (int i = 0; i < batch->count; i++)
+    {
+        MsgView *view = &batch->views[i];
+
+        if (view->len == 0 || view->header->pid <= 0 || (numeric_only && view->decoded && !view->numeric))
+            view->dropped = 1;
+    }
+}
+
+/**
+ * @brief Etapa 'sequence': registra los numeros de secuencia de los mensajes, salvo los de las vistas muestreadas.
+ * 
+ * @param batch Lote a procesar.
+ * 
+ * @return No devuelve ningun valor.
+*/
+static void stage_sequence(MsgBatch* batch)
+{
+    for (int i = 0; i < batch->count; i++)
+        if (!batch->views[i].dropped && !batch->views[i].sampled)
+            track_sequence(batch->views[i].channel, batch->views[i].header);
+}
+
+/**
+ * @brief Etapa 'aggregate': agrega las lecturas numericas, reutilizando la interpretacion de la etapa 'decode' si se ejecuto.
+ * 
+ * @param batch Lote a procesar.
+ * 
+ * @return No devuelve ningun valor.
+*/
+static void stage_aggregate(MsgBatch* batch)
+{
+    for (int i = 0; i < batch->count; i++)
+    {
+        MsgView *view = &batch->views[i];
+
+        if (view->dropped)
+            continue;
+
+        if (!view->decoded)
+            aggregate_msg(view->channel, view->header->pid, view->header->vid, view->msg, view->len);
+        else
+            aggregate_reading(view->channel, view->header->pid, view->header->vid, view->numeric ? &view->value : NULL);
+    }
+}
+
+/**
+ * @brief Etapa 'stats': actualiza, muestra y guarda las estadisticas del servidor.
+ * 
+ * @param batch Lote a procesar.
+ * 
+ * @return No devuelve ningun valor.
+*/
+static void stage_stats(MsgBatch* batch)
+{
+    for (int i = 0; i < batch->count; i++)
+    {
+        MsgView *view = &batch->views[i];
+
+        if (view->dropped)
+            continue;
+
+        dashboard_latency(view->channel, &view->header->timestamp);
+
+        if (view->channel == MESSAGE_QUEUE)
+            refresh_lane_stats((MsgPriority)view->priority, &view->header->timestamp);
+
+        refresh_stats(view->channel, view->header->pid, view->msg, 0);
+    }
+}
+
+/**
+ * @brief Etapa 'journal': agrega los mensajes al journal.
+ * 
+ * @param batch Lote a procesar.
+ * 
+ * @return No devuelve ningun valor.
+*/
+static void stage_journal(MsgBatch* batch)
+{
+    for (int i = 0; i < batch->count; i++)
+    {
+        MsgView *view = &batch->views[i];
+
+        if (!view->dropped)
+            journal_append(view->channel, view->header, view->msg, view->len);
+    }
+}
+
+/**
+ * @brief Etapa 'record': graba los mensajes en la traza de trafico.
+ * 
+ * @param batch Lote a procesar.
+ * 
+ * @return No devuelve ningun valor.
+*/
+static void stage_record(MsgBatch* batch)
+{
+    for (int i = 0; i < batch->count; i++)
+    {
+        MsgView *view = &batch->views[i];
+
+        if (!view->dropped)
+            recorder_record(view->channel, view->priority, view->len + 1);
+    }
+}
+
+/**
+ * @brief Etapa 'forward': reenvia cada mensaje como una linea de texto al archivo o FIFO indicado en IPC_FORWARD_FILE.
+ * 
+ * @param batch Lote a procesar.
+ * 
+ * @return No devuelve ningun valor.
+*/
+static void stage_forward(MsgBatch* batch)
+{
+    extern const char* ChannelStringType[];
+
+    for (int i = 0; i < batch->count; i++)
+    {
+        MsgView *view = &batch->views[i];
+
+        if (!view->dropped)
+            fprintf(forward.fp, "%s %d %u %.*s\n", ChannelStringType[view->channel], view->header->pid, view->header->seq, (int)view->len, view->msg);
+    }
+
+    fflush(forward.fp);
+}
+
+/**
+ * @brief Abre el destino de la etapa 'forward'.
+ * 
+ * @return No devuelve ningun valor.
+*/
+static void forward_open(void)
+{
+    const char* file = config_get("IPC_FORWARD_FILE");
+
+    if (!file || !*file)
+    {
+        fprintf(stderr, "\033[1;31mLa etapa 'forward' requiere definir IPC_FORWARD_FILE !\033[0m\n");
+        exit(EXIT_FAILURE);
+    }
+
+    if ((forward.fp = fopen(file, "a")) == NULL)
+    {
+        fprintf(stderr, "\033[1;31mNo se pudo abrir el destino de reenvio %s: %s\033[0m\n", file, strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+}
+
+/**
+ * @brief Hilo de una etapa asincronica: procesa por lotes los mensajes de su cola.
+ * 
+ * @param arg Puntero a la etapa.
+ * 
+ * @return NULL.
+*/
+static void* stage_thread(void* arg)
+{
+    PipelineStage *stage = arg;
+    MsgBatch batch;
+    void *buffers[PIPELINE_BATCH_MAX];
+    ProfileSample sample;
+    struct timespec start, end;
+
+    while (1)
+    {
+        while (sem_wait(&stage->items) == -1 && errno == EINTR) { continue; }
+
+        unsigned int tail = atomic_load_explicit(&stage->tail, memory_order_relaxed);
+        unsigned int head = atomic_load_explicit(&stage->head, memory_order_acquire);
+
+        if (head == tail)
+        {
+            if (atomic_load(&stage->stop))
+                break;
+
+            continue;
+        }
+
+        int limit = pipeline_batch_limit();
+
+        batch.count = 0;
+
+        while (tail + (unsigned int)batch.count != head && batch.count < limit)
+        {
+            PipelineSlot *slot = &stage->slots[(tail + (unsigned int)batch.count) & (pipeline.queue_size - 1)];
+
+            batch.views[batch.count] = slot->view;
+            batch.views[batch.count].header = &slot->header;
+            batch.views[batch.count].msg = slot->msg;
+            batch.views[batch.count].release = NULL;
+            buffers[batch.count] = slot->msg;
+            batch.count++;
+        }
+
+        for (int i = 1; i < batch.count; i++)
+            sem_trywait(&stage->items);
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        profile_begin(&sample);
+
+        stage->handler(&batch);
+
+        profile_end(stage->probe, &sample, batch.count);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        atomic_fetch_add(&stage->busy_ns, elapsed_ns(&end, &start));
+        atomic_fetch_add(&stage->processed, batch.count);
+
+        slab_free_bulk(buffers, batch.count);
+
+        atomic_store_explicit(&stage->tail, tail + (unsigned int)batch.count, memory_order_release);
+    }
+
+    slab_thread_flush();
+
+    return NULL;
+}
+
+/**
+ * @brief Copia los mensajes no descartados de un lote en la cola de una etapa asincronica.
+ * 
+ * @param stage Etapa asincronica.
+ * @param batch Lote a encolar.
+ * 
+ * @return No devuelve ningun valor.
+*/
+static void stage_enqueue(PipelineStage* stage, const MsgBatch* batch)
+{
+    for (int i = 0; i < batch->count; i++)
+    {
+        const MsgView *view = &batch->views[i];
+
+        if (view->dropped)
+            continue;
+
+        unsigned int head = atomic_load_explicit(&stage->head, memory_order_relaxed);
+        unsigned int tail = atomic_load_explicit(&stage->tail, memory_order_acquire);
+
+        PipelineSlot *slot = &stage->slots[head & (pipeline.queue_size - 1)];
+
+        if (head - tail >= pipeline.queue_size || (slot->msg = slab_alloc(view->len + 1)) == NULL)
+        {
+            atomic_fetch_add_explicit(&stage->dropped, 1, memory_order_relaxed);
+            continue;
+        }
+
+        slot->view = *view;
+        slot->header = *view->header;
+        memcpy(slot->msg, view->msg, view->len);
+        slot->msg[view->len] = '\0';
+
+        atomic_store_explicit(&stage->head, head + 1, memory_order_release);
+
+        if (head + 1 - tail > atomic_load_explicit(&stage->high_water, memory_order_relaxed))
+            atomic_store_explicit(&stage->high_water, head + 1 - tail, memory_order_relaxed);
+
+        sem_post(&stage->items);
+    }
+}
+
+/**
+ * @brief Verifica que el filtro numerico (IPC_FILTER_NUMERIC=1) se ejecute despues de la etapa 'decode'.
+ * 
+ * La etapa 'filter' solo reconoce las lecturas numericas que interpreto 'decode'; sin ella el filtro no descartaria nada.
+ * Si el orden es invalido, la función muestra un mensaje de error y termina el programa.
+ * 
+ * @return No devuelve ningun valor.
+*/
+static void pipeline_check_order(void)
+{
+    const char* numeric = config_get("IPC_FILTER_NUMERIC");
+    int decode = -1;
+
+    if (!numeric || strcmp(numeric, "1") != 0)
+        return;
+
+    for (int i = 0; i < pipeline.count; i++)
+    {
+        if (pipeline.stages[i].handler == stage_decode && decode == -1)
+            decode = i;
+
+        if (pipeline.stages[i].handler == stage_filter && decode == -1)
+        {
+            fprintf(stderr, "\033[1;31mIPC_FILTER_NUMERIC=1 requiere que la etapa 'decode' preceda a 'filter' en IPC_PIPELINE\033[0m\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+void pipeline_register(const char* name, StageHandler handler, int async_capable)
+{
+    if (pipeline.registered == PIPELINE_MAX_STAGES)
+    {
+        fprintf(stderr, "\033[1;31mNo se pueden registrar mas etapas en el pipeline !\033[0m\n");
+        exit(EXIT_FAILURE);
+    }
+
+    pipeline.registry[pipeline.registered++] = (StageDescriptor) { name, handler, async_capable };
+}
+
+void pipeline_init(void)
+{
+    const char* spec = config_get("IPC_PIPELINE");
+    char config[512], *token, *saveptr;
+    sigset_t all, previous;
+    long async_stages = 0;
+
+    pipeline_configure();
+
+    pipeline_register("decode", stage_decode, 0);
+    pipeline_register("filter", stage_filter, 0);
+    pipeline_register("sequence", stage_sequence, 0);
+    pipeline_register("aggregate", stage_aggregate, 0);
+    pipeline_register("stats", stage_stats, 0);
+    pipeline_register("journal", stage_journal, 1);
+    pipeline_register("record", stage_record, 1);
+    pipeline_register("forward", stage_forward, 1);
+
+    integrity.probe = profile_probe("checksum");
+
+    snprintf(config, sizeof(config), "%s", spec && *spec ? spec : PIPELINE_DEFAULT);
+
+    for (const char* async = strstr(config, "@async"); async; async = strstr(async + 1, "@async"))
+        async_stages++;
+
+    pipeline.queue_size = (unsigned int)config_pow2("IPC_PIPELINE_QUEUE_SIZE", PIPELINE_QUEUE_SIZE, 16, 65536);
+
+    if (async_stages > 0)
+        slab_init(async_stages * (long)pipeline.queue_size, (int)async_stages + PIPELINE_PRODUCERS);
+
+    sigfillset(&all);
+    pthread_sigmask(SIG_BLOCK, &all, &previous);
+
+    for (token = strtok_r(config, ",", &saveptr); token; token = strtok_r(NULL, ",", &saveptr))
+    {
+        char *suffix = strchr(token, '@');
+        int async = suffix && strcmp(suffix, "@async") == 0;
+        const StageDescriptor *descriptor = NULL;
+
+        if (suffix)
+            *suffix = '\0';
+
+        for (int i = 0; i < pipeline.registered && !descriptor; i++)
+            if (strcmp(pipeline.registry[i].name, token) == 0)
+                descriptor = &pipeline.registry[i];
+
+        if (!descriptor || (suffix && !async) || (async && !descriptor->async_capable) || pipeline.count == PIPELINE_MAX_STAGES)
+        {
+            fprintf(stderr, "\033[1;31mEtapa del pipeline invalida: %s%s\033[0m\n", token, async ? "@async" : "");
+            exit(EXIT_FAILURE);
+        }
+
+        if (descriptor->handler == stage_forward)
+            forward_open();
+
+        PipelineStage *stage = &pipeline.stages[pipeline.count++];
+
+        stage->name = descriptor->name;
+        stage->handler = descriptor->handler;
+        stage->async = async;
+        stage->probe = profile_probe(stage->name);
+
+        if (!async)
+            continue;
+
+        stage->slots = malloc(pipeline.queue_size * sizeof(PipelineSlot));
+
+        sem_init(&stage->items, 0, 0);
+
+        if (!stage->slots || pthread_create(&stage->thread, NULL, stage_thread, stage) != 0)
+        {
+            fprintf(stderr, "\033[1;31mNo se pudo iniciar la etapa asincronica %s\033[0m\n", stage->name);
+            exit(EXIT_FAILURE);
+        }
+
+        placement_thread(stage->thread, THREAD_LOG, stage->name);
+    }
+
+    pthread_sigmask(SIG_SETMASK, &previous, NULL);
+
+    pipeline_check_order();
+}
+
+void pipeline_configure(void)
+{
+    atomic_store(&pipeline.batch, (int)config_long("IPC_PIPELINE_BATCH", PIPELINE_BATCH_MAX, 1, PIPELINE_BATCH_MAX));
+}
+
+int pipeline_batch_limit(void)
+{
+    return atomic_load(&pipeline.batch);
+}
+
+/**
+ * @brief Verifica el checksum de los mensajes de un lote y descarta los que no coinciden.
+ * 
+ * Solo se verifican los mensajes cuya cabecera incluye MSG_FLAG_CHECKSUM; los de clientes con IPC_CHECKSUM deshabilitado no lo llevan.
+ * 
+ * @param batch Lote a verificar.
+ * 
+ * @return No devuelve ningun valor.
+*/
+static void verify_checksums(MsgBatch* batch)
+{
+    ProfileSample sample;
+
+    profile_begin(&sample);
+
+    for (int i = 0; i < batch->count; i++)
+    {
+        MsgView *view = &batch->views[i];
+
+        if (!(view->header->flags & MSG_FLAG_CHECKSUM))
+            continue;
+
+        if (checksum_message(view->msg, view->len) == view->header->crc)
+        {
+            atomic_fetch_add(&integrity.verified[view->channel], 1);
+            continue;
+        }
+
+        view->dropped = 1;
+        atomic_fetch_add(&integrity.corrupt[view->channel], 1);
+    }
+
+    profile_end(integrity.probe, &sample, batch->count);
+}
+
+void pipeline_run(MsgBatch* batch)
+{
+    struct timespec start, end;
+    ProfileSample sample;
+
+    verify_checksums(batch);
+
+    for (int i = 0; i < batch->count; i++)
+        trace_event(TRACE_RECEIVE, batch->views[i].channel, batch->views[i].header->pid, batch->views[i].header->vid, batch->views[i].header->seq);
+
+    for (int i = 0; i < pipeline.count; i++)
+    {
+        PipelineStage *stage = &pipeline.stages[i];
+
+        if (stage->async)
+        {
+            stage_enqueue(stage, batch);
+            continue;
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        profile_begin(&sample);
+
+        stage->handler(batch);
+
+        profile_end(stage->probe, &sample, batch->count);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        atomic_fetch_add(&stage->busy_ns, elapsed_ns(&end, &start));
+        atomic_fetch_add(&stage->processed, batch->count);
+    }
+
+    for (int i = 0; i < batch->count; i++)
+        if (batch->views[i].release)
+            batch->views[i].release(&batch->views[i]);
+}
+
+void print_pipeline_stats(FILE *fp)
+{
+    fprintf(fp, "PIPELINE       : %d etapas\n", pipeline.count);
+
+    for (int i = 0; i < pipeline.count; i++)
+    {
+        PipelineStage *stage = &pipeline.stages[i];
+        long processed = atomic_load(&stage->processed);
+        double cost = processed ? (double)atomic_load(&stage->busy_ns) / (double)processed / 1000.0 : 0.0;
+
+        fprintf(fp, "  %-13s: %ld mensajes, %.2f us/msg", stage->name, processed, cost);
+
+        if (stage->async)
+        {
+            unsigned int depth = atomic_load(&stage->head) - atomic_load(&stage->tail);
+
+            fprintf(fp, " [async: cola %u/%u, max %u, %ld descartados]", depth, pipeline.queue_size, atomic_load(&stage->high_water), atomic_load(&stage->dropped));
+        }
+
+        fprintf(fp, "\n");
+    }
+
+    print_slab_stats(fp);
+}
+
+void print_integrity_stats(FILE *fp)
+{
+    extern const char* ChannelStringType[];
+    long verified = 0, corrupt = 0;
+
+    for (int i = 0; i < CHANNEL_COUNT; i++)
+    {
+        verified += atomic_load(&integrity.verified[i]);
+        corrupt += atomic_load(&integrity.corrupt[i]);
+    }
+
+    fprintf(fp, "CHECKSUM       : CRC32C %s, %ld verificados, %ld corruptos\n", checksum_impl(), verified, corrupt);
+
+    for (int i = 0; i < CHANNEL_COUNT; i++)
+        if (atomic_load(&integrity.verified[i]) || atomic_load(&integrity.corrupt[i]))
+            fprintf(fp, "  %-13s: %ld verificados, %ld corruptos\n", ChannelStringType[i], atomic_load(&integrity.verified[i]), atomic_load(&integrity.corrupt[i]));
+}
+
+void pipeline_stop(void)
+{
+    for (int i = 0; i < pipeline.count; i++)
+    {
+        PipelineStage *stage = &pipeline.stages[i];
+
+        if (!stage->async || atomic_load(&stage->stop))
+            continue;
+
+        atomic_store(&stage->stop, 1);
+        sem_post(&stage->items);
+
+        pthread_join(stage->thread, NULL);
+    }
+}
+
+void pipeline_close(void)
+{
+    pipeline_stop();
+
+    for (int i = 0; i < pipeline.count; i++)
+    {
+        PipelineStage *stage = &pipeline.stages[i];
+
+        if (!stage->async)
+            continue;
+
+        sem_destroy(&stage->items);
+        free(stage->slots);
+
+        stage->async = 0;
+    }
+
+    if (forward.fp)
+        fclose(forward.fp);
+
+    forward.fp = NULL;
+
+    slab_close();
+}
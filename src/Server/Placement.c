@@ -0,0 +1,328 @@
+/**
+ * @file Placement.c
+ * @author Bottini, Franco Nicolas.
+ * @brief Implementacion de la ubicacion de los hilos del Server IPC en los CPUs.
+ * @version 1.0
+ * @date Marzo de 2023.
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#define _GNU_SOURCE
+
+#include <sched.h>
+#include <ctype.h>
+#include "Placement.h"
+#include "Credits.h"
+
+//Variables de configuracion con el conjunto de CPUs de cada rol.
+static const char* RoleConfigKey[THREAD_ROLES] = { "IPC_CPU_RECEIVE", "IPC_CPU_STATS", "IPC_CPU_LOG" };
+
+//Array auxiliar para obtener un elemento del enumerado 'ThreadRole' en formato de cadena.
+static const char* RoleStringType[THREAD_ROLES] = { "recepcion", "estadisticas", "log" };
+
+/**
+ * Ubicacion efectiva de un hilo del servidor.
+*/
+typedef struct PlacedThread
+{
+    //Nombre del hilo.
+    char name[PLACEMENT_NAME_MAX];
+
+    //Descripcion del origen de la ubicacion (rol o CPU propio).
+    const char* origin;
+
+    //CPUs en los que puede ejecutarse el hilo.
+    cpu_set_t cpus;
+
+    //Politica de planificacion del hilo.
+    int policy;
+
+    //Prioridad de tiempo real del hilo (0 con la politica por defecto).
+    int priority;
+} PlacedThread;
+
+/**
+ * @struct placement
+ *
+ * Estructura que almacena los conjuntos de CPUs de cada rol y la ubicacion de los hilos del servidor.
+*/
+struct
+{
+    //Afinidad del proceso al iniciar (la de los roles sin conjunto).
+    cpu_set_t original;
+
+    //Conjunto de CPUs de cada rol.
+    cpu_set_t roles[THREAD_ROLES];
+
+    //1 si el rol tiene un conjunto de CPUs propio.
+    int pinned[THREAD_ROLES];
+
+    //CPUs ocupados por los hilos fijados a un unico CPU.
+    cpu_set_t singles;
+
+    //1 si se reservan los CPUs del servidor excluyendolos de los clientes.
+    int isolate;
+
+    //Prioridad SCHED_FIFO solicitada para el despachador (0 si no se solicita).
+    int fifo_priority;
+
+    //Hilos ubicados.
+    PlacedThread threads[PLACEMENT_THREADS];
+
+    //Cantidad de hilos ubicados.
+    int count;
+} placement;
+
+/**
+ * @brief Interpreta una lista de CPUs ("2,3", "0-3,6").
+ *
+ * @param name Nombre de la variable de configuracion.
+ * @param set Destino del conjunto de CPUs.
+ *
+ * @return 1 si la variable esta definida. 0 en caso contrario.
+*/
+static int parse_cpu_list(const char* name, cpu_set_t* set)
+{
+    const char* text = config_get(name);
+    char *end;
+
+    CPU_ZERO(set);
+
+    if (!text || !*text)
+        return 0;
+
+    while (*text)
+    {
+        long first = strtol(text, &end, 10), last = first;
+
+        if (end == text)
+            break;
+
+        if (*end == '-')
+        {
+            text = end + 1;
+            last = strtol(text, &end, 10);
+
+            if (end == text)
+                break;
+        }
+
+        if (first < 0 || last < first || last >= CPU_SETSIZE)
+            break;
+
+        for (long cpu = first; cpu <= last; cpu++)
+        {
+            if (!CPU_ISSET((size_t)cpu, &placement.original))
+            {
+                fprintf(stderr, "\033[1;31m%s: el CPU %ld no esta disponible para el servidor\033[0m\n", name, cpu);
+                exit(EXIT_FAILURE);
+            }
+
+            CPU_SET((size_t)cpu, set);
+        }
+
+        while (isspace((unsigned char)*end))
+            end++;
+
+        if (*end == '\0')
+            return 1;
+
+        if (*end != ',')
+            break;
+
+        text = end + 1;
+    }
+
+    fprintf(stderr, "\033[1;31mLista de CPUs invalida en %s: %s (ejemplo: 2,3 o 0-3)\033[0m\n", name, config_get(name));
+    exit(EXIT_FAILURE);
+}
+
+/**
+ * @brief Formatea un conjunto de CPUs como lista de rangos.
+ *
+ * @param set Conjunto de CPUs.
+ * @param buffer Destino del texto.
+ * @param size Tamaño del destino.
+ *
+ * @return Puntero al destino.
+*/
+static char* format_cpu_list(const cpu_set_t* set, char* buffer, size_t size)
+{
+    size_t used = 0;
+
+    buffer[0] = '\0';
+
+    for (int cpu = 0; cpu < CPU_SETSIZE && used < size; cpu++)
+    {
+        if (!CPU_ISSET((size_t)cpu, set))
+            continue;
+
+        int last = cpu;
+
+        while (last + 1 < CPU_SETSIZE && CPU_ISSET((size_t)(last + 1), set))
+            last++;
+
+        if (last == cpu)
+            used += (size_t)snprintf(buffer + used, size - used, "%s%d", used ? "," : "", cpu);
+        else
+            used += (size_t)snprintf(buffer + used, size - used, "%s%d-%d", used ? "," : "", cpu, last);
+
+        cpu = last;
+    }
+
+    return buffer;
+}
+
+/**
+ * @brief Registra la ubicacion efectiva de un hilo.
+ *
+ * @param thread Hilo a registrar.
+ * @param name Nombre del hilo.
+ * @param origin Origen de la ubicacion.
+ * @param cpus CPUs del hilo si no se pueden consultar (hilos que aun no existen); NULL para consultarlos.
+ *
+ * @return No devuelve ningun valor.
+*/
+static void record_thread(pthread_t thread, const char* name, const char* origin, const cpu_set_t* cpus)
+{
+    struct sched_param param = { .sched_priority = 0 };
+
+    if (placement.count == PLACEMENT_THREADS)
+        return;
+
+    PlacedThread *placed = &placement.threads[placement.count++];
+
+    snprintf(placed->name, sizeof(placed->name), "%s", name);
+    placed->origin = origin;
+    placed->policy = SCHED_OTHER;
+    placed->priority = 0;
+
+    if (cpus)
+    {
+        placed->cpus = *cpus;
+        return;
+    }
+
+    if (pthread_getaffinity_np(thread, sizeof(placed->cpus), &placed->cpus) != 0)
+        placed->cpus = placement.original;
+
+    if (pthread_getschedparam(thread, &placed->policy, &param) == 0)
+        placed->priority = param.sched_priority;
+}
+
+void placement_init(void)
+{
+    if (sched_getaffinity(0, sizeof(placement.original), &placement.original) == -1)
+    {
+        fprintf(stderr, "\033[1;31mNo se pudo obtener la afinidad del servidor: %s\033[0m\n", strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+
+    for (int role = 0; role < THREAD_ROLES; role++)
+        placement.pinned[role] = parse_cpu_list(RoleConfigKey[role], &placement.roles[role]);
+
+    CPU_ZERO(&placement.singles);
+
+    placement.isolate = (int)config_long("IPC_CPU_ISOLATE", 0, 0, 1);
+    placement.fifo_priority = (int)config_long("IPC_SCHED_FIFO", 0, 0, 99);
+}
+
+int placement_cpu(ThreadRole role)
+{
+    if (!placement.pinned[role])
+        return -1;
+
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+        if (CPU_ISSET((size_t)cpu, &placement.roles[role]))
+            return cpu;
+
+    return -1;
+}
+
+void placement_thread(pthread_t thread, ThreadRole role, const char* name)
+{
+    int error;
+
+    if (placement.pinned[role] && (error = pthread_setaffinity_np(thread, sizeof(cpu_set_t), &placement.roles[role])) != 0)
+        fprintf(stderr, "\033[1;31mNo se pudo ubicar el hilo %s en los CPUs de %s: %s\033[0m\n", name, RoleStringType[role], strerror(error));
+
+    record_thread(thread, name, RoleStringType[role], NULL);
+}
+
+void placement_pin(pthread_t thread, int cpu, const char* name)
+{
+    cpu_set_t set;
+    int error;
+
+    CPU_ZERO(&set);
+    CPU_SET((size_t)cpu, &set);
+
+    if ((error = pthread_setaffinity_np(thread, sizeof(set), &set)) != 0)
+        fprintf(stderr, "\033[1;31mNo se pudo fijar el hilo %s al CPU %d: %s\033[0m\n", name, cpu, strerror(error));
+    else
+        CPU_SET((size_t)cpu, &placement.singles);
+
+    record_thread(thread, name, "CPU propio", NULL);
+}
+
+void placement_start(void)
+{
+    uint64_t mask[CPU_MASK_WORDS] = { 0 };
+    struct sched_param param = { .sched_priority = placement.fifo_priority };
+    int error;
+
+    if (placement.pinned[THREAD_RECEIVE] && (error = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &placement.roles[THREAD_RECEIVE])) != 0)
+        fprintf(stderr, "\033[1;31mNo se pudo ubicar el despachador en los CPUs de recepcion: %s\033[0m\n", strerror(error));
+
+    if (placement.fifo_priority > 0 && (error = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param)) != 0)
+        fprintf(stderr, "\033[1;31mNo se pudo aplicar SCHED_FIFO %d al despachador: %s (requiere CAP_SYS_NICE o RLIMIT_RTPRIO), se conserva SCHED_OTHER\033[0m\n", placement.fifo_priority, strerror(error));
+
+    record_thread(pthread_self(), "despachador", RoleStringType[THREAD_RECEIVE], NULL);
+
+    if (placement.isolate)
+    {
+        for (int cpu = 0; cpu < CPU_SETSIZE && cpu < CPU_MASK_WORDS * 64; cpu++)
+        {
+            int reserved = CPU_ISSET((size_t)cpu, &placement.singles);
+
+            for (int role = 0; role < THREAD_ROLES; role++)
+                reserved |= placement.pinned[role] && CPU_ISSET((size_t)cpu, &placement.roles[role]);
+
+            if (reserved)
+                mask[cpu / 64] |= (uint64_t)1 << (cpu % 64);
+        }
+    }
+
+    publish_isolated_cpus(mask);
+}
+
+void print_placement(FILE *fp)
+{
+    char cpus[256], reserved[256];
+    cpu_set_t isolated;
+
+    CPU_ZERO(&isolated);
+
+    if (placement.isolate)
+    {
+        CPU_OR(&isolated, &isolated, &placement.singles);
+
+        for (int role = 0; role < THREAD_ROLES; role++)
+            if (placement.pinned[role])
+                CPU_OR(&isolated, &isolated, &placement.roles[role]);
+    }
+
+    fprintf(fp, "PLACEMENT      : CPUs del proceso %s, reservados para el servidor: %s\n", format_cpu_list(&placement.original, cpus, sizeof(cpus)), CPU_COUNT(&isolated) ? format_cpu_list(&isolated, reserved, sizeof(reserved)) : "ninguno");
+
+    for (int i = 0; i < placement.count; i++)
+    {
+        PlacedThread *placed = &placement.threads[i];
+
+        if (placed->policy == SCHED_FIFO)
+            fprintf(fp, "  %-13s: %s, CPUs %s, SCHED_FIFO %d\n", placed->name, placed->origin, format_cpu_list(&placed->cpus, cpus, sizeof(cpus)), placed->priority);
+        else
+            fprintf(fp, "  %-13s: %s, CPUs %s\n", placed->name, placed->origin, format_cpu_list(&placed->cpus, cpus, sizeof(cpus)));
+    }
+}
@@ -0,0 +1,285 @@
+/**
+ * @file Profiler.c
+ * @author Bottini, Franco Nicolas.
+ * @brief Implementacion de la instrumentacion del camino critico del Server IPC.
+ * @version 1.0
+ * @date Marzo de 2023.
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <sys/ioctl.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include "Profiler.h"
+
+//Duracion de la calibracion del contador de ciclos, en nanosegundos.
+#define PROFILE_CALIBRATION_NS 10000000L
+
+/**
+ * Acumulado de un punto de medicion.
+*/
+typedef struct ProfileProbe
+{
+    //Nombre del punto.
+    const char* name;
+
+    //Mediciones acumuladas.
+    atomic_ullong calls;
+
+    //Mensajes procesados durante las mediciones.
+    atomic_ullong messages;
+
+    //Ciclos del contador rdtsc.
+    atomic_ullong ticks;
+
+    //Incremento de cada contador de perf_event.
+    atomic_ullong counters[PROFILE_COUNTERS];
+} ProfileProbe;
+
+/**
+ * @struct profiler
+ *
+ * Estructura que almacena el estado de la instrumentacion.
+*/
+struct
+{
+    //1 si la instrumentacion esta habilitada.
+    int enabled;
+
+    //Ciclos del contador rdtsc por nanosegundo.
+    double ticks_per_ns;
+
+    //Puntos de medicion registrados.
+    ProfileProbe probes[PROFILE_PROBES_MAX];
+
+    //Cantidad de puntos registrados.
+    atomic_int count;
+
+    //1 si algun hilo pudo abrir el contador.
+    atomic_int available[PROFILE_COUNTERS];
+} profiler;
+
+/**
+ * @struct perf
+ *
+ * Grupo de contadores de perf_event del hilo actual.
+*/
+static _Thread_local struct
+{
+    //1 si el hilo ya intento abrir sus contadores.
+    int opened;
+
+    //File descriptor del lider del grupo (-1 si no se abrio ningun contador).
+    int leader;
+
+    //Posicion de cada contador en la lectura del grupo (-1 si no esta disponible).
+    int index[PROFILE_COUNTERS];
+
+    //Cantidad de contadores del grupo.
+    int count;
+} perf;
+
+//Tipo y configuracion de perf_event de cada contador.
+static const struct { uint32_t type; uint64_t config; } profile_events[PROFILE_COUNTERS] =
+{
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+    { PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES },
+    { PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS }
+};
+
+//Nombre de cada contador en las estadisticas.
+static const char* profile_counter_names[PROFILE_COUNTERS] = { "ciclos", "instrucciones", "cambios de contexto", "fallos de pagina" };
+
+/**
+ * @brief Lee el contador de ciclos del procesador (o CLOCK_MONOTONIC en arquitecturas sin rdtsc).
+ *
+ * @return Marca de tiempo actual.
+*/
+static inline uint64_t read_tsc(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+#endif
+}
+
+/**
+ * @brief Abre el grupo de contadores de perf_event del hilo actual.
+ *
+ * Cada contador se abre por separado y se une al grupo del primero que se pudo abrir, de modo que la falta de
+ * contadores de hardware (por ejemplo, en una maquina virtual) no impide medir los de software.
+ *
+ * @return No devuelve ningun valor.
+*/
+static void perf_open(void)
+{
+    perf.opened = 1;
+    perf.leader = -1;
+
+    for (int i = 0; i < PROFILE_COUNTERS; i++)
+    {
+        struct perf_event_attr attr;
+
+        memset(&attr, 0, sizeof(attr));
+
+        attr.size = sizeof(attr);
+        attr.type = profile_events[i].type;
+        attr.config = profile_events[i].config;
+        attr.read_format = PERF_FORMAT_GROUP;
+        attr.exclude_kernel = attr.type == PERF_TYPE_HARDWARE;
+        attr.exclude_hv = 1;
+
+        int fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, perf.leader, PERF_FLAG_FD_CLOEXEC);
+
+        perf.index[i] = -1;
+
+        if (fd == -1)
+            continue;
+
+        if (perf.leader == -1)
+            perf.leader = fd;
+
+        perf.index[i] = perf.count++;
+
+        atomic_store(&profiler.available[i], 1);
+    }
+
+    if (perf.leader != -1)
+        ioctl(perf.leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+/**
+ * @brief Lee los contadores del grupo del hilo actual.
+ *
+ * @param counters Valor de cada contador (0 si no esta disponible).
+ *
+ * @return No devuelve ningun valor.
+*/
+static void perf_read(uint64_t counters[PROFILE_COUNTERS])
+{
+    uint64_t values[1 + PROFILE_COUNTERS];
+
+    if (!perf.opened)
+        perf_open();
+
+    if (perf.leader == -1 || read(perf.leader, values, sizeof(uint64_t) * (size_t)(1 + perf.count)) == -1)
+    {
+        memset(counters, 0, sizeof(uint64_t) * PROFILE_COUNTERS);
+        return;
+    }
+
+    for (int i = 0; i < PROFILE_COUNTERS; i++)
+        counters[i] = perf.index[i] == -1 ? 0 : values[1 + perf.index[i]];
+}
+
+void profiler_init(void)
+{
+    const char* enabled = config_get("IPC_PROFILE");
+    struct timespec start, end, wait = {0, PROFILE_CALIBRATION_NS};
+
+    if (!enabled || strcmp(enabled, "1") != 0)
+        return;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    uint64_t tsc = read_tsc();
+
+    nanosleep(&wait, NULL);
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    tsc = read_tsc() - tsc;
+
+    profiler.ticks_per_ns = (double)tsc / ((double)(end.tv_sec - start.tv_sec) * 1e9 + (double)(end.tv_nsec - start.tv_nsec));
+    profiler.enabled = 1;
+
+    profile_probe("receive");
+    profile_probe("control");
+    profile_probe("stats file");
+    profile_probe("terminal");
+}
+
+int profile_probe(const char* name)
+{
+    if (!profiler.enabled || atomic_load(&profiler.count) == PROFILE_PROBES_MAX)
+        return -1;
+
+    int probe = atomic_fetch_add(&profiler.count, 1);
+
+    profiler.probes[probe].name = name;
+
+    return probe;
+}
+
+void profile_begin(ProfileSample* sample)
+{
+    if (!profiler.enabled)
+        return;
+
+    perf_read(sample->counters);
+
+    sample->tsc = read_tsc();
+}
+
+void profile_end(int probe, const ProfileSample* sample, long messages)
+{
+    uint64_t counters[PROFILE_COUNTERS];
+
+    if (!profiler.enabled || probe < 0)
+        return;
+
+    uint64_t tsc = read_tsc();
+
+    perf_read(counters);
+
+    ProfileProbe *target = &profiler.probes[probe];
+
+    atomic_fetch_add_explicit(&target->calls, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&target->messages, (unsigned long long)messages, memory_order_relaxed);
+    atomic_fetch_add_explicit(&target->ticks, tsc - sample->tsc, memory_order_relaxed);
+
+    for (int i = 0; i < PROFILE_COUNTERS; i++)
+        atomic_fetch_add_explicit(&target->counters[i], counters[i] - sample->counters[i], memory_order_relaxed);
+}
+
+void print_profile_stats(FILE *fp)
+{
+    if (!profiler.enabled)
+        return;
+
+    fprintf(fp, "PERFIL         : tsc %.2f GHz, contadores:", profiler.ticks_per_ns);
+
+    for (int i = 0; i < PROFILE_COUNTERS; i++)
+        fprintf(fp, " %s %s%s", profile_counter_names[i], atomic_load(&profiler.available[i]) ? "si" : "no", i == PROFILE_COUNTERS - 1 ? "\n" : ",");
+
+    for (int i = 0; i < atomic_load(&profiler.count); i++)
+    {
+        ProfileProbe *probe = &profiler.probes[i];
+        unsigned long long calls = atomic_load(&probe->calls);
+        unsigned long long messages = atomic_load(&probe->messages);
+        double per = messages ? (double)messages : (calls ? (double)calls : 1.0);
+        const char* unit = messages ? "msg" : "llamada";
+        double cycles = (double)atomic_load(&probe->counters[PROFILE_CYCLES]);
+        double instructions = (double)atomic_load(&probe->counters[PROFILE_INSTRUCTIONS]);
+
+        fprintf(fp, "  %-13s: %llu llamadas, %llu mensajes, %.2f us/%s", probe->name, calls, messages, (double)atomic_load(&probe->ticks) / profiler.ticks_per_ns / 1000.0 / per, unit);
+
+        if (atomic_load(&profiler.available[PROFILE_CYCLES]))
+            fprintf(fp, ", %.0f ciclos/%s", cycles / per, unit);
+
+        if (atomic_load(&profiler.available[PROFILE_INSTRUCTIONS]))
+            fprintf(fp, ", %.0f instr/%s (IPC %.2f)", instructions / per, unit, cycles > 0 ? instructions / cycles : 0.0);
+
+        fprintf(fp, ", %.3f ctxsw/%s, %.3f pf/%s\n", (double)atomic_load(&probe->counters[PROFILE_CONTEXT_SWITCHES]) / per, unit,
+                (double)atomic_load(&probe->counters[PROFILE_PAGE_FAULTS]) / per, unit);
+    }
+}
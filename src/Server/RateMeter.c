@@ -0,0 +1,172 @@
+/**
+ * @file RateMeter.c
+ * @author Bottini, Franco Nicolas.
+ * @brief Implementacion de los medidores de tasa por ventana deslizante del Server IPC.
+ * @version 1.0
+ * @date Marzo de 2023.
+ * 
+ * @copyright Copyright (c) 2023
+ * 
+ */
+
+#include "RateMeter.h"
+
+/**
+ * Bucket de un medidor: mensajes y bytes recibidos durante un intervalo de RATE_BUCKET_MS.
+*/
+typedef struct RateBucket
+{
+    //Numero de intervalo (desde el inicio del servidor) al que corresponden los contadores.
+    atomic_long tick;
+
+    //Mensajes recibidos en el intervalo.
+    atomic_long msgs;
+
+    //Bytes recibidos en el intervalo.
+    atomic_long bytes;
+} RateBucket;
+
+/**
+ * @struct meters
+ * 
+ * Estructura que almacena los anillos de buckets de cada canal y del total.
+*/
+struct
+{
+    //Anillos de buckets, uno por canal mas el total.
+    RateBucket buckets[CHANNEL_COUNT + 1][RATE_BUCKETS];
+
+    //Instante en que se registro el primer mensaje.
+    struct timespec start;
+
+    //1 si ya se registro el primer mensaje.
+    atomic_int started;
+} meters;
+
+//Duracion de cada ventana, en buckets.
+static const long rate_windows[RATE_WINDOWS] = { 1000 / RATE_BUCKET_MS, 10000 / RATE_BUCKET_MS, 60000 / RATE_BUCKET_MS };
+
+//Nombre de cada ventana.
+static const char* rate_window_names[RATE_WINDOWS] = { "1 s", "10 s", "60 s" };
+
+//Array auxiliar para obtener un elemento del enumerado 'ChannelType' en formato de cadena.
+extern const char* ChannelStringType[];
+
+/**
+ * @brief Obtiene el tiempo transcurrido desde el primer mensaje, en milisegundos.
+ * 
+ * @return Milisegundos transcurridos.
+*/
+static long elapsed_ms(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (now.tv_sec - meters.start.tv_sec) * 1000L + (now.tv_nsec - meters.start.tv_nsec) / 1000000L;
+}
+
+/**
+ * @brief Suma un mensaje al bucket actual de un medidor.
+ * 
+ * @param meter Indice del medidor.
+ * @param tick Intervalo actual.
+ * @param bytes Tamaño del mensaje en bytes.
+ * 
+ * @return No devuelve ningun valor.
+*/
+static void bucket_add(int meter, long tick, size_t bytes)
+{
+    RateBucket *bucket = &meters.buckets[meter][tick & (RATE_BUCKETS - 1)];
+
+    if (atomic_load_explicit(&bucket->tick, memory_order_relaxed) != tick)
+    {
+        atomic_store_explicit(&bucket->msgs, 0, memory_order_relaxed);
+        atomic_store_explicit(&bucket->bytes, 0, memory_order_relaxed);
+        atomic_store_explicit(&bucket->tick, tick, memory_order_release);
+    }
+
+    atomic_fetch_add_explicit(&bucket->msgs, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&bucket->bytes, (long)bytes, memory_order_relaxed);
+}
+
+void rate_meter_record(ChannelType channel_type, size_t bytes)
+{
+    if (channel_type >= CHANNEL_COUNT)
+        return;
+
+    if (!atomic_load(&meters.started))
+    {
+        clock_gettime(CLOCK_MONOTONIC, &meters.start);
+
+        for (int i = 0; i <= CHANNEL_COUNT; i++)
+            for (int j = 0; j < RATE_BUCKETS; j++)
+                atomic_store(&meters.buckets[i][j].tick, -1);
+
+        atomic_store(&meters.started, 1);
+    }
+
+    long tick = elapsed_ms() / RATE_BUCKET_MS;
+
+    bucket_add((int)channel_type, tick, bytes);
+    bucket_add(RATE_TOTAL, tick, bytes);
+}
+
+double rate_meter_rate(int meter, int window, double* bytes_rate)
+{
+    long msgs = 0, bytes = 0;
+
+    if (bytes_rate)
+        *bytes_rate = 0.0;
+
+    if (!atomic_load(&meters.started) || meter < 0 || meter > RATE_TOTAL || window < 0 || window >= RATE_WINDOWS)
+        return 0.0;
+
+    long now_ms = elapsed_ms();
+    long tick = now_ms / RATE_BUCKET_MS;
+    long first = tick - rate_windows[window] + 1;
+
+    for (long t = first > 0 ? first : 0; t <= tick; t++)
+    {
+        RateBucket *bucket = &meters.buckets[meter][t & (RATE_BUCKETS - 1)];
+
+        if (atomic_load_explicit(&bucket->tick, memory_order_acquire) != t)
+            continue;
+
+        msgs += atomic_load_explicit(&bucket->msgs, memory_order_relaxed);
+        bytes += atomic_load_explicit(&bucket->bytes, memory_order_relaxed);
+    }
+
+    //La ventana cubre los buckets completos anteriores mas la fraccion transcurrida del bucket actual.
+    long span_ms = (tick - (first > 0 ? first : 0)) * RATE_BUCKET_MS + now_ms % RATE_BUCKET_MS;
+    double seconds = (double)(span_ms > 0 ? span_ms : 1) / 1000.0;
+
+    if (bytes_rate)
+        *bytes_rate = (double)bytes / seconds;
+
+    return (double)msgs / seconds;
+}
+
+void print_rate_stats(FILE *fp)
+{
+    fprintf(fp, "TASAS          :");
+
+    for (int w = 0; w < RATE_WINDOWS; w++)
+        fprintf(fp, " %26s", rate_window_names[w]);
+
+    fprintf(fp, "\n");
+
+    for (int i = 0; i <= RATE_TOTAL; i++)
+    {
+        fprintf(fp, "  %-13s:", i == RATE_TOTAL ? "TOTAL" : ChannelStringType[i]);
+
+        for (int w = 0; w < RATE_WINDOWS; w++)
+        {
+            double bytes_rate, msgs_rate = rate_meter_rate(i, w, &bytes_rate);
+
+            fprintf(fp, " %8.1f m/s %8.1f KB/s", msgs_rate, bytes_rate / 1024.0);
+        }
+
+        fprintf(fp, "\n");
+    }
+}
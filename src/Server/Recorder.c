@@ -0,0 +1,87 @@
+/**
+ * @file Recorder.c
+ * @author Bottini, Franco Nicolas.
+ * @brief Implementacion del grabador de trazas de trafico del Server IPC.
+ * @version 1.0
+ * @date Marzo de 2023.
+ * 
+ * @copyright Copyright (c) 2023
+ * 
+ */
+
+#include "Recorder.h"
+
+/**
+ * @struct recorder
+ * 
+ * Estructura que almacena el estado del grabador de trazas.
+*/
+struct
+{
+    //Archivo de la traza (NULL si la grabacion esta deshabilitada).
+    FILE *fp;
+
+    //Instante de llegada del ultimo mensaje grabado.
+    struct timespec last;
+
+    //Cantidad de mensajes grabados (se consulta desde el receptor aunque la etapa 'record' sea asincronica).
+    atomic_long records;
+} recorder;
+
+void recorder_init(void)
+{
+    const char* file = config_get("IPC_TRACE_FILE");
+    uint32_t magic = TRAFFIC_TRACE_MAGIC;
+
+    if (!file || !*file)
+        return;
+
+    if ((recorder.fp = fopen(file, "wb")) == NULL)
+    {
+        fprintf(stderr, "\033[1;31mNo se pudo crear la traza de trafico %s: %s\033[0m\n", file, strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+
+    fwrite(&magic, sizeof(magic), 1, recorder.fp);
+}
+
+void recorder_record(ChannelType channel_type, int priority, size_t size)
+{
+    struct timespec now;
+
+    if (!recorder.fp)
+        return;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    TrafficRecord record =
+    {
+        .delta_ns = atomic_load(&recorder.records) ? (uint64_t)((now.tv_sec - recorder.last.tv_sec) * 1000000000L + (now.tv_nsec - recorder.last.tv_nsec)) : 0,
+        .channel = (uint16_t)channel_type,
+        .priority = (uint16_t)priority,
+        .size = (uint32_t)size
+    };
+
+    fwrite(&record, sizeof(record), 1, recorder.fp);
+
+    recorder.last = now;
+    atomic_fetch_add(&recorder.records, 1);
+}
+
+void print_recorder_stats(FILE *fp)
+{
+    if (!recorder.fp)
+        return;
+
+    fprintf(fp, "TRACE          : %ld mensajes grabados\n", atomic_load(&recorder.records));
+}
+
+void recorder_close(void)
+{
+    if (!recorder.fp)
+        return;
+
+    fclose(recorder.fp);
+
+    recorder.fp = NULL;
+}
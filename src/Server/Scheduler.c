@@ -0,0 +1,467 @@
+/**
+ * @file Scheduler.c
+ * @author Bottini, Franco Nicolas.
+ * @brief Implementacion del reparto de los canales con handshake entre los clientes del Server IPC.
+ * @version 1.0
+ * @date Marzo de 2023.
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include "Scheduler.h"
+
+extern const char* ChannelStringType[];
+
+/**
+ * Estado de reparto de un cliente (proceso) en un canal.
+*/
+typedef struct GrantFlow
+{
+    //ID del proceso del cliente (0 si la entrada esta libre).
+    pid_t pid;
+
+    //Identificador del cliente virtual dentro del proceso.
+    uint32_t vid;
+
+    //Peso declarado por el cliente.
+    int weight;
+
+    //Bytes que el cliente todavia puede recibir en su turno.
+    int deficit;
+
+    //1 si el cliente tiene una solicitud en la cola.
+    int pending;
+
+    //Carril de prioridad de la solicitud pendiente (MsgPriority - 1).
+    int lane;
+
+    //Bytes de la solicitud pendiente.
+    int bytes;
+
+    //Instante en que se encolo la solicitud pendiente, en nanosegundos.
+    int64_t enqueued_ns;
+
+    //Instante de la ultima solicitud o concesion, en nanosegundos.
+    int64_t last_ns;
+
+    //Concesiones recibidas.
+    long grants;
+
+    //Bytes de las solicitudes concedidas.
+    long bytes_granted;
+
+    //Solicitudes vencidas en la cola.
+    long expired;
+
+    //Suma de las esperas en la cola de las solicitudes concedidas, en microsegundos.
+    double wait_sum_us;
+
+    //Espera maxima en la cola, en microsegundos.
+    double wait_max_us;
+} GrantFlow;
+
+/**
+ * Cola de reparto de un canal: los clientes con solicitud pendiente de cada carril de prioridad, en el orden en que seran
+ * visitados. Los carriles se atienden con un round-robin ponderado y, dentro de cada carril, con el deficit round-robin.
+*/
+typedef struct GrantQueue
+{
+    //Estado de reparto de cada cliente.
+    GrantFlow flows[GRANT_FLOWS_MAX];
+
+    //Indices de los clientes con solicitud pendiente de cada carril (anillos).
+    int order[MQ_LANES][GRANT_FLOWS_MAX];
+
+    //Posicion del primer cliente del anillo de cada carril.
+    int head[MQ_LANES];
+
+    //Cantidad de clientes en el anillo de cada carril.
+    int count[MQ_LANES];
+
+    //Carril que se esta atendiendo actualmente.
+    int current;
+
+    //Concesiones que le restan al carril actual antes de ceder el turno.
+    int credit[MQ_LANES];
+
+    //Concesiones por carril.
+    long lane_grants[MQ_LANES];
+
+    //Solicitudes rechazadas por falta de lugar.
+    long rejected;
+
+    //Entradas de clientes inactivos reutilizadas para otros clientes.
+    long reclaimed;
+} GrantQueue;
+
+/**
+ * @struct scheduler
+ *
+ * Estructura que almacena la cola de reparto de cada canal con handshake.
+*/
+struct
+{
+    //Cola de reparto de cada canal.
+    GrantQueue channels[MESSAGE_QUEUE + 1];
+
+    //Bytes por ronda y unidad de peso.
+    int quantum;
+
+    //Tiempo maximo de espera en la cola, en milisegundos.
+    long queue_timeout_ms;
+
+    //Tiempo sin concesiones tras el cual se pierde el deficit acumulado, en milisegundos.
+    long idle_reset_ms;
+} scheduler = { .quantum = GRANT_QUANTUM_BYTES, .queue_timeout_ms = GRANT_QUEUE_TIMEOUT_MS, .idle_reset_ms = GRANT_IDLE_RESET_MS };
+
+/**
+ * @struct grant_snapshot
+ *
+ * Estructura que almacena una copia de las colas de reparto, tomada bajo el lock del servidor para imprimirla fuera de el.
+*/
+struct
+{
+    //Cola de reparto de cada canal.
+    GrantQueue channels[MESSAGE_QUEUE + 1];
+
+    //Bytes por ronda y unidad de peso.
+    int quantum;
+
+    //Tiempo maximo de espera en la cola, en milisegundos.
+    long queue_timeout_ms;
+} grant_snapshot;
+
+//Concesiones por turno de cada carril de prioridad (URGENT, NORMAL, BULK) en el round-robin ponderado.
+static const int grant_lane_weights[MQ_LANES] = MQ_LANE_WEIGHTS;
+
+//Array auxiliar para obtener un elemento del enumerado 'MsgPriority' en formato de cadena (indexado por 'mtype' - 1).
+extern const char* PriorityStringType[];
+
+/**
+ * @brief Devuelve el tiempo monotono actual en nanosegundos.
+ *
+ * @return Tiempo actual en nanosegundos.
+*/
+static int64_t scheduler_now_ns(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (int64_t)now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+/**
+ * @brief Busca el estado de reparto de un cliente (proceso y cliente virtual), o le asigna una entrada libre.
+ *
+ * Si no quedan entradas libres se reutiliza la del cliente sin solicitud pendiente que lleva mas tiempo inactivo.
+ *
+ * @param queue Cola de reparto del canal.
+ * @param pid ID del proceso del cliente.
+ * @param vid Identificador del cliente virtual dentro del proceso.
+ *
+ * @return Estado del cliente, o NULL si todos los clientes tienen una solicitud pendiente.
+*/
+static GrantFlow* find_flow(GrantQueue* queue, pid_t pid, uint32_t vid)
+{
+    GrantFlow *free_flow = NULL, *oldest = NULL;
+
+    for (int i = 0; i < GRANT_FLOWS_MAX; i++)
+    {
+        GrantFlow *flow = &queue->flows[i];
+
+        if (flow->pid == pid && flow->vid == vid)
+            return flow;
+
+        if (flow->pid == 0)
+        {
+            if (!free_flow)
+                free_flow = flow;
+        }
+        else if (!flow->pending && (!oldest || flow->last_ns < oldest->last_ns))
+            oldest = flow;
+    }
+
+    if (!free_flow && oldest)
+    {
+        free_flow = oldest;
+        queue->reclaimed++;
+    }
+
+    if (free_flow)
+        *free_flow = (GrantFlow) { .pid = pid, .vid = vid };
+
+    return free_flow;
+}
+
+/**
+ * @brief Quita el primer cliente del anillo de un carril de la cola.
+ *
+ * @param queue Cola de reparto del canal.
+ * @param lane Carril de prioridad.
+ *
+ * @return Indice del cliente quitado.
+*/
+static int pop_front(GrantQueue* queue, int lane)
+{
+    int index = queue->order[lane][queue->head[lane]];
+
+    queue->head[lane] = (queue->head[lane] + 1) % GRANT_FLOWS_MAX;
+    queue->count[lane]--;
+
+    return index;
+}
+
+/**
+ * @brief Agrega un cliente al final del anillo de un carril de la cola.
+ *
+ * @param queue Cola de reparto del canal.
+ * @param lane Carril de prioridad.
+ * @param index Indice del cliente.
+ *
+ * @return No devuelve ningun valor.
+*/
+static void push_back(GrantQueue* queue, int lane, int index)
+{
+    queue->order[lane][(queue->head[lane] + queue->count[lane]) % GRANT_FLOWS_MAX] = index;
+    queue->count[lane]++;
+}
+
+/**
+ * @brief Agrega un cliente al frente del anillo de un carril de la cola.
+ *
+ * @param queue Cola de reparto del canal.
+ * @param lane Carril de prioridad.
+ * @param index Indice del cliente.
+ *
+ * @return No devuelve ningun valor.
+*/
+static void push_front(GrantQueue* queue, int lane, int index)
+{
+    queue->head[lane] = (queue->head[lane] + GRANT_FLOWS_MAX - 1) % GRANT_FLOWS_MAX;
+    queue->order[lane][queue->head[lane]] = index;
+    queue->count[lane]++;
+}
+
+/**
+ * @brief Extrae la proxima solicitud de un carril segun el deficit round-robin ponderado por cliente.
+ *
+ * @param queue Cola de reparto del canal.
+ * @param lane Carril de prioridad, con al menos una solicitud.
+ * @param now Instante actual, en nanosegundos.
+ * @param request Solicitud extraida.
+ *
+ * @return Estado de la solicitud extraida.
+*/
+static GrantStatus lane_next(GrantQueue* queue, int lane, int64_t now, GrantRequest* request)
+{
+    while (1)
+    {
+        GrantFlow *flow = &queue->flows[queue->order[lane][queue->head[lane]]];
+
+        request->pid = flow->pid;
+        request->vid = flow->vid;
+        request->bytes = flow->bytes;
+
+        if (now - flow->enqueued_ns > scheduler.queue_timeout_ms * 1000000LL)
+        {
+            pop_front(queue, lane);
+
+            flow->pending = 0;
+            flow->deficit = 0;
+            flow->expired++;
+
+            return GRANT_EXPIRED;
+        }
+
+        if (kill(flow->pid, 0) == -1 && errno == ESRCH)
+        {
+            pop_front(queue, lane);
+
+            flow->pending = 0;
+            flow->pid = 0;
+
+            return GRANT_GONE;
+        }
+
+        if (flow->deficit < flow->bytes)
+        {
+            flow->deficit += scheduler.quantum * flow->weight;
+
+            if (flow->deficit < flow->bytes)
+            {
+                push_back(queue, lane, pop_front(queue, lane));
+                continue;
+            }
+        }
+
+        pop_front(queue, lane);
+
+        double wait_us = (double)(now - flow->enqueued_ns) / 1000.0;
+
+        flow->deficit -= flow->bytes;
+        flow->pending = 0;
+        flow->last_ns = now;
+        flow->grants++;
+        flow->bytes_granted += flow->bytes;
+        flow->wait_sum_us += wait_us;
+
+        if (wait_us > flow->wait_max_us)
+            flow->wait_max_us = wait_us;
+
+        queue->lane_grants[lane]++;
+
+        return GRANT_READY;
+    }
+}
+
+void grant_configure(void)
+{
+    scheduler.quantum = (int)config_long("IPC_GRANT_QUANTUM_BYTES", GRANT_QUANTUM_BYTES, 1, 65536);
+    long reply_timeout_ms = config_long("IPC_REPLY_TIMEOUT_MS", REPLY_TIMEOUT_MS, 1, 60000);
+
+    scheduler.queue_timeout_ms = config_long("IPC_GRANT_QUEUE_TIMEOUT_MS", GRANT_QUEUE_TIMEOUT_MS, 1, 60000);
+
+    if (scheduler.queue_timeout_ms >= reply_timeout_ms)
+    {
+        long clamped = reply_timeout_ms > 1 ? reply_timeout_ms / 2 : 1;
+
+        fprintf(stderr, "\033[1;31mIPC_GRANT_QUEUE_TIMEOUT_MS (%ld) debe ser menor que IPC_REPLY_TIMEOUT_MS (%ld), se utiliza %ld\033[0m\n", scheduler.queue_timeout_ms, reply_timeout_ms, clamped);
+        scheduler.queue_timeout_ms = clamped;
+    }
+
+    scheduler.idle_reset_ms = config_long("IPC_GRANT_IDLE_RESET_MS", GRANT_IDLE_RESET_MS, 1, 60000);
+}
+
+int grant_enqueue(ChannelType channel_type, pid_t pid, uint32_t vid, int bytes, MsgPriority priority)
+{
+    GrantQueue *queue = &scheduler.channels[channel_type];
+    GrantFlow *flow = find_flow(queue, pid, vid);
+    int64_t now = scheduler_now_ns();
+
+    if (!flow || flow->pending)
+    {
+        queue->rejected++;
+        return 0;
+    }
+
+    if (now - flow->last_ns > scheduler.idle_reset_ms * 1000000LL)
+        flow->deficit = 0;
+
+    flow->weight = get_client_weight(pid);
+    flow->pending = 1;
+    flow->lane = (int)priority - 1;
+    flow->bytes = bytes > 0 ? bytes : 1;
+    flow->enqueued_ns = now;
+    flow->last_ns = now;
+
+    if (flow->deficit >= flow->bytes)
+        push_front(queue, flow->lane, (int)(flow - queue->flows));
+    else
+        push_back(queue, flow->lane, (int)(flow - queue->flows));
+
+    return 1;
+}
+
+GrantStatus grant_next(ChannelType channel_type, GrantRequest* request)
+{
+    GrantQueue *queue = &scheduler.channels[channel_type];
+    int64_t now = scheduler_now_ns();
+
+    for (int attempt = 0; attempt < MQ_LANES; attempt++)
+    {
+        int lane = queue->current;
+
+        if (queue->credit[lane] == 0)
+            queue->credit[lane] = grant_lane_weights[lane];
+
+        if (queue->count[lane] > 0)
+        {
+            GrantStatus status = lane_next(queue, lane, now, request);
+
+            if (status == GRANT_READY && --queue->credit[lane] == 0)
+                queue->current = (lane + 1) % MQ_LANES;
+
+            return status;
+        }
+
+        queue->credit[lane] = 0;
+        queue->current = (lane + 1) % MQ_LANES;
+    }
+
+    return GRANT_EMPTY;
+}
+
+void snapshot_grants(void)
+{
+    memcpy(grant_snapshot.channels, scheduler.channels, sizeof(scheduler.channels));
+
+    grant_snapshot.quantum = scheduler.quantum;
+    grant_snapshot.queue_timeout_ms = scheduler.queue_timeout_ms;
+}
+
+void print_grant_stats(FILE *fp)
+{
+    fprintf(fp, "CONCESIONES    : deficit round-robin, %d bytes por ronda y unidad de peso, espera maxima %ld ms\n", grant_snapshot.quantum, grant_snapshot.queue_timeout_ms);
+
+    for (int channel = 0; channel <= MESSAGE_QUEUE; channel++)
+    {
+        GrantQueue *queue = &grant_snapshot.channels[channel];
+        int clients = 0, listed[GRANT_FLOWS_MAX] = {0};
+        long grants = 0, expired = 0;
+        double share_sum = 0.0, share_squares = 0.0;
+
+        for (int i = 0; i < GRANT_FLOWS_MAX; i++)
+        {
+            GrantFlow *flow = &queue->flows[i];
+
+            if (flow->pid == 0 || (flow->grants == 0 && flow->expired == 0))
+                continue;
+
+            double share = (double)flow->bytes_granted / (double)flow->weight;
+
+            clients++;
+            grants += flow->grants;
+            expired += flow->expired;
+            share_sum += share;
+            share_squares += share * share;
+        }
+
+        if (clients == 0)
+            continue;
+
+        int queued = 0;
+
+        for (int lane = 0; lane < MQ_LANES; lane++)
+            queued += queue->count[lane];
+
+        fprintf(fp, "  %-13s: %d clientes, %ld concesiones, %ld vencidas, %ld rechazadas, %d en cola, equidad %.3f\n", ChannelStringType[channel], clients, grants,
+                expired, queue->rejected, queued, share_squares > 0 ? share_sum * share_sum / ((double)clients * share_squares) : 1.0);
+
+        if (channel == MESSAGE_QUEUE)
+        {
+            for (int lane = 0; lane < MQ_LANES; lane++)
+                fprintf(fp, "    carril %-6s peso %d: %ld concesiones, %d en cola\n", PriorityStringType[lane], grant_lane_weights[lane], queue->lane_grants[lane],
+                        queue->count[lane]);
+        }
+
+        for (int shown = 0; shown < GRANT_STATS_TOP && shown < clients; shown++)
+        {
+            GrantFlow *top = NULL;
+
+            for (int i = 0; i < GRANT_FLOWS_MAX; i++)
+            {
+                GrantFlow *flow = &queue->flows[i];
+
+                if (flow->pid != 0 && !listed[i] && (flow->grants > 0 || flow->expired > 0) && (!top || flow->grants > top->grants))
+                    top = flow;
+            }
+
+            listed[top - queue->flows] = 1;
+
+            fprintf(fp, "    pid %-7d vid %-5u peso %-2d: %ld (%.1f %%), espera avg %.1f us, max %.1f us\n", top->pid, top->vid, top->weight, top->grants,
+                    grants ? 100.0 * (double)top->grants / (double)grants : 0.0, top->grants ? top->wait_sum_us / (double)top->grants : 0.0, top->wait_max_us);
+        }
+    }
+}
@@ -0,0 +1,332 @@
+/**
+ * @file SeqTracker.c
+ * @author Bottini, Franco Nicolas.
+ * @brief Implementacion del seguimiento de numeros de secuencia por cliente del Server IPC.
+ * @version 1.0
+ * @date Marzo de 2023.
+ * 
+ * @copyright Copyright (c) 2023
+ * 
+ */
+
+#include "SeqTracker.h"
+#include "HotRestart.h"
+
+/**
+ * Entrada de la tabla de clientes.
+*/
+typedef struct SeqEntry
+{
+    //PID del cliente (0 si la entrada esta libre).
+    pid_t pid;
+
+    //Identificador del cliente virtual dentro del proceso.
+    uint32_t vid;
+
+    //Proximo numero de secuencia esperado.
+    uint32_t next;
+
+    //Numeros de secuencia del cliente contados como perdidos que no llegaron despues.
+    uint32_t gaps;
+
+    //Mapa de bits de los SEQ_WINDOW numeros anteriores a 'next': el bit i indica si se recibio el numero next - 1 - i.
+    uint64_t window;
+
+    //Mapa de bits con la misma disposicion que 'window': el bit i indica si el numero next - 1 - i se conto como perdido.
+    uint64_t missing;
+
+    //Instante del ultimo mensaje del cliente, en nanosegundos (CLOCK_MONOTONIC_COARSE).
+    int64_t last_ns;
+} SeqEntry;
+
+/**
+ * @struct sequences
+ * 
+ * Estructura que almacena la tabla de clientes y los contadores de entrega de cada canal.
+*/
+struct
+{
+    //Tabla de clientes con direccionamiento abierto y sondeo lineal.
+    SeqEntry table[SEQ_TABLE_SIZE];
+
+    //Cantidad de clientes registrados en la tabla.
+    int clients;
+
+    //Proxima entrada de la tabla a revisar para liberar clientes terminados o inactivos.
+    uint32_t sweep;
+
+    //Entradas liberadas por terminar el proceso del cliente.
+    long exited;
+
+    //Entradas liberadas por inactividad.
+    long idle;
+
+    //Mensajes entregados por canal.
+    long delivered[CHANNEL_COUNT];
+
+    //Mensajes perdidos (huecos en la secuencia) por canal.
+    long lost[CHANNEL_COUNT];
+
+    //Mensajes duplicados por canal.
+    long duplicated[CHANNEL_COUNT];
+
+    //Mensajes recibidos fuera de orden por canal.
+    long reordered[CHANNEL_COUNT];
+
+    //Mensajes de clientes que no entraron en la tabla por estar llena.
+    long untracked;
+} sequences;
+
+/**
+ * @struct sequence_snapshot
+ * 
+ * Estructura que almacena una copia de los contadores de 'sequences', tomada bajo el lock del servidor para imprimirla fuera de el.
+*/
+struct
+{
+    //Cantidad de clientes registrados en la tabla.
+    int clients;
+
+    //Entradas liberadas por terminar el proceso del cliente.
+    long exited;
+
+    //Entradas liberadas por inactividad.
+    long idle;
+
+    //Mensajes entregados por canal.
+    long delivered[CHANNEL_COUNT];
+
+    //Mensajes perdidos (huecos en la secuencia) por canal.
+    long lost[CHANNEL_COUNT];
+
+    //Mensajes duplicados por canal.
+    long duplicated[CHANNEL_COUNT];
+
+    //Mensajes recibidos fuera de orden por canal.
+    long reordered[CHANNEL_COUNT];
+
+    //Mensajes de clientes que no entraron en la tabla por estar llena.
+    long untracked;
+} sequence_snapshot;
+
+//Array auxiliar para obtener un elemento del enumerado 'ChannelType' en formato de cadena.
+extern const char* ChannelStringType[];
+
+/**
+ * @brief Obtiene la posicion inicial de un cliente en la tabla.
+ * 
+ * @param pid PID del cliente.
+ * @param vid Identificador del cliente virtual dentro del proceso.
+ * 
+ * @return Posicion inicial del sondeo lineal.
+*/
+static inline uint32_t sequence_home(pid_t pid, uint32_t vid)
+{
+    return (((uint32_t)pid ^ vid * 0x9E3779B9U) * 2654435761U) & (SEQ_TABLE_SIZE - 1);
+}
+
+/**
+ * @brief Obtiene el instante actual con la resolucion del reloj de baja precision, suficiente para medir inactividad.
+ * 
+ * @return Instante actual en nanosegundos.
+*/
+static int64_t sequence_now_ns(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &now);
+
+    return (int64_t)now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+/**
+ * @brief Libera una entrada de la tabla, desplazando hacia atras las entradas siguientes de la misma secuencia de
+ * sondeo para que ninguna busqueda se corte antes de encontrarlas.
+ * 
+ * @param hole Posicion de la entrada a liberar.
+ * 
+ * @return No devuelve ningun valor.
+*/
+static void remove_sequence_entry(uint32_t hole)
+{
+    for (uint32_t next = (hole + 1) & (SEQ_TABLE_SIZE - 1); sequences.table[next].pid != 0; next = (next + 1) & (SEQ_TABLE_SIZE - 1))
+    {
+        SeqEntry *entry = &sequences.table[next];
+        uint32_t home = sequence_home(entry->pid, entry->vid);
+
+        if (((next - home) & (SEQ_TABLE_SIZE - 1)) < ((next - hole) & (SEQ_TABLE_SIZE - 1)))
+            continue;
+
+        sequences.table[hole] = *entry;
+        hole = next;
+    }
+
+    memset(&sequences.table[hole], 0, sizeof(SeqEntry));
+    sequences.clients--;
+}
+
+/**
+ * @brief Revisa las proximas SEQ_SWEEP_STEP entradas de la tabla y libera las de clientes terminados o inactivos.
+ * 
+ * Solo se consulta si el proceso existe (kill con la señal 0) para los clientes sin mensajes durante SEQ_IDLE_CHECK_MS.
+ * 
+ * @param now Instante actual en nanosegundos.
+ * 
+ * @return No devuelve ningun valor.
+*/
+static void sweep_sequences(int64_t now)
+{
+    for (int i = 0; i < SEQ_SWEEP_STEP; i++)
+    {
+        SeqEntry *entry = &sequences.table[sequences.sweep];
+        int64_t idle_ns = now - entry->last_ns;
+
+        if (entry->pid != 0 && idle_ns > SEQ_EVICT_MS * 1000000LL)
+        {
+            remove_sequence_entry(sequences.sweep);
+            sequences.idle++;
+            continue;
+        }
+
+        if (entry->pid != 0 && idle_ns > SEQ_IDLE_CHECK_MS * 1000000LL && kill(entry->pid, 0) == -1 && errno == ESRCH)
+        {
+            remove_sequence_entry(sequences.sweep);
+            sequences.exited++;
+            continue;
+        }
+
+        sequences.sweep = (sequences.sweep + 1) & (SEQ_TABLE_SIZE - 1);
+    }
+}
+
+/**
+ * @brief Busca (o crea) la entrada de un cliente en la tabla.
+ * 
+ * @param pid PID del cliente.
+ * @param vid Identificador del cliente virtual dentro del proceso.
+ * @param created Se pone en 1 si la entrada se creo en esta llamada.
+ * 
+ * @return Puntero a la entrada del cliente o NULL si la tabla esta llena.
+*/
+static SeqEntry* find_sequence_entry(pid_t pid, uint32_t vid, int* created)
+{
+    uint32_t index = sequence_home(pid, vid);
+
+    *created = 0;
+
+    for (int i = 0; i < SEQ_TABLE_SIZE; i++)
+    {
+        SeqEntry *entry = &sequences.table[(index + (uint32_t)i) & (SEQ_TABLE_SIZE - 1)];
+
+        if (entry->pid == pid && entry->vid == vid)
+            return entry;
+
+        if (entry->pid == 0)
+        {
+            *entry = (SeqEntry) { .pid = pid, .vid = vid };
+            sequences.clients++;
+            *created = 1;
+
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+void track_sequence(ChannelType channel_type, const MsgHeader* header)
+{
+    int created;
+
+    if (header->pid <= 0 || channel_type >= CHANNEL_COUNT)
+        return;
+
+    int64_t now = sequence_now_ns();
+
+    sweep_sequences(now);
+
+    SeqEntry *entry = find_sequence_entry(header->pid, header->vid, &created);
+
+    if (!entry)
+    {
+        sequences.untracked++;
+        return;
+    }
+
+    entry->last_ns = now;
+
+    if (created || header->seq >= entry->next)
+    {
+        uint32_t skipped = created ? 0 : header->seq - entry->next;
+
+        sequences.lost[channel_type] += skipped;
+        sequences.delivered[channel_type]++;
+
+        entry->gaps += skipped;
+        entry->window = skipped + 1 >= SEQ_WINDOW ? 0 : entry->window << (skipped + 1);
+        entry->window |= 1;
+        entry->missing = skipped + 1 >= SEQ_WINDOW ? 0 : entry->missing << (skipped + 1);
+        entry->missing |= (skipped + 1 >= SEQ_WINDOW ? ~(uint64_t)0 : ((uint64_t)1 << (skipped + 1)) - 1) & ~(uint64_t)1;
+        entry->next = header->seq + 1;
+    }
+    else
+    {
+        uint32_t distance = entry->next - 1 - header->seq;
+        uint64_t bit = distance < SEQ_WINDOW ? (uint64_t)1 << distance : 0;
+
+        if (bit && (entry->window & bit))
+            sequences.duplicated[channel_type]++;
+        else
+        {
+            sequences.delivered[channel_type]++;
+            sequences.reordered[channel_type]++;
+
+            if ((entry->missing & bit) && entry->gaps > 0 && sequences.lost[channel_type] > 0)
+            {
+                sequences.lost[channel_type]--;
+                entry->gaps--;
+            }
+
+            entry->window |= bit;
+            entry->missing &= ~bit;
+        }
+    }
+}
+
+void snapshot_sequences(void)
+{
+    sequence_snapshot.clients = sequences.clients;
+    sequence_snapshot.exited = sequences.exited;
+    sequence_snapshot.idle = sequences.idle;
+    sequence_snapshot.untracked = sequences.untracked;
+
+    memcpy(sequence_snapshot.delivered, sequences.delivered, sizeof(sequences.delivered));
+    memcpy(sequence_snapshot.lost, sequences.lost, sizeof(sequences.lost));
+    memcpy(sequence_snapshot.duplicated, sequences.duplicated, sizeof(sequences.duplicated));
+    memcpy(sequence_snapshot.reordered, sequences.reordered, sizeof(sequences.reordered));
+}
+
+void print_sequence_stats(FILE *fp)
+{
+    fprintf(fp, "SECUENCIAS     : %d clientes (%ld mensajes sin seguimiento, %ld liberados por salida y %ld por inactividad)\n", sequence_snapshot.clients,
+            sequence_snapshot.untracked, sequence_snapshot.exited, sequence_snapshot.idle);
+
+    for (int i = 0; i < CHANNEL_COUNT; i++)
+    {
+        long offered = sequence_snapshot.delivered[i] + sequence_snapshot.lost[i];
+
+        fprintf(fp, "  %-13s: %ld/%ld entregados (%.2f %%), %ld perdidos, %ld duplicados, %ld reordenados\n", ChannelStringType[i],
+                sequence_snapshot.delivered[i], offered, offered ? (double)sequence_snapshot.delivered[i] / (double)offered * 100.0 : 100.0,
+                sequence_snapshot.lost[i], sequence_snapshot.duplicated[i], sequence_snapshot.reordered[i]);
+    }
+}
+
+void save_sequences(void)
+{
+    restart_save(RESTART_SEQUENCES, &sequences, sizeof(sequences));
+}
+
+void restore_sequences(void)
+{
+    restart_load(RESTART_SEQUENCES, &sequences, sizeof(sequences));
+}
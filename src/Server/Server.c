@@ -11,6 +11,9 @@
 
 #include "Server.h"
 
+//Cantidad por defecto de mensajes que el hilo puente retiene por carril de la cola de mensajes a la espera del despachador (IPC_MQ_BRIDGE_DEPTH, potencia de 2).
+#define MQ_BRIDGE_DEPTH 64
+
 /**
  * @struct fifo
  * 
@@ -18,11 +21,20 @@
  */
 struct
 {
-    // File descriptor del archivo FIFO.
+    // File descriptor del archivo FIFO (lectura no bloqueante).
     int fd;
 
-    //Buffer para leer datos del archivo FIFO.
-    char buffer[MSG_MAX_SIZE];
+    //Extremo de escritura propio, que evita que la FIFO quede sin escritores y epoll informe fin de archivo continuamente.
+    int keepalive;
+
+    //Bytes leidos de la FIFO que todavia no forman un mensaje completo.
+    char stream[2 * sizeof(Message)];
+
+    //Cantidad de bytes validos en 'stream'.
+    size_t used;
+
+    //Buffers de los mensajes del lote en construccion.
+    Message buffer[DISPATCH_BUDGET];
 } fifo;
 
 
@@ -37,7 +49,10 @@ struct
     int shmid;
 
     //Puntero al segmento de memoria compartida.
-    char *shm_ptr;
+    Message *shm_ptr;
+
+    //Timbre (eventfd) que indica al despachador que el slot tiene un mensaje para leer.
+    int doorbell;
 } shm;
 
 /**
@@ -50,193 +65,926 @@ struct
     //Identificador de la cola de mensajes.
     int id;
 
-    //Elemento de cola de mensajes que almacena el mensaje actual.
-    MsgQueueElemnet buffer;
+    //Timbre (eventfd) con el que el hilo puente avisa al despachador que hay mensajes en los carriles.
+    int doorbell;
+
+    //Hilo puente que se bloquea en msgrcv y traslada los mensajes a los carriles.
+    pthread_t bridge;
+
+    //Indica al hilo puente que debe terminar.
+    atomic_int stop;
+
+    //Indica al hilo puente que debe terminar al recibir el mensaje centinela de una entrega en caliente.
+    atomic_int handoff;
+
+    //1 cuando el hilo puente termino.
+    atomic_int done;
+
+    //Mensajes recibidos por el hilo puente, por carril de prioridad.
+    MsgQueueElemnet *lanes[MQ_LANES];
+
+    //Capacidad de cada carril (potencia de 2).
+    unsigned int depth;
+
+    //Proxima posicion a escribir de cada carril (la escribe el hilo puente).
+    atomic_uint head[MQ_LANES];
+
+    //Proxima posicion a liberar de cada carril (la escribe el despachador al liberar la vista).
+    atomic_uint tail[MQ_LANES];
+
+    //Proxima posicion a entregar de cada carril (solo la utiliza el despachador).
+    unsigned int next[MQ_LANES];
 } msgqueue;
 
-void signal_handler(int sig, siginfo_t *info, void* context)
+/**
+ * @struct wrr
+ * 
+ * Estado del round-robin ponderado utilizado para drenar los carriles de prioridad de la cola de mensajes.
+ */
+struct
 {
-    UNUSED(context);
+    //Carril que se esta atendiendo actualmente (indice 0..MQ_LANES-1).
+    int current;
 
-    if (sig == SIGUSR1)
-    {
-        ChannelType channel_type = (ChannelType)info->si_value.sival_int & 3;
-        USRSignalType signal_type = (USRSignalType)(info->si_value.sival_int & ~3) >> 2;
+    //Mensajes que le restan al carril actual antes de ceder el turno.
+    int credit[MQ_LANES];
+} wrr;
+
+/**
+ * @struct handshake
+ * 
+ * Progreso de la escritura en curso de cada canal con handshake. El canal se libera cuando se recibieron tanto la señal
+ * END_WRITE como el mensaje, que llegan por fuentes distintas y en cualquier orden.
+ */
+struct
+{
+    //1 si se recibio la señal END_WRITE de la escritura en curso.
+    int end;
+
+    //1 si se recibio el mensaje de la escritura en curso.
+    int data;
+} handshake[MESSAGE_QUEUE + 1];
+
+/**
+ * @struct sources
+ * 
+ * Fuentes de eventos que el servidor registra en el despachador.
+ */
+struct
+{
+    //Señales de control (signalfd).
+    DispatchSource control;
+
+    //FIFO.
+    DispatchSource fifo;
+
+    //Timbre de la memoria compartida.
+    DispatchSource shm;
+
+    //Timbre de la cola de mensajes.
+    DispatchSource msgqueue;
+
+    //Timers de timeout de cada canal con handshake.
+    DispatchSource timers[MESSAGE_QUEUE + 1];
+
+    //Timer de reintento de las respuestas que desbordaron la cola de señales de un cliente.
+    DispatchSource replies;
+} sources;
+
+//Peso de cada carril de prioridad (URGENT, NORMAL, BULK) en el round-robin ponderado.
+static const int mq_lane_weights[MQ_LANES] = MQ_LANE_WEIGHTS;
+
+//Nombre de la fuente de timeout de cada canal con handshake.
+static const char* timer_source_names[MESSAGE_QUEUE + 1] = { "timeout FIFO", "timeout SHM", "timeout MQ" };
+
+/**
+ * @brief Otorga un canal libre a la proxima solicitud de su cola de reparto.
+ * 
+ * Las solicitudes vencidas se responden WAIT y las de procesos que ya no existen se descartan, devolviendo sus creditos,
+ * hasta encontrar una solicitud a la que otorgar el canal o vaciar la cola. Durante una entrega en caliente no se otorga
+ * el canal: todas las solicitudes se responden WAIT, y el despachador se detiene cuando ningun canal queda ocupado.
+ * 
+ * @param channel_type Canal a otorgar.
+ * 
+ * @return No devuelve ningun valor.
+ */
+static void grant_channel(ChannelType channel_type)
+{
+    GrantRequest request;
+    GrantStatus status;
 
-        if (signal_type == END_WRITE)
+    while (!is_lock_channel(channel_type) && (status = grant_next(channel_type, &request)) != GRANT_EMPTY)
+    {
+        if (status != GRANT_READY || hot_restart_handing_off())
         {
-            if(is_lock_channel(channel_type))
+            release_credits(request.pid, request.bytes);
+
+            if (status != GRANT_GONE)
             {
-                recibe_msg(channel_type);
-                change_channel_state(channel_type, UNLOCK, info->si_pid);
-                change_timer_state(channel_type, STOP);
+                trace_event(TRACE_WAIT, channel_type, request.pid, request.vid, 0);
+                reply_client(request.pid, request.vid, channel_type, WAIT);
             }
+
+            continue;
+        }
+
+        handshake[channel_type].end = 0;
+        handshake[channel_type].data = 0;
+        change_channel_state(channel_type, LOCK, request.pid);
+        lease_credits(channel_type, request.pid, request.bytes);
+        change_timer_state(channel_type, START);
+
+        trace_event(TRACE_GRANT, channel_type, request.pid, request.vid, 0);
+
+        reply_client(request.pid, request.vid, channel_type, START_WRITE);
+    }
+
+    if (hot_restart_handing_off() && !is_lock_channel(FIFO) && !is_lock_channel(SHARED_MEMORY) && !is_lock_channel(MESSAGE_QUEUE))
+        dispatcher_stop();
+}
+
+/**
+ * @brief Libera el canal tras completar la escritura en curso.
+ * 
+ * @param channel_type Canal a liberar.
+ * 
+ * @return No devuelve ningun valor.
+ */
+static void finish_write(ChannelType channel_type)
+{
+    trace_event(TRACE_RELEASE, channel_type, get_pid(channel_type), 0, 0);
+
+    release_lease(channel_type, 0);
+    change_channel_state(channel_type, UNLOCK, get_pid(channel_type));
+    change_timer_state(channel_type, STOP);
+
+    handshake[channel_type].end = 0;
+    handshake[channel_type].data = 0;
+
+    grant_channel(channel_type);
+}
+
+/**
+ * @brief Registra el avance de la escritura en curso de un canal y lo libera cuando esta completa.
+ * 
+ * @param channel_type Canal de la escritura.
+ * @param end 1 si se recibio END_WRITE. 0 si se recibio el mensaje.
+ * 
+ * @return No devuelve ningun valor.
+ */
+static void write_progress(ChannelType channel_type, int end)
+{
+    if (!is_lock_channel(channel_type))
+        return;
+
+    if (end)
+        handshake[channel_type].end = 1;
+    else
+        handshake[channel_type].data = 1;
+
+    if (handshake[channel_type].end && handshake[channel_type].data)
+        finish_write(channel_type);
+}
+
+/**
+ * @brief Entrega al pipeline un lote recibido por un canal con handshake y registra el avance de su escritura.
+ * 
+ * @param channel_type Canal del lote.
+ * @param batch Lote a entregar (puede estar vacio).
+ * 
+ * @return No devuelve ningun valor.
+ */
+static void deliver_batch(ChannelType channel_type, MsgBatch* batch)
+{
+    if (batch->count == 0)
+        return;
+
+    server_lock();
+
+    pipeline_run(batch);
+    write_progress(channel_type, 0);
+
+    server_unlock();
+}
+
+/**
+ * @brief Vuelve a leer el archivo de configuracion y aplica los parametros que admiten recarga a cada modulo.
+ * 
+ * @return No devuelve ningun valor.
+ */
+static void reload_config(void)
+{
+    fprintf(stdout, "\n\033[1;34mSIGHUP: recargando la configuracion\033[0m\n");
+    fflush(stdout);
+
+    if (config_reload() == 0)
+        return;
+
+    timers_configure();
+    dispatcher_configure();
+    grant_configure();
+    pipeline_configure();
+    journal_configure();
+    dashboard_configure();
+    shm_ring_configure();
+    mapped_file_configure();
+}
+
+void handle_control_signal(const struct signalfd_siginfo* info)
+{
+    int sig = (int)info->ssi_signo;
+    pid_t pid = (pid_t)info->ssi_pid;
+
+    if (sig == SIGNAL_START_WRITE || sig == SIGNAL_END_WRITE)
+    {
+        ChannelType channel_type = (ChannelType)(info->ssi_int & 3);
+        int bytes = info->ssi_int >> CONTROL_BYTES_SHIFT & CONTROL_BYTES_MASK;
+        uint32_t vid = (uint32_t)info->ssi_int >> CONTROL_VID_SHIFT & CONTROL_VID_MASK;
+
+        if (channel_type > MESSAGE_QUEUE)
+            return;
+
+        if (sig == SIGNAL_END_WRITE)
+        {
+            trace_event(TRACE_END_WRITE, channel_type, pid, 0, 0);
+
+            if (channel_type == SHARED_MEMORY && is_lock_channel(channel_type))
+                eventfd_write(shm.doorbell, 1);
+
+            write_progress(channel_type, 1);
         }
-        else if (signal_type == START_WRITE)
+        else
         {
-            USRSignalType response;
+            int priority = info->ssi_int >> CONTROL_PRIORITY_SHIFT & CONTROL_PRIORITY_MASK;
+
+            if (channel_type != MESSAGE_QUEUE || priority < PRIORITY_URGENT)
+                priority = PRIORITY_NORMAL;
 
-            if(is_lock_channel(channel_type))
-                response = WAIT;
-            else
+            if (!grant_enqueue(channel_type, pid, vid, bytes, (MsgPriority)priority))
             {
-                response = START_WRITE;
-                change_channel_state(channel_type, LOCK, info->si_pid);
-                change_timer_state(channel_type, START);
+                release_credits(pid, bytes);
+
+                trace_event(TRACE_WAIT, channel_type, pid, vid, 0);
+
+                reply_client(pid, vid, channel_type, WAIT);
             }
 
-            sigqueue(info->si_pid, SIGUSR1, (union sigval) { .sival_int = (int)response });
+            grant_channel(channel_type);
         }
     }
-    else if (sig == SIGRTMIN)
+    else if (sig == SIGNAL_HANDOFF)
+    {
+        if (!hot_restart_request(pid))
+            return;
+
+        fprintf(stdout, "\n\033[1;34mReinicio en caliente: entregando los recursos al servidor %d\033[0m\n", pid);
+
+        for (int channel = 0; channel <= MESSAGE_QUEUE; channel++)
+            grant_channel((ChannelType)channel);
+    }
+    else if (sig == SIGHUP)
+        reload_config();
+    else if(sig == SIGTERM || sig == SIGINT)
+        dispatcher_stop();
+}
+
+/**
+ * @brief Atiende las señales de control pendientes, leyendolas del signalfd en un unico read.
+ * 
+ * @param source Fuente de las señales de control.
+ * @param budget Cantidad maxima de señales a atender.
+ * 
+ * @return Cantidad de señales atendidas.
+ */
+static int control_drain(DispatchSource* source, int budget)
+{
+    struct signalfd_siginfo info[DISPATCH_BUDGET];
+    ProfileSample sample;
+
+    profile_begin(&sample);
+
+    ssize_t bytes = read(source->fd, info, sizeof(info[0]) * (size_t)budget);
+
+    if (bytes <= 0)
+        return 0;
+
+    int count = (int)((size_t)bytes / sizeof(info[0]));
+
+    server_lock();
+
+    for (int i = 0; i < count; i++)
+        handle_control_signal(&info[i]);
+
+    server_unlock();
+
+    profile_end(PROFILE_CONTROL, &sample, count);
+
+    return count;
+}
+
+/**
+ * @brief Atiende el vencimiento del timer de reintento de respuestas.
+ * 
+ * @param source Fuente del timer.
+ * @param budget Cantidad maxima de eventos a atender.
+ * 
+ * @return Cantidad de eventos atendidos.
+*/
+static int reply_retry_drain(DispatchSource* source, int budget)
+{
+    uint64_t expirations;
+
+    UNUSED(budget);
+
+    if (read(source->fd, &expirations, sizeof(expirations)) != sizeof(expirations))
+        return 0;
+
+    server_lock();
+    retry_replies();
+    server_unlock();
+
+    return 1;
+}
+
+/**
+ * @brief Atiende el vencimiento del timer de timeout de un canal.
+ * 
+ * @param source Fuente del timer (su contexto es el canal).
+ * @param budget Cantidad maxima de eventos a atender.
+ * 
+ * @return Cantidad de vencimientos atendidos (0 o 1).
+ */
+static int timer_drain(DispatchSource* source, int budget)
+{
+    ChannelType channel_type = (ChannelType)source->context;
+    uint64_t expirations;
+
+    UNUSED(budget);
+
+    if (read(source->fd, &expirations, sizeof(expirations)) != sizeof(expirations))
+        return 0;
+
+    server_lock();
+
+    if (is_lock_channel(channel_type))
     {
-        ChannelType channel_type = get_timer_type(*(timer_t*)info->si_value.sival_ptr);
         pid_t pid = get_pid(channel_type);
 
-        refresh_stats(channel_type, NULL, 1);
+        trace_event(TRACE_TIMEOUT, channel_type, pid, 0, 0);
+
+        refresh_stats(channel_type, pid, NULL, 1);
+
+        release_lease(channel_type, 1);
 
         change_channel_state(channel_type, UNLOCK, pid);
 
         change_timer_state(channel_type, STOP);
+
+        handshake[channel_type].end = 0;
+        handshake[channel_type].data = 0;
+
+        grant_channel(channel_type);
     }
-    else if(sig == SIGTERM || sig == SIGINT || sig == SIGHUP)
-        end_server();
+
+    server_unlock();
+
+    return 1;
 }
 
-void signal_handler_init(void)
+/**
+ * @brief Extrae de los bytes leidos de la FIFO el proximo mensaje completo.
+ * 
+ * Un mensaje es una cabecera seguida de una cadena terminada en nulo. Si los bytes acumulados no pueden formar un mensaje
+ * valido se descartan.
+ * 
+ * @param message Buffer donde se copia el mensaje.
+ * 
+ * @return 1 si se extrajo un mensaje. 0 si todavia no hay un mensaje completo.
+ */
+static int fifo_next_message(Message* message)
 {
-    struct sigaction sa = 
+    if (fifo.used <= sizeof(MsgHeader))
+        return 0;
+
+    const char* end = memchr(fifo.stream + sizeof(MsgHeader), '\0', fifo.used - sizeof(MsgHeader));
+
+    if (!end)
     {
-        .sa_sigaction = signal_handler,
-        .sa_flags = SA_SIGINFO
-    };
-    sigemptyset(&sa.sa_mask);
-    
-    sigaction(SIGUSR1, &sa, NULL);
-    sigaction(SIGRTMIN, &sa, NULL);
-    sigaction(SIGTERM, &sa, NULL);
-    sigaction(SIGINT, &sa, NULL);
-    sigaction(SIGHUP, &sa, NULL);
+        if (fifo.used - sizeof(MsgHeader) >= MSG_MAX_SIZE)
+            fifo.used = 0;
+
+        return 0;
+    }
+
+    size_t size = (size_t)(end - fifo.stream) + 1;
+
+    memcpy(message, fifo.stream, size);
+
+    fifo.used -= size;
+
+    memmove(fifo.stream, fifo.stream + size, fifo.used);
+
+    return 1;
+}
+
+/**
+ * @brief Lee los mensajes disponibles en la FIFO y los entrega al pipeline como un unico lote.
+ * 
+ * @param source Fuente de la FIFO.
+ * @param budget Cantidad maxima de mensajes a leer.
+ * 
+ * @return Cantidad de mensajes entregados.
+ */
+static int fifo_drain(DispatchSource* source, int budget)
+{
+    MsgBatch batch = { .count = 0 };
+    ProfileSample sample;
+
+    profile_begin(&sample);
+
+    while (batch.count < budget)
+    {
+        Message* message = &fifo.buffer[batch.count];
+
+        if (!fifo_next_message(message))
+        {
+            ssize_t bytes = read(source->fd, fifo.stream + fifo.used, sizeof(fifo.stream) - fifo.used);
+
+            if (bytes <= 0)
+                break;
+
+            fifo.used += (size_t)bytes;
+
+            continue;
+        }
+
+        batch.views[batch.count++] = (MsgView)
+        {
+            .channel = FIFO,
+            .header = &message->header,
+            .msg = message->msg,
+            .len = strnlen(message->msg, MSG_MAX_SIZE)
+        };
+    }
+
+    profile_end(PROFILE_RECEIVE, &sample, batch.count);
+
+    deliver_batch(FIFO, &batch);
+
+    return batch.count;
+}
+
+/**
+ * @brief Lee el slot de memoria compartida cuando suena su timbre.
+ * 
+ * El timbre lo toca el despachador al recibir END_WRITE: los clientes de otros procesos no comparten el eventfd, pero
+ * de esta forma la lectura del slot se atiende por turno como la de los demas canales.
+ * 
+ * @param source Fuente del timbre de la memoria compartida.
+ * @param budget Cantidad maxima de mensajes a leer.
+ * 
+ * @return Cantidad de mensajes entregados (0 o 1).
+ */
+static int shared_memory_drain(DispatchSource* source, int budget)
+{
+    MsgBatch batch = { .count = 0 };
+    ProfileSample sample;
+    eventfd_t rings;
+
+    UNUSED(budget);
+
+    profile_begin(&sample);
+
+    if (eventfd_read(source->fd, &rings) == -1)
+        return 0;
+
+    if (__atomic_load_n(&shm.shm_ptr->header.pid, __ATOMIC_ACQUIRE) != 0)
+    {
+        batch.views[batch.count++] = (MsgView)
+        {
+            .channel = SHARED_MEMORY,
+            .header = &shm.shm_ptr->header,
+            .msg = shm.shm_ptr->msg,
+            .len = strnlen(shm.shm_ptr->msg, MSG_MAX_SIZE),
+            .release = release_shared_memory_view
+        };
+    }
+
+    profile_end(PROFILE_RECEIVE, &sample, batch.count);
+
+    server_lock();
+
+    if (batch.count)
+        pipeline_run(&batch);
+
+    write_progress(SHARED_MEMORY, 0);
+
+    server_unlock();
+
+    return batch.count;
+}
+
+/**
+ * @brief Entrega al pipeline los mensajes que el hilo puente dejo en los carriles de la cola de mensajes.
+ * 
+ * @param source Fuente del timbre de la cola de mensajes.
+ * @param budget Cantidad maxima de mensajes a entregar.
+ * 
+ * @return Cantidad de mensajes entregados.
+ */
+static int message_queue_drain(DispatchSource* source, int budget)
+{
+    MsgBatch batch = { .count = 0 };
+    const MsgQueueElemnet* element;
+    ProfileSample sample;
+    eventfd_t rings;
+
+    profile_begin(&sample);
+
+    eventfd_read(source->fd, &rings);
+
+    while (batch.count < budget && (element = message_queue_receive()) != NULL)
+    {
+        batch.views[batch.count++] = (MsgView)
+        {
+            .channel = MESSAGE_QUEUE,
+            .priority = (int)element->type,
+            .header = &element->header,
+            .msg = element->msg,
+            .len = strnlen(element->msg, MSG_MAX_SIZE),
+            .release = release_message_queue_view
+        };
+    }
+
+    profile_end(PROFILE_RECEIVE, &sample, batch.count);
+
+    deliver_batch(MESSAGE_QUEUE, &batch);
+
+    return batch.count;
+}
+
+/**
+ * @brief Hilo puente de la cola de mensajes.
+ * 
+ * Las colas SysV no tienen un file descriptor que epoll pueda esperar, por lo que este hilo se bloquea en msgrcv,
+ * copia cada mensaje al carril de su prioridad y toca el timbre del despachador.
+ * 
+ * @param arg No se utiliza.
+ * 
+ * @return Siempre NULL.
+ */
+static void* message_queue_bridge(void* arg)
+{
+    MsgQueueElemnet element;
+    size_t size = sizeof(element) - sizeof(element.type);
+    struct timespec full = {0, 50000};
+
+    UNUSED(arg);
+
+    while (!atomic_load(&msgqueue.stop))
+    {
+        if (msgrcv(msgqueue.id, &element, size, -MQ_LANES, 0) == -1)
+        {
+            if (errno == EINTR)
+                continue;
+
+            break;
+        }
+
+        if (element.header.pid == 0 && atomic_load(&msgqueue.handoff))
+            break;
+
+        int lane = (int)element.type - 1;
+        unsigned int head = atomic_load_explicit(&msgqueue.head[lane], memory_order_relaxed);
+
+        while (head - atomic_load_explicit(&msgqueue.tail[lane], memory_order_acquire) >= msgqueue.depth && !atomic_load(&msgqueue.stop))
+            nanosleep(&full, NULL);
+
+        msgqueue.lanes[lane][head & (msgqueue.depth - 1)] = element;
+
+        atomic_store_explicit(&msgqueue.head[lane], head + 1, memory_order_release);
+
+        eventfd_write(msgqueue.doorbell, 1);
+    }
+
+    atomic_store(&msgqueue.done, 1);
+
+    return NULL;
+}
+
+/**
+ * @brief Registra una fuente de eventos del servidor en el despachador.
+ * 
+ * @param source Fuente a registrar.
+ * @param name Nombre de la fuente.
+ * @param fd File descriptor de la fuente.
+ * @param drain Funcion que atiende los eventos de la fuente.
+ * @param context Dato propio de la fuente.
+ * 
+ * @return No devuelve ningun valor.
+ */
+static void register_source(DispatchSource* source, const char* name, int fd, int (*drain)(DispatchSource*, int), long context)
+{
+    *source = (DispatchSource) { .name = name, .fd = fd, .drain = drain, .context = context };
+
+    dispatcher_register(source);
+}
+
+void control_signals_init(void)
+{
+    sigset_t set;
+
+    sigemptyset(&set);
+    sigaddset(&set, SIGNAL_START_WRITE);
+    sigaddset(&set, SIGNAL_END_WRITE);
+    sigaddset(&set, SIGTERM);
+    sigaddset(&set, SIGINT);
+    sigaddset(&set, SIGHUP);
+    sigaddset(&set, SIGNAL_HANDOFF);
+
+    sigprocmask(SIG_BLOCK, &set, NULL);
+
+    if ((sources.control.fd = signalfd(-1, &set, SFD_NONBLOCK | SFD_CLOEXEC)) == -1)
+    {
+        fprintf(stderr, "\033[1;31mFallo la creacion del signalfd de control: %s\033[0m\n", strerror(errno));
+        exit(EXIT_FAILURE);
+    }
 }
 
 void create_fifo(void)
 {
-    if (mkfifo(FIFO_NAME, 0666) == -1)
+    if (mkfifo(config_fifo_name(), 0666) == -1 && !(errno == EEXIST && hot_restart_adopting()))
     {
         fprintf(stderr, "\033[1;31mFallo la creacion de la FIFO: %s\033[0m\n", strerror(errno));
         exit(EXIT_FAILURE);
     }
+
+    if ((fifo.fd = open(config_fifo_name(), O_RDONLY | O_NONBLOCK | O_CLOEXEC)) == -1 || (fifo.keepalive = open(config_fifo_name(), O_WRONLY | O_NONBLOCK | O_CLOEXEC)) == -1)
+    {
+        fprintf(stderr, "\033[1;31mFallo la apertura de la FIFO: %s\033[0m\n", strerror(errno));
+        exit(EXIT_FAILURE);
+    }
 }
 
 void create_shared_memory_segment(void)
 {
-    key_t key = ftok("Server.c", 'B');
+    key_t key = config_ipc_key();
 
-    if ((shm.shmid = shmget(key, MSG_MAX_SIZE, IPC_CREAT | 0666)) == -1)
+    if ((shm.shm_ptr = shm_segment_create("MENSAJE", key, sizeof(Message), placement_cpu(THREAD_RECEIVE), &shm.shmid)) == NULL)
     {
         fprintf(stderr, "\033[1;31mFallo la creacion del segmento de memoria compartida: %s\033[0m\n", strerror(errno));
         exit(EXIT_FAILURE);
     }
 
-    if ((shm.shm_ptr = shmat(shm.shmid, NULL, 0)) == (char *) -1)
+    if ((shm.doorbell = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) == -1)
     {
-        fprintf(stderr, "\033[1;31mNo se pudo agregar el espacio de memoria compartido al espacio del proceso: %s\033[0m\n", strerror(errno));
+        fprintf(stderr, "\033[1;31mFallo la creacion del timbre de la memoria compartida: %s\033[0m\n", strerror(errno));
         exit(EXIT_FAILURE);
     }
 }
 
 void create_message_queue(void)
 {
-    key_t key = ftok("Server.c", 'B');
+    key_t key = config_ipc_key();
+    sigset_t all, previous;
 
     if ((msgqueue.id = msgget(key, IPC_CREAT | 0666)) == -1)
     {
         fprintf(stderr, "\033[1;31mFallo la creacion de la cola de mensajes: %s\033[0m\n", strerror(errno));
         exit(EXIT_FAILURE);
     }
+
+    if ((msgqueue.doorbell = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) == -1)
+    {
+        fprintf(stderr, "\033[1;31mFallo la creacion del timbre de la cola de mensajes: %s\033[0m\n", strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+
+    msgqueue.depth = (unsigned int)config_pow2("IPC_MQ_BRIDGE_DEPTH", MQ_BRIDGE_DEPTH, 4, 4096);
+
+    for (int lane = 0; lane < MQ_LANES; lane++)
+    {
+        if ((msgqueue.lanes[lane] = calloc(msgqueue.depth, sizeof(MsgQueueElemnet))) == NULL)
+        {
+            fprintf(stderr, "\033[1;31mNo se pudieron reservar los carriles de la cola de mensajes\033[0m\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    sigfillset(&all);
+    pthread_sigmask(SIG_BLOCK, &all, &previous);
+
+    if (pthread_create(&msgqueue.bridge, NULL, message_queue_bridge, NULL) != 0)
+    {
+        fprintf(stderr, "\033[1;31mNo se pudo iniciar el hilo puente de la cola de mensajes\033[0m\n");
+        exit(EXIT_FAILURE);
+    }
+
+    placement_thread(msgqueue.bridge, THREAD_RECEIVE, "puente MQ");
+
+    pthread_sigmask(SIG_SETMASK, &previous, NULL);
 }
 
-void recibe_msg(ChannelType channel_type)
+void register_sources(void)
 {
-    switch (channel_type)
+    register_source(&sources.control, "control", sources.control.fd, control_drain, 0);
+    register_source(&sources.fifo, "FIFO", fifo.fd, fifo_drain, FIFO);
+    register_source(&sources.shm, "SHARED MEMORY", shm.doorbell, shared_memory_drain, SHARED_MEMORY);
+    register_source(&sources.msgqueue, "MESSAGE QUEUE", msgqueue.doorbell, message_queue_drain, MESSAGE_QUEUE);
+
+    for (int i = 0; i <= MESSAGE_QUEUE; i++)
+        register_source(&sources.timers[i], timer_source_names[i], get_timer_fd((ChannelType)i), timer_drain, i);
+
+    register_source(&sources.replies, "reintentos", get_reply_retry_fd(), reply_retry_drain, 0);
+}
+
+const MsgQueueElemnet* message_queue_receive(void)
+{
+    for (int attempt = 0; attempt < MQ_LANES; attempt++)
     {
-        case FIFO:        
-            fifo.fd = open(FIFO_NAME, O_RDONLY);
+        int lane = wrr.current;
 
-            read(fifo.fd, fifo.buffer, MSG_MAX_SIZE);
+        if (wrr.credit[lane] == 0)
+            wrr.credit[lane] = mq_lane_weights[lane];
 
-            close(fifo.fd);
-            
-            refresh_stats(channel_type, fifo.buffer, 0);
+        if (msgqueue.next[lane] != atomic_load_explicit(&msgqueue.head[lane], memory_order_acquire))
+        {
+            if (--wrr.credit[lane] == 0)
+                wrr.current = (lane + 1) % MQ_LANES;
 
-            break;
+            return &msgqueue.lanes[lane][msgqueue.next[lane]++ & (msgqueue.depth - 1)];
+        }
 
-        case SHARED_MEMORY:
-            refresh_stats(channel_type, shm.shm_ptr, 0);
-            
-            memset(shm.shm_ptr, 0, MSG_MAX_SIZE);
+        wrr.credit[lane] = 0;
+        wrr.current = (lane + 1) % MQ_LANES;
+    }
 
-            break;
+    return NULL;
+}
 
-        case MESSAGE_QUEUE:;
-            msgrcv(msgqueue.id, &msgqueue.buffer, sizeof(msgqueue.buffer), 1, 0);
+void release_message_queue_view(const MsgView* view)
+{
+    atomic_fetch_add_explicit(&msgqueue.tail[view->priority - 1], 1, memory_order_release);
+}
 
-            refresh_stats(channel_type, msgqueue.buffer.msg, 0);
+void release_shared_memory_view(const MsgView* view)
+{
+    UNUSED(view);
 
-            break;
+    __atomic_store_n(&shm.shm_ptr->header.pid, 0, __ATOMIC_RELEASE);
+}
 
-        default:
-            break;
+/**
+ * @brief Detiene el hilo puente de la cola de mensajes sin eliminar la cola, entregando al pipeline los mensajes que ya retiro.
+ * 
+ * El hilo puente termina al recibir un mensaje centinela (PID 0) con la maxima prioridad; los mensajes que quedan en la
+ * cola los recibe el servidor que continua.
+ * 
+ * @return No devuelve ningun valor.
+ */
+static void message_queue_handoff(void)
+{
+    MsgQueueElemnet sentinel = { .type = PRIORITY_URGENT };
+    size_t size = sizeof(sentinel.header) + 1;
+    struct timespec poll_time = {0, 100000};
+    int sent = 0;
+
+    atomic_store(&msgqueue.handoff, 1);
+
+    while (!atomic_load(&msgqueue.done))
+    {
+        if (!sent)
+            sent = msgsnd(msgqueue.id, &sentinel, size, IPC_NOWAIT) == 0;
+
+        if (message_queue_drain(&sources.msgqueue, DISPATCH_BUDGET) == 0)
+            nanosleep(&poll_time, NULL);
     }
+
+    pthread_join(msgqueue.bridge, NULL);
+
+    while (message_queue_drain(&sources.msgqueue, DISPATCH_BUDGET) > 0)
+        continue;
 }
 
 void end_server(void)
 {
-    sigset_t signal_set;
+    int handoff = hot_restart_handing_off();
 
-    sigemptyset(&signal_set);
+    close(fifo.fd);
+    close(fifo.keepalive);
 
-    sigprocmask(SIG_SETMASK, &signal_set, NULL); 
+    shmdt(shm.shm_ptr);
 
-    close(fifo.fd);
+    close(shm.doorbell);
 
-    unlink(FIFO_NAME);
+    if (handoff)
+        message_queue_handoff();
+    else
+    {
+        unlink(config_fifo_name());
 
-    shmdt(shm.shm_ptr);
+        shmctl(shm.shmid, IPC_RMID, NULL);
+
+        atomic_store(&msgqueue.stop, 1);
+
+        msgctl(msgqueue.id, IPC_RMID, NULL);
+
+        pthread_join(msgqueue.bridge, NULL);
+    }
+
+    close(msgqueue.doorbell);
+
+    for (int lane = 0; lane < MQ_LANES; lane++)
+        free(msgqueue.lanes[lane]);
+
+    shm_ring_close();
+
+    mapped_file_close();
+
+    slab_thread_flush();
+
+    pipeline_stop();
+
+    dashboard_close();
 
-    shmctl(shm.shmid, IPC_RMID, NULL);
+    dispatcher_close();
 
-    msgctl(msgqueue.id, IPC_RMID, NULL);
+    remove_credit_page();
 
-    remove(PID_SERVER_FILE);
+    pipeline_close();
 
-    fprintf(stdout, "\n\033[1;34mServer STOP! -> PID: %d\033[0m\n", getpid());
+    journal_close();
+
+    recorder_close();
+
+    tracer_dump();
+
+    if (handoff)
+    {
+        save_stats();
+        save_sequences();
+
+        restart_save(RESTART_FIFO_STREAM, fifo.stream, fifo.used);
+    }
+    else
+        remove(config_pid_file());
+
+    hot_restart_close();
+
+    fprintf(stdout, "\n\033[1;34mServer %s! -> PID: %d\033[0m\n", handoff ? "HANDOFF" : "STOP", getpid());
 
     exit(EXIT_SUCCESS);
 }
 
 int main()
 {
-    if (access(PID_SERVER_FILE, F_OK) != -1)
-    {
-        fprintf(stderr, "\033[1;31mYa existe un servidor en ejecucion !\033[0m\n");
-        exit(EXIT_FAILURE);
-    }
-
-    signal_handler_init();
+    config_init();
+    placement_init();
+    checksum_init();
+    signal_limits_init();
+    control_signals_init();
     timers_init();
+    dispatcher_init();
+    profiler_init();
+    tracer_init("server");
 
     mkdir("data", S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
 
+    hot_restart_init();
+
     create_fifo();
+
+    hot_restart_handoff();
+
+    fifo.used = restart_load(RESTART_FIFO_STREAM, fifo.stream, sizeof(fifo.stream));
+
     create_shared_memory_segment();
     create_message_queue();
+    create_credit_page();
+
+    journal_init();
+    recorder_init();
+    pipeline_init();
+    shm_ring_init();
+    mapped_file_init();
+    dashboard_init();
+    grant_configure();
+
+    restore_stats();
+    restore_sequences();
+
+    register_sources();
 
     shared_server_pid();
 
+    placement_start();
+    print_placement(stdout);
+
     fprintf(stdout, "\033[1;34mServer RUN! -> PID: %d\033[0m\n", getpid());
 
-    while (1);
+    dispatcher_run();
+
+    end_server();
 
     return 0;
 }
\ No newline at end of file
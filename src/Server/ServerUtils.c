@@ -10,6 +10,22 @@
  */
 
 #include "ServerUtils.h"
+#include "Credits.h"
+#include "Scheduler.h"
+#include "Journal.h"
+#include "Recorder.h"
+#include "SeqTracker.h"
+#include "Aggregator.h"
+#include "Pipeline.h"
+#include "ShmRing.h"
+#include "ShmSegment.h"
+#include "Dashboard.h"
+#include "RateMeter.h"
+#include "MappedFile.h"
+#include "Dispatcher.h"
+#include "Profiler.h"
+#include "HotRestart.h"
+#include "Placement.h"
 
 //Path base del archivo donde se almacenan las estadisticas del servidor.
 #define SERVER_STATS_FILE_BASE "data/server_stats_"
@@ -58,22 +74,23 @@ struct
     //Estructura de configuracion comun para todos los timers.
     struct itimerspec its;
 
-    //Timer que maneja el timeout del acceso a la FIFO.
-    timer_t fifo;
+    //Tiempo maximo (en milisegundos) que un cliente puede retener un canal otorgado.
+    long timeout_ms;
 
-    //Timer que maneja el timeout del acceso a la Memoria Compartida.
-    timer_t memory_shared;
+    //Timer (timerfd) que maneja el timeout del acceso a la FIFO.
+    int fifo;
+
+    //Timer (timerfd) que maneja el timeout del acceso a la Memoria Compartida.
+    int memory_shared;
 
-    //Timer que maneja el timeout del acceso a la Cola de Mensajes.
-    timer_t message_queue;
+    //Timer (timerfd) que maneja el timeout del acceso a la Cola de Mensajes.
+    int message_queue;
 } timers;
 
 /**
- * @struct stats
- * 
- * Estructura que almacena las estadisticas de ejecucion del servidor.
+ * Estadisticas de ejecucion del servidor.
 */
-struct
+typedef struct ServerStats
 {
     //Cantidad de mensajes recibidos por el canal FIFO.
     long fifo;
@@ -84,6 +101,9 @@ struct
     //Cantidad de mensajes recibidos por el canal de Cola de Mensajes.
     long message_queue;
 
+    //Cantidad de valores recibidos por el canal de Archivo Mapeado.
+    long mapped_file;
+
     //Cantidad de conexiones finalizadas en timeout.
     long timeout;
 
@@ -99,41 +119,147 @@ struct
     //Porcentaje de mensajes recibidos por Cola de Mensajes del total.
     float message_queue_percent;
 
+    //Porcentaje de valores recibidos por Archivo Mapeado del total.
+    float mapped_file_percent;
+
     //Porcentaje de conexiones finalizadas en timeout del total.
     float timeout_percent;
+} ServerStats;
+
+/**
+ * Estadisticas de cada carril de prioridad de la cola de mensajes.
+*/
+typedef struct LaneStats
+{
+    //Cantidad de mensajes recibidos por carril.
+    long count[MQ_LANES];
+
+    //Latencia acumulada por carril, en microsegundos.
+    double latency_sum[MQ_LANES];
 
-    //Tasa de mensajes recibidos por segundo.
-    float msg_rate;
-} stats;
+    //Latencia maxima observada por carril, en microsegundos.
+    double latency_max[MQ_LANES];
+} LaneStats;
+
+//Estadisticas de ejecucion del servidor.
+ServerStats stats;
+
+//Estadisticas de cada carril de prioridad de la cola de mensajes.
+LaneStats lanes;
+
+/**
+ * Respuesta que no se pudo encolar por desborde de la cola de señales del cliente y espera su reintento.
+*/
+typedef struct PendingReply
+{
+    //ID del proceso cliente.
+    pid_t pid;
+
+    //Identificador del cliente virtual que envio la solicitud.
+    uint32_t vid;
+
+    //Canal de la solicitud.
+    ChannelType channel_type;
+
+    //Respuesta a enviar.
+    USRSignalType response;
+
+    //Reintentos realizados.
+    int attempts;
+} PendingReply;
+
+/**
+ * @struct control
+ * 
+ * Estructura que almacena el estado de las señales de control del servidor.
+*/
+struct
+{
+    //Limite de señales encolables (RLIMIT_SIGPENDING) vigente.
+    struct rlimit limit;
+
+    //Respuestas enviadas a los clientes.
+    long replies;
+
+    //Envios de respuestas rechazados por desborde de la cola de señales (reintentados).
+    long overflows;
+
+    //Respuestas perdidas tras agotar los reintentos.
+    long lost;
+
+    //Timer (timerfd) con el que el despachador reintenta las respuestas pendientes.
+    int retry_fd;
+
+    //Respuestas pendientes de reintento.
+    PendingReply pending[REPLY_PENDING_MAX];
+
+    //Cantidad de respuestas pendientes de reintento.
+    int pending_count;
+} control = { .retry_fd = -1 };
+
+/**
+ * @struct stats_snapshot
+ * 
+ * Estructura que almacena una copia de las estadisticas y de los contadores de señales, tomada bajo el lock del servidor
+ * para imprimirla fuera de el.
+*/
+struct
+{
+    //Estadisticas de ejecucion del servidor.
+    ServerStats stats;
+
+    //Estadisticas de cada carril de prioridad de la cola de mensajes.
+    LaneStats lanes;
+
+    //Respuestas enviadas a los clientes.
+    long replies;
+
+    //Envios de respuestas rechazados por desborde de la cola de señales (reintentados).
+    long overflows;
+
+    //Respuestas perdidas tras agotar los reintentos.
+    long lost;
+
+    //Cantidad de respuestas pendientes de reintento.
+    int pending_count;
+} stats_snapshot;
+
+//Lock que serializa el acceso al estado del servidor entre el despachador, el consumidor del anillo, el muestreo del archivo mapeado y el tablero.
+static pthread_mutex_t server_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 //Array auxiliar para obtener un elemento del enumerado 'ChannelType' en formato de cadena.
-const char* ChannelStringType[] = { "FIFO", "SHARED MEMORY", "MESSAGE QUEUE" };
+const char* ChannelStringType[] = { "FIFO", "SHARED MEMORY", "MESSAGE QUEUE", "MAPPED FILE" };
+
+//Array auxiliar para obtener un elemento del enumerado 'MsgPriority' en formato de cadena (indexado por 'mtype' - 1).
+const char* PriorityStringType[] = { "URGENT", "NORMAL", "BULK" };
 
-void refresh_message_rate(void)
+void refresh_lane_stats(MsgPriority lane, const struct timespec* sent)
 {
-    static int swaper = 0;
-    static struct timespec start;
-    struct timespec end;
- 
-    if(!swaper)
-        clock_gettime(CLOCK_MONOTONIC, &start);
-    else
-    {
-        clock_gettime(CLOCK_MONOTONIC, &end);
+    struct timespec now;
+    int index = (int)lane - 1;
 
-        float frecuency = 1.0f / ((float)(end.tv_sec - start.tv_sec) + (float)(end.tv_nsec - start.tv_nsec) / 1000000000.0f);
+    if (index < 0 || index >= MQ_LANES)
+        return;
 
-        float alpha = 1.0f - (float)exp(-1.0 / (frecuency * 2.0 * 3.14159265358979323846));
-        
-        stats.msg_rate = alpha * frecuency + (1.0f - alpha) * stats.msg_rate;
-    }
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    double latency = (double)(now.tv_sec - sent->tv_sec) * 1000000.0 + (double)(now.tv_nsec - sent->tv_nsec) / 1000.0;
 
-    swaper = !swaper;
+    lanes.count[index]++;
+    lanes.latency_sum[index] += latency;
+
+    if (latency > lanes.latency_max[index])
+        lanes.latency_max[index] = latency;
 }
 
-void refresh_stats(ChannelType channel_type, const char* msg, int timeout)
+void refresh_stats(ChannelType channel_type, pid_t pid, const char* msg, int timeout)
 {
-    refresh_message_rate();
+    ProfileSample sample;
+
+    dashboard_record(channel_type, pid, msg, timeout);
+
+    if (!timeout)
+        rate_meter_record(channel_type, strlen(msg) + 1);
 
     stats.total++;
 
@@ -155,33 +281,62 @@ void refresh_stats(ChannelType channel_type, const char* msg, int timeout)
                 stats.message_queue++;
                 stats.message_queue_percent = ((float)stats.message_queue / (float)stats.total) * 100.0f;
                 break;
+
+            case MAPPED_FILE:
+                stats.mapped_file++;
+                stats.mapped_file_percent = ((float)stats.mapped_file / (float)stats.total) * 100.0f;
+                break;
     
             default:
                 break;
         }
 
-        print_msg_info(channel_type, msg, stdout);
+        if (dashboard_enabled())
+            return;
+
+        profile_begin(&sample);
+
+        snapshot_stats();
+
+        print_msg_info(channel_type, pid, msg, stdout);
         print_stats(stdout);
 
+        profile_end(PROFILE_TERMINAL, &sample, 1);
+        profile_begin(&sample);
+
         FILE *fp = fopen(get_stats_file(), "w");
 
         print_stats(fp);
 
         fclose(fp);
+
+        profile_end(PROFILE_STATS_FILE, &sample, 1);
     }
     else
     {
         stats.timeout++;
         stats.timeout_percent = ((float)stats.timeout / (float)stats.total) * 100.0f;
 
-        print_msg_timeout(channel_type, stdout);
+        if (dashboard_enabled())
+            return;
+
+        profile_begin(&sample);
+
+        snapshot_stats();
+
+        print_msg_timeout(channel_type, pid, stdout);
         print_stats(stdout);
+
+        profile_end(PROFILE_TERMINAL, &sample, 1);
+        profile_begin(&sample);
     
         FILE *fp = fopen(get_stats_file(), "w");
         
         print_stats(fp);
     
         fclose(fp);
+
+        profile_end(PROFILE_STATS_FILE, &sample, 1);
     }
 }
 
@@ -211,39 +366,49 @@ const char* get_stats_file(void)
 
 void shared_server_pid(void)
 {
+    const char* path = config_pid_file();
+    char temp[300];
     FILE *fp;
 
-    char aux[11];
+    snprintf(temp, sizeof(temp), "%s.tmp", path);
 
-    sprintf(aux, "%d", getpid());
+    if ((fp = fopen(temp, "w")) == NULL)
+    {
+        fprintf(stderr, "\033[1;31mNo se pudo crear el archivo con el PID del servidor %s: %s\033[0m\n", temp, strerror(errno));
+        exit(EXIT_FAILURE);
+    }
 
-    fp = fopen(PID_SERVER_FILE, "w");
+    fprintf(fp, "%d", getpid());
 
-    fprintf(fp, "%s", aux);
-    
-    fclose(fp);
+    if (fflush(fp) != 0 || fsync(fileno(fp)) == -1 || fclose(fp) != 0 || rename(temp, path) == -1)
+    {
+        fprintf(stderr, "\033[1;31mNo se pudo publicar el PID del servidor en %s: %s\033[0m\n", path, strerror(errno));
+        unlink(temp);
+        exit(EXIT_FAILURE);
+    }
 }
 
 void timers_init(void)
 {
-    struct sigevent sev =
-    {
-        .sigev_notify = SIGEV_SIGNAL,
-        .sigev_signo = SIGRTMIN,
-    };
+    timers.fifo = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    timers.memory_shared = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    timers.message_queue = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
 
-    sev.sigev_value.sival_ptr = &timers.fifo;
-    timer_create(CLOCK_MONOTONIC, &sev, &timers.fifo);
-    
-    sev.sigev_value.sival_ptr = &timers.memory_shared;
-    timer_create(CLOCK_MONOTONIC, &sev, &timers.memory_shared);
-
-    sev.sigev_value.sival_ptr = &timers.message_queue;
-    timer_create(CLOCK_MONOTONIC, &sev, &timers.message_queue);
+    if (timers.fifo == -1 || timers.memory_shared == -1 || timers.message_queue == -1)
+    {
+        fprintf(stderr, "\033[1;31mFallo la creacion de los timers de timeout: %s\033[0m\n", strerror(errno));
+        exit(EXIT_FAILURE);
+    }
 
-    timers.its.it_value.tv_sec = 0;
     timers.its.it_interval.tv_sec = 0;
     timers.its.it_interval.tv_nsec = 0;
+
+    timers_configure();
+}
+
+void timers_configure(void)
+{
+    timers.timeout_ms = config_long("IPC_LOCK_TIMEOUT_MS", LOCK_TIMEOUT_MS, 1, 60000);
 }
 
 int is_lock_channel(ChannelType channel_type)
@@ -264,18 +429,22 @@ int is_lock_channel(ChannelType channel_type)
     }   
 }
 
-ChannelType get_timer_type(timer_t timer)
+int get_timer_fd(ChannelType channel_type)
 {
-    if (timer == timers.fifo)
-        return FIFO;
-    else if (timer == timers.memory_shared)
-        return SHARED_MEMORY;
-    else if (timer == timers.message_queue)
-        return MESSAGE_QUEUE;
-    else
+    switch (channel_type)
     {
-        fprintf(stderr, "\033[1;31mTipo de cliente invalido\033[0m\n");
-        exit(EXIT_FAILURE);
+        case FIFO:
+            return timers.fifo;
+
+        case SHARED_MEMORY:
+            return timers.memory_shared;
+
+        case MESSAGE_QUEUE:
+            return timers.message_queue;
+
+        default:
+            fprintf(stderr, "\033[1;31mTipo de cliente invalido\033[0m\n");
+            exit(EXIT_FAILURE);
     }
 }
 
@@ -299,6 +468,8 @@ pid_t get_pid(ChannelType channel_type)
 
 void change_channel_state(ChannelType channel_type, int state, int pid)
 {
+    dashboard_lock_holder(channel_type, (state == UNLOCK) ? 0 : pid);
+
     switch (channel_type)
     {
         case FIFO:
@@ -323,20 +494,21 @@ void change_channel_state(ChannelType channel_type, int state, int pid)
 
 void change_timer_state(ChannelType channel_type, int state)
 {
-    timers.its.it_value.tv_nsec = (state == START) ? 10000000 : 0;
+    timers.its.it_value.tv_sec = (state == START) ? timers.timeout_ms / 1000 : 0;
+    timers.its.it_value.tv_nsec = (state == START) ? timers.timeout_ms % 1000 * 1000000L : 0;
 
     switch (channel_type)
     {
         case FIFO:
-            timer_settime(timers.fifo, 0, &timers.its, NULL);
+            timerfd_settime(timers.fifo, 0, &timers.its, NULL);
             break;
 
         case SHARED_MEMORY:
-            timer_settime(timers.memory_shared, 0, &timers.its, NULL);
+            timerfd_settime(timers.memory_shared, 0, &timers.its, NULL);
             break;
 
         case MESSAGE_QUEUE:
-            timer_settime(timers.message_queue, 0, &timers.its, NULL);
+            timerfd_settime(timers.message_queue, 0, &timers.its, NULL);
             break;
 
         default:
@@ -344,10 +516,8 @@ void change_timer_state(ChannelType channel_type, int state)
     }  
 }
 
-void print_msg_info(ChannelType channel_type, const char* msg, FILE *fp)
+void print_msg_info(ChannelType channel_type, pid_t pid, const char* msg, FILE *fp)
 {
-    int pid = get_pid(channel_type);
-
     if(fp == stdout)
         fprintf(fp, "\033[1;32m");
 
@@ -357,38 +527,252 @@ void print_msg_info(ChannelType channel_type, const char* msg, FILE *fp)
         fprintf(fp, "\033[0m");
 }
 
-void print_msg_timeout(ChannelType channel_type, FILE *fp)
+void print_msg_timeout(ChannelType channel_type, pid_t pid, FILE *fp)
 {
     if(fp == stdout)
         fprintf(fp, "\033[1;31m");
 
-    fprintf(fp, "\nTimeout ! -> Cliente %s (%d)\n", ChannelStringType[channel_type], get_pid(channel_type));
+    fprintf(fp, "\nTimeout ! -> Cliente %s (%d)\n", ChannelStringType[channel_type], pid);
 
     if(fp == stdout)
         fprintf(fp, "\033[0m");
 }
 
+void signal_limits_init(void)
+{
+    getrlimit(RLIMIT_SIGPENDING, &control.limit);
+
+    if (control.limit.rlim_cur != RLIM_INFINITY && control.limit.rlim_cur < SIGNAL_PENDING_MIN)
+    {
+        struct rlimit raised = control.limit;
+
+        raised.rlim_cur = raised.rlim_max == RLIM_INFINITY || raised.rlim_max > SIGNAL_PENDING_MIN ? SIGNAL_PENDING_MIN : raised.rlim_max;
+
+        if (setrlimit(RLIMIT_SIGPENDING, &raised) == 0)
+            control.limit = raised;
+    }
+
+    if (control.limit.rlim_cur != RLIM_INFINITY && control.limit.rlim_cur < SIGNAL_PENDING_MIN)
+        fprintf(stderr, "\033[1;31mRLIMIT_SIGPENDING es %lu: las señales de control pueden desbordar con muchos clientes\033[0m\n", (unsigned long)control.limit.rlim_cur);
+
+    if ((control.retry_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC)) == -1)
+    {
+        fprintf(stderr, "\033[1;31mFallo la creacion del timer de reintento de respuestas: %s\033[0m\n", strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+}
+
+/**
+ * @brief Intenta encolar una respuesta en la cola de señales del cliente.
+ * 
+ * @param reply Respuesta a enviar.
+ * 
+ * @return 1 si la respuesta se envio o se descarto por un error definitivo. 0 si la cola del cliente esta llena (EAGAIN).
+*/
+static int send_reply(const PendingReply* reply)
+{
+    if (sigqueue(reply->pid, SIGNAL_REPLY(reply->channel_type), (union sigval) { .sival_int = (int)reply->response | (int)(reply->vid & CONTROL_VID_MASK) << CONTROL_VID_SHIFT }) == 0)
+    {
+        control.replies++;
+        return 1;
+    }
+
+    if (errno == EAGAIN)
+        return 0;
+
+    control.lost++;
+
+    return 1;
+}
+
+/**
+ * @brief Arma el timer de reintento con la espera exponencial que corresponde al intento mas antiguo pendiente.
+ * 
+ * @return No devuelve ningun valor.
+*/
+static void arm_reply_retry(void)
+{
+    struct itimerspec its = { .it_value = { 0, 0 } };
+    int attempts = SIGNAL_QUEUE_RETRIES;
+
+    if (control.pending_count == 0)
+        return;
+
+    for (int i = 0; i < control.pending_count; i++)
+        if (control.pending[i].attempts < attempts)
+            attempts = control.pending[i].attempts;
+
+    long delay_ns = REPLY_RETRY_NS << attempts;
+
+    its.it_value.tv_sec = delay_ns / 1000000000L;
+    its.it_value.tv_nsec = delay_ns % 1000000000L;
+
+    timerfd_settime(control.retry_fd, 0, &its, NULL);
+}
+
+void reply_client(pid_t pid, uint32_t vid, ChannelType channel_type, USRSignalType response)
+{
+    PendingReply reply = { .pid = pid, .vid = vid, .channel_type = channel_type, .response = response, .attempts = 0 };
+
+    if (send_reply(&reply))
+        return;
+
+    control.overflows++;
+
+    if (control.pending_count == REPLY_PENDING_MAX)
+    {
+        control.lost++;
+        return;
+    }
+
+    control.pending[control.pending_count++] = reply;
+
+    if (control.pending_count == 1)
+        arm_reply_retry();
+}
+
+int get_reply_retry_fd(void)
+{
+    return control.retry_fd;
+}
+
+void retry_replies(void)
+{
+    int kept = 0;
+
+    for (int i = 0; i < control.pending_count; i++)
+    {
+        PendingReply reply = control.pending[i];
+
+        if (send_reply(&reply))
+            continue;
+
+        control.overflows++;
+
+        if (++reply.attempts > SIGNAL_QUEUE_RETRIES)
+        {
+            control.lost++;
+            continue;
+        }
+
+        control.pending[kept++] = reply;
+    }
+
+    control.pending_count = kept;
+
+    arm_reply_retry();
+}
+
+void print_signal_stats(FILE *fp)
+{
+    char line[128];
+    unsigned long queued = 0, limit = 0;
+    FILE *status = fopen("/proc/self/status", "r");
+
+    if (status)
+    {
+        while (fgets(line, sizeof(line), status) && sscanf(line, "SigQ: %lu/%lu", &queued, &limit) != 2)
+            continue;
+
+        fclose(status);
+    }
+
+    fprintf(fp, "SEÑALES        : RT %d/%d/%d-%d, RLIMIT_SIGPENDING %lu, %lu/%lu en cola\n", SIGNAL_START_WRITE, SIGNAL_END_WRITE, SIGNAL_REPLY(0), SIGNAL_REPLY(MESSAGE_QUEUE), (unsigned long)control.limit.rlim_cur, queued, limit);
+    fprintf(fp, "  %-13s: %ld respuestas, %ld desbordes, %ld perdidas, %d pendientes de reintento\n", "servidor", stats_snapshot.replies, stats_snapshot.overflows, stats_snapshot.lost, stats_snapshot.pending_count);
+    fprintf(fp, "  %-13s: %ld desbordes\n", "clientes", get_client_signal_overflows());
+}
+
+void server_lock(void)
+{
+    pthread_mutex_lock(&server_mutex);
+}
+
+void server_unlock(void)
+{
+    pthread_mutex_unlock(&server_mutex);
+}
+
+void snapshot_stats(void)
+{
+    stats_snapshot.stats = stats;
+    stats_snapshot.lanes = lanes;
+    stats_snapshot.replies = control.replies;
+    stats_snapshot.overflows = control.overflows;
+    stats_snapshot.lost = control.lost;
+    stats_snapshot.pending_count = control.pending_count;
+
+    snapshot_sequences();
+    snapshot_aggregates();
+    snapshot_grants();
+    snapshot_shm_ring();
+}
+
 void print_stats(FILE *fp)
 {
     if(fp == stdout)
         fprintf(fp, "\x1b[36m");
 
     fprintf(fp, "\n");
-    fprintf(fp, "FIFO           : %ld (%.2f %%)\n", stats.fifo, stats.fifo_percent);
-    fprintf(fp, "SHARED MEMORY  : %ld (%.2f %%)\n", stats.memory_shared, stats.memory_shared_percent);
-    fprintf(fp, "MESSAGE QUEUE  : %ld (%.2f %%)\n", stats.message_queue, stats.message_queue_percent);
-    fprintf(fp, "TOTAL          : %ld\n", stats.total);
-    fprintf(fp, "\n");
-    fprintf(fp, "TIMEOUT        : %ld (%.2f %%)\n", stats.timeout, stats.timeout_percent);
+    fprintf(fp, "FIFO           : %ld (%.2f %%)\n", stats_snapshot.stats.fifo, stats_snapshot.stats.fifo_percent);
+    fprintf(fp, "SHARED MEMORY  : %ld (%.2f %%)\n", stats_snapshot.stats.memory_shared, stats_snapshot.stats.memory_shared_percent);
+    fprintf(fp, "MESSAGE QUEUE  : %ld (%.2f %%)\n", stats_snapshot.stats.message_queue, stats_snapshot.stats.message_queue_percent);
 
-    if(fp == stdout)
+    for (int i = 0; i < MQ_LANES; i++)
     {
-        fprintf(fp, "\n");
-        fprintf(fp, "MESSAGE RARTE  : %.2f m/s\n", stats.msg_rate);
+        double average = stats_snapshot.lanes.count[i] ? stats_snapshot.lanes.latency_sum[i] / (double)stats_snapshot.lanes.count[i] : 0.0;
+
+        fprintf(fp, "  %-13s: %ld (lat avg %.1f us, max %.1f us)\n", PriorityStringType[i], stats_snapshot.lanes.count[i], average, stats_snapshot.lanes.latency_max[i]);
     }
 
+    fprintf(fp, "MAPPED FILE    : %ld (%.2f %%)\n", stats_snapshot.stats.mapped_file, stats_snapshot.stats.mapped_file_percent);
+
+    fprintf(fp, "TOTAL          : %ld\n", stats_snapshot.stats.total);
+    fprintf(fp, "\n");
+    fprintf(fp, "TIMEOUT        : %ld (%.2f %%)\n", stats_snapshot.stats.timeout, stats_snapshot.stats.timeout_percent);
+    fprintf(fp, "\n");
+
+    print_sequence_stats(fp);
+
+    fprintf(fp, "\n");
+
+    print_aggregate_stats(fp);
+
+    fprintf(fp, "\n");
+
+    print_pipeline_stats(fp);
+    print_integrity_stats(fp);
+    print_profile_stats(fp);
+    fprintf(fp, "\n");
+
+    print_credit_stats(fp);
+    print_grant_stats(fp);
+    print_signal_stats(fp);
+    print_dispatcher_stats(fp);
+    print_placement(fp);
+    print_shm_segment_stats(fp);
+    print_shm_ring_stats(fp);
+    print_mapped_stats(fp);
+    print_journal_stats(fp);
+    print_recorder_stats(fp);
+
+    fprintf(fp, "\n");
+
+    print_rate_stats(fp);
+
     fprintf(fp, "\n");
     
     if(fp == stdout)
         fprintf(fp, "\033[0m");
-}
\ No newline at end of file
+}
+
+void save_stats(void)
+{
+    restart_save(RESTART_STATS, &stats, sizeof(stats));
+    restart_save(RESTART_LANES, &lanes, sizeof(lanes));
+}
+
+void restore_stats(void)
+{
+    restart_load(RESTART_STATS, &stats, sizeof(stats));
+    restart_load(RESTART_LANES, &lanes, sizeof(lanes));
+}
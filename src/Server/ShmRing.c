@@ -0,0 +1,365 @@
+/**
+ * @file ShmRing.c
+ * @author Bottini, Franco Nicolas.
+ * @brief Implementacion del modo de baja latencia de la memoria compartida del Server IPC.
+ * @version 1.0
+ * @date Marzo de 2023.
+ * 
+ * @copyright Copyright (c) 2023
+ * 
+ */
+
+#define _GNU_SOURCE
+
+#include <stddef.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include "ShmRing.h"
+#include "ServerUtils.h"
+#include "Credits.h"
+#include "Pipeline.h"
+#include "ShmSegment.h"
+#include "HotRestart.h"
+#include "Placement.h"
+#include "Slab.h"
+
+//Presupuesto de espera activa por defecto (en microsegundos) antes de estacionar el consumidor.
+#define SHM_RING_SPIN_US 50
+
+//Tiempo maximo (en milisegundos) que el consumidor permanece estacionado antes de revisar si debe terminar.
+#define SHM_RING_PARK_MS 100
+
+/**
+ * @struct ring
+ * 
+ * Estructura que almacena el estado del consumidor del anillo de memoria compartida.
+*/
+struct
+{
+    //Identificador del segmento de memoria compartida del anillo.
+    int shmid;
+
+    //Puntero al anillo (NULL si el modo de baja latencia esta deshabilitado).
+    ShmRing *ring;
+
+    //Mascara de las posiciones del anillo (cantidad de slots - 1).
+    unsigned int mask;
+
+    //Hilo consumidor del anillo.
+    pthread_t thread;
+
+    //Indica al hilo consumidor que debe terminar.
+    atomic_int stop;
+
+    //Presupuesto de espera activa, en nanosegundos.
+    atomic_long spin_ns;
+
+    //CPU al que se fija el hilo consumidor (-1 si no se fija).
+    int cpu;
+
+    //Cantidad de mensajes consumidos.
+    atomic_long received;
+
+    //Cantidad de lotes entregados al pipeline.
+    atomic_long batches;
+
+    //Cantidad de veces que el consumidor se estaciono en el futex.
+    atomic_long parks;
+
+    //Cantidad de veces que un productor desperto al consumidor.
+    atomic_long wakeups;
+
+    //Suma de las latencias de entrega, en microsegundos.
+    double latency_sum;
+
+    //Maxima latencia de entrega, en microsegundos.
+    double latency_max;
+
+    //Indica si el modo de baja latencia se habilito (se conserva tras cerrar el anillo para el reporte final).
+    int enabled;
+
+    //Mensajes descartados por anillo lleno al cerrar el anillo.
+    long full;
+
+    //Copia de 'latency_sum' tomada bajo el lock del servidor.
+    double snapshot_latency_sum;
+
+    //Copia de 'latency_max' tomada bajo el lock del servidor.
+    double snapshot_latency_max;
+} ring;
+
+/**
+ * @brief Indica al procesador que el hilo esta en una espera activa.
+ * 
+ * @return No devuelve ningun valor.
+*/
+static inline void cpu_relax(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+/**
+ * @brief Devuelve el tiempo monotono actual en nanosegundos.
+ * 
+ * @return Tiempo actual en nanosegundos.
+*/
+static long now_ns(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return now.tv_sec * 1000000000L + now.tv_nsec;
+}
+
+/**
+ * @brief Libera el slot de un mensaje consumido y devuelve sus creditos al cliente.
+ * 
+ * El slot queda disponible para el productor de la posicion 'pos' mas la cantidad de slots del anillo.
+ * 
+ * @param view Vista del mensaje a liberar.
+ * 
+ * @return No devuelve ningun valor.
+*/
+static void release_ring_view(const MsgView* view)
+{
+    ShmRingSlot *slot = (ShmRingSlot*)((char*)(uintptr_t)view->header - offsetof(ShmRingSlot, message));
+    unsigned int sequence = atomic_load_explicit(&slot->sequence, memory_order_relaxed);
+
+    release_credits(view->header->pid, slot->bytes);
+
+    atomic_store_explicit(&slot->sequence, sequence + ring.mask, memory_order_release);
+}
+
+/**
+ * @brief Espera, primero activamente y luego estacionado en el futex, a que se publique el mensaje de la posicion indicada.
+ * 
+ * @param slot Slot en donde se publicara el mensaje.
+ * @param pos Posicion del mensaje esperado.
+ * 
+ * @return 1 si el mensaje esta publicado. 0 si el consumidor debe volver a revisar si tiene que terminar.
+*/
+static int wait_for_slot(ShmRingSlot* slot, unsigned int pos)
+{
+    long deadline = now_ns() + atomic_load_explicit(&ring.spin_ns, memory_order_relaxed);
+
+    for (unsigned int spins = 1; ; spins++)
+    {
+        if (atomic_load_explicit(&slot->sequence, memory_order_acquire) == pos + 1)
+            return 1;
+
+        cpu_relax();
+
+        if ((spins & 63) == 0 && now_ns() >= deadline)
+            break;
+    }
+
+    atomic_store(&ring.ring->parked, 1);
+
+    if (atomic_load_explicit(&slot->sequence, memory_order_acquire) == pos + 1)
+    {
+        atomic_store(&ring.ring->parked, 0);
+        return 1;
+    }
+
+    struct timespec timeout = { 0, SHM_RING_PARK_MS * 1000000L };
+
+    atomic_fetch_add(&ring.parks, 1);
+
+    if (syscall(SYS_futex, &ring.ring->parked, FUTEX_WAIT, 1, &timeout, NULL, 0) == 0 && atomic_load(&ring.ring->parked) == 0)
+        atomic_fetch_add(&ring.wakeups, 1);
+
+    atomic_store(&ring.ring->parked, 0);
+
+    return atomic_load_explicit(&slot->sequence, memory_order_acquire) == pos + 1;
+}
+
+/**
+ * @brief Hilo consumidor del anillo: agrupa los mensajes publicados en lotes y los entrega al pipeline.
+ * 
+ * @param arg No se utiliza.
+ * 
+ * @return NULL.
+*/
+static void* ring_consumer(void* arg)
+{
+    UNUSED(arg);
+
+    unsigned int tail = atomic_load(&ring.ring->tail);
+
+    while (!atomic_load(&ring.stop))
+    {
+        if (!wait_for_slot(&ring.ring->slots[tail & ring.mask], tail))
+            continue;
+
+        MsgBatch batch = { .count = 0 };
+        double latency_sum = 0.0, latency_max = 0.0;
+        struct timespec now;
+
+        clock_gettime(CLOCK_MONOTONIC, &now);
+
+        int limit = pipeline_batch_limit();
+
+        while (batch.count < limit)
+        {
+            unsigned int pos = tail + (unsigned int)batch.count;
+            ShmRingSlot *slot = &ring.ring->slots[pos & ring.mask];
+
+            if (atomic_load_explicit(&slot->sequence, memory_order_acquire) != pos + 1)
+                break;
+
+            const Message *message = &slot->message;
+            double latency = (double)(now.tv_sec - message->header.timestamp.tv_sec) * 1e6 + (double)(now.tv_nsec - message->header.timestamp.tv_nsec) / 1e3;
+
+            latency_sum += latency;
+
+            if (latency > latency_max)
+                latency_max = latency;
+
+            batch.views[batch.count++] = (MsgView)
+            {
+                .channel = SHARED_MEMORY,
+                .header = &message->header,
+                .msg = message->msg,
+                .len = strnlen(message->msg, MSG_MAX_SIZE),
+                .release = release_ring_view
+            };
+        }
+
+        server_lock();
+
+        pipeline_run(&batch);
+
+        ring.latency_sum += latency_sum;
+
+        if (latency_max > ring.latency_max)
+            ring.latency_max = latency_max;
+
+        atomic_fetch_add(&ring.received, batch.count);
+        atomic_fetch_add(&ring.batches, 1);
+
+        server_unlock();
+
+        tail += (unsigned int)batch.count;
+
+        atomic_store(&ring.ring->tail, tail);
+    }
+
+    slab_thread_flush();
+
+    return NULL;
+}
+
+void shm_ring_init(void)
+{
+    const char* enabled = config_get("IPC_SHM_LOWLAT");
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t size = sizeof(ShmRing) + SHM_RING_SLOTS * sizeof(ShmRingSlot);
+    size_t requested = shm_segment_parse_size(config_get("IPC_SHM_SIZE"));
+    struct shmid_ds segment;
+    sigset_t all, previous;
+
+    if (!enabled || strcmp(enabled, "1") != 0)
+        return;
+
+    shm_ring_configure();
+
+    ring.cpu = (int)config_long("IPC_SHM_CPU", -1, -1, cpus - 1);
+
+    if (requested > size)
+        size = requested;
+
+    if ((ring.ring = shm_segment_create("ANILLO", ftok(config_fifo_name(), 'R'), size, ring.cpu >= 0 ? ring.cpu : placement_cpu(THREAD_RECEIVE), &ring.shmid)) == NULL)
+    {
+        fprintf(stderr, "\033[1;31mFallo la creacion del anillo de memoria compartida: %s\033[0m\n", strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+
+    ring.enabled = 1;
+
+    if (!hot_restart_adopting())
+    {
+        unsigned int capacity = SHM_RING_SLOTS;
+
+        shmctl(ring.shmid, IPC_STAT, &segment);
+
+        while (sizeof(ShmRing) + 2 * (size_t)capacity * sizeof(ShmRingSlot) <= segment.shm_segsz && capacity < (1U << 30))
+            capacity *= 2;
+
+        ring.ring->capacity = capacity;
+
+        atomic_store(&ring.ring->head, 0);
+        atomic_store(&ring.ring->tail, 0);
+        atomic_store(&ring.ring->parked, 0);
+        atomic_store(&ring.ring->full, 0);
+
+        for (unsigned int i = 0; i < capacity; i++)
+            atomic_store(&ring.ring->slots[i].sequence, i);
+    }
+
+    ring.mask = ring.ring->capacity - 1;
+
+    sigfillset(&all);
+    pthread_sigmask(SIG_BLOCK, &all, &previous);
+
+    if (pthread_create(&ring.thread, NULL, ring_consumer, NULL) != 0)
+    {
+        fprintf(stderr, "\033[1;31mNo se pudo iniciar el consumidor del anillo de memoria compartida\033[0m\n");
+        exit(EXIT_FAILURE);
+    }
+
+    if (ring.cpu >= 0)
+        placement_pin(ring.thread, ring.cpu, "anillo SHM");
+    else
+        placement_thread(ring.thread, THREAD_RECEIVE, "anillo SHM");
+
+    pthread_sigmask(SIG_SETMASK, &previous, NULL);
+}
+
+void shm_ring_configure(void)
+{
+    atomic_store(&ring.spin_ns, config_long("IPC_SHM_SPIN_US", SHM_RING_SPIN_US, 0, 1000000) * 1000L);
+}
+
+void snapshot_shm_ring(void)
+{
+    ring.snapshot_latency_sum = ring.latency_sum;
+    ring.snapshot_latency_max = ring.latency_max;
+}
+
+void print_shm_ring_stats(FILE *fp)
+{
+    if (!ring.enabled)
+        return;
+
+    long received = atomic_load(&ring.received);
+    long batches = atomic_load(&ring.batches);
+
+    fprintf(fp, "SHM LOW-LAT    : %u slots, %ld mensajes en %ld lotes, lat avg %.1f us, max %.1f us\n", ring.mask + 1, received, batches, received ? ring.snapshot_latency_sum / (double)received : 0.0, ring.snapshot_latency_max);
+    fprintf(fp, "  %-13s: %ld estacionamientos, %ld despertados, %ld descartados (anillo lleno)\n", "futex", atomic_load(&ring.parks), atomic_load(&ring.wakeups), ring.ring ? atomic_load(&ring.ring->full) : ring.full);
+}
+
+void shm_ring_close(void)
+{
+    if (!ring.ring)
+        return;
+
+    atomic_store(&ring.stop, 1);
+    atomic_store(&ring.ring->parked, 0);
+    syscall(SYS_futex, &ring.ring->parked, FUTEX_WAKE, 1, NULL, NULL, 0);
+
+    pthread_join(ring.thread, NULL);
+
+    ring.full = atomic_load(&ring.ring->full);
+
+    shmdt(ring.ring);
+
+    if (!hot_restart_handing_off())
+        shmctl(ring.shmid, IPC_RMID, NULL);
+
+    ring.ring = NULL;
+}
@@ -0,0 +1,221 @@
+/**
+ * @file ShmSegment.c
+ * @author Bottini, Franco Nicolas.
+ * @brief Implementacion de la creacion de segmentos de memoria compartida del Server IPC.
+ * @version 1.0
+ * @date Marzo de 2023.
+ * 
+ * @copyright Copyright (c) 2023
+ * 
+ */
+
+#define _GNU_SOURCE
+
+#include <sched.h>
+#include <dirent.h>
+#include <sys/syscall.h>
+#include "ShmSegment.h"
+
+//Cantidad maxima de segmentos registrados para las estadisticas.
+#define SHM_SEGMENT_MAX 4
+
+//Politica de memoria MPOL_BIND de mbind(2).
+#define SHM_MPOL_BIND 2
+
+//Tamaño de pagina grande por defecto si no se puede leer /proc/meminfo.
+#define SHM_HUGEPAGE_DEFAULT (2UL * 1024 * 1024)
+
+/**
+ * Descripcion de un segmento de memoria compartida creado por el servidor.
+*/
+typedef struct ShmSegmentInfo
+{
+    //Nombre del segmento.
+    const char* name;
+
+    //Tamaño del segmento en bytes.
+    size_t size;
+
+    //1 si el segmento esta respaldado por paginas grandes.
+    int hugepages;
+
+    //1 si se pidieron paginas grandes pero no estaban disponibles.
+    int fallback;
+
+    //Nodo NUMA al que se ligaron las paginas (-1 si no se ligaron).
+    int node;
+
+    //Tiempo que llevo prefaltear el segmento, en microsegundos.
+    double prefault_us;
+} ShmSegmentInfo;
+
+/**
+ * @struct segments
+ * 
+ * Estructura que almacena los segmentos de memoria compartida creados por el servidor.
+*/
+struct
+{
+    //Segmentos creados.
+    ShmSegmentInfo info[SHM_SEGMENT_MAX];
+
+    //Cantidad de segmentos creados.
+    int count;
+} segments;
+
+size_t shm_segment_parse_size(const char* value)
+{
+    char *end;
+
+    if (!value || !*value)
+        return 0;
+
+    size_t size = strtoul(value, &end, 10);
+
+    switch (*end)
+    {
+        case 'g': case 'G': size <<= 10; /* fall through */
+        case 'm': case 'M': size <<= 10; /* fall through */
+        case 'k': case 'K': size <<= 10; break;
+        default: break;
+    }
+
+    return size;
+}
+
+/**
+ * @brief Obtiene el tamaño de pagina grande del sistema.
+ * 
+ * @return Tamaño de pagina grande en bytes.
+*/
+static size_t hugepage_size(void)
+{
+    FILE *fp = fopen("/proc/meminfo", "r");
+    char line[128];
+    unsigned long kb = 0;
+
+    if (!fp)
+        return SHM_HUGEPAGE_DEFAULT;
+
+    while (fgets(line, sizeof(line), fp) && sscanf(line, "Hugepagesize: %lu kB", &kb) != 1)
+        continue;
+
+    fclose(fp);
+
+    return kb ? kb * 1024 : SHM_HUGEPAGE_DEFAULT;
+}
+
+/**
+ * @brief Obtiene el nodo NUMA de un CPU.
+ * 
+ * @param cpu CPU a consultar.
+ * 
+ * @return Nodo NUMA del CPU (-1 si el sistema no expone la topologia NUMA).
+*/
+static int cpu_node(int cpu)
+{
+    char path[64];
+    struct dirent *entry;
+    int node = -1;
+
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d", cpu);
+
+    DIR *dir = opendir(path);
+
+    if (!dir)
+        return -1;
+
+    while ((entry = readdir(dir)) != NULL && node < 0)
+        if (strncmp(entry->d_name, "node", 4) == 0)
+            node = atoi(entry->d_name + 4);
+
+    closedir(dir);
+
+    return node;
+}
+
+/**
+ * @brief Indica si el sistema tiene mas de un nodo NUMA.
+ * 
+ * @return 1 si hay mas de un nodo NUMA, 0 en caso contrario.
+*/
+static int numa_available(void)
+{
+    return access("/sys/devices/system/node/node1", F_OK) == 0;
+}
+
+void* shm_segment_create(const char* name, key_t key, size_t size, int cpu, int* shmid)
+{
+    const char* hugepages = config_get("IPC_SHM_HUGEPAGES");
+    const char* node_env = config_get("IPC_SHM_NUMA_NODE");
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    ShmSegmentInfo info = { .name = name, .node = -1 };
+    struct timespec start, end;
+    char *ptr;
+
+    if (hugepages && strcmp(hugepages, "1") == 0)
+    {
+        size_t huge = hugepage_size();
+
+        info.size = (size + huge - 1) / huge * huge;
+        info.hugepages = (*shmid = shmget(key, info.size, IPC_CREAT | SHM_HUGETLB | 0666)) != -1;
+        info.fallback = !info.hugepages;
+    }
+
+    if (!info.hugepages)
+    {
+        info.size = (size + page - 1) / page * page;
+
+        if ((*shmid = shmget(key, info.size, IPC_CREAT | 0666)) == -1)
+            return NULL;
+    }
+
+    if ((ptr = shmat(*shmid, NULL, 0)) == (char *) -1)
+        return NULL;
+
+    if (numa_available())
+    {
+        int node = node_env && *node_env ? atoi(node_env) : cpu_node(cpu >= 0 ? cpu : sched_getcpu());
+
+        if (node >= 0 && node < (int)(8 * sizeof(unsigned long)))
+        {
+            unsigned long mask = 1UL << node;
+
+            if (syscall(SYS_mbind, ptr, info.size, SHM_MPOL_BIND, &mask, 8 * sizeof(mask), 0) == 0)
+                info.node = node;
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (size_t offset = 0; offset < info.size; offset += page)
+        ((volatile char*)ptr)[offset] = ((volatile char*)ptr)[offset];
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    info.prefault_us = (double)(end.tv_sec - start.tv_sec) * 1e6 + (double)(end.tv_nsec - start.tv_nsec) / 1e3;
+
+    if (segments.count < SHM_SEGMENT_MAX)
+        segments.info[segments.count++] = info;
+
+    return ptr;
+}
+
+void print_shm_segment_stats(FILE *fp)
+{
+    fprintf(fp, "SHM SEGMENTOS  : %d\n", segments.count);
+
+    for (int i = 0; i < segments.count; i++)
+    {
+        const ShmSegmentInfo *info = &segments.info[i];
+
+        fprintf(fp, "  %-13s: %zu KB, paginas %s, nodo ", info->name, info->size / 1024, info->hugepages ? "grandes" : info->fallback ? "normales (sin paginas grandes)" : "normales");
+
+        if (info->node >= 0)
+            fprintf(fp, "%d", info->node);
+        else
+            fprintf(fp, "-");
+
+        fprintf(fp, ", prefault %.1f us\n", info->prefault_us);
+    }
+}
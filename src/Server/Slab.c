@@ -0,0 +1,306 @@
+/**
+ * @file Slab.c
+ * @author Bottini, Franco Nicolas.
+ * @brief Implementacion del asignador por clases de tamaño (slab) de los buffers de mensajes del Server IPC.
+ * @version 1.0
+ * @date Marzo de 2023.
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <pthread.h>
+#include <sys/mman.h>
+#include "Slab.h"
+
+/**
+ * Buffer libre de la lista global de una clase: el enlace se guarda en el propio buffer.
+*/
+typedef struct SlabObject
+{
+    //Proximo buffer libre de la clase.
+    struct SlabObject *next;
+} SlabObject;
+
+/**
+ * Clase de tamaño del asignador.
+*/
+typedef struct SlabClass
+{
+    //Protege la lista de buffers libres y los contadores de la clase.
+    pthread_mutex_t mutex;
+
+    //Buffers libres de la clase.
+    SlabObject *free;
+
+    //Paginas de la arena asignadas a la clase.
+    long pages;
+
+    //Buffers fuera de la lista global (entregados o en la cache de algun hilo).
+    long in_use;
+
+    //Maximo de buffers fuera de la lista global.
+    long high_water;
+
+    //Recargas de la cache de un hilo desde la lista global.
+    long refills;
+
+    //Devoluciones de buffers de la cache de un hilo a la lista global.
+    long flushes;
+
+    //Asignaciones que fallaron por no quedar paginas libres en la arena.
+    atomic_long exhausted;
+} SlabClass;
+
+/**
+ * @struct slab
+ *
+ * Estructura que almacena la arena del asignador y sus clases de tamaño.
+*/
+struct
+{
+    //Inicio de la arena (NULL si el asignador no se inicio).
+    char *base;
+
+    //Cantidad de paginas de la arena.
+    long pages;
+
+    //Proxima pagina sin asignar de la arena.
+    atomic_long next_page;
+
+    //Clase de tamaño de cada pagina asignada.
+    unsigned char *page_class;
+
+    //Clases de tamaño.
+    SlabClass classes[SLAB_CLASSES];
+} slab;
+
+/**
+ * @struct cache
+ *
+ * Cache de buffers libres de cada clase del hilo actual.
+*/
+static _Thread_local struct
+{
+    //Buffers libres de cada clase.
+    void *objects[SLAB_CLASSES][SLAB_CACHE];
+
+    //Cantidad de buffers libres de cada clase.
+    int count[SLAB_CLASSES];
+} cache;
+
+/**
+ * @brief Obtiene el tamaño de los buffers de una clase.
+ *
+ * @param index Clase de tamaño.
+ *
+ * @return Tamaño en bytes.
+*/
+static inline size_t class_size(int index)
+{
+    return (size_t)SLAB_MIN_SIZE << index;
+}
+
+/**
+ * @brief Obtiene la clase de tamaño de un buffer a partir de la pagina que lo contiene.
+ *
+ * @param object Buffer de la arena.
+ *
+ * @return Clase de tamaño del buffer.
+*/
+static inline int object_class(const void* object)
+{
+    return slab.page_class[(size_t)((const char*)object - slab.base) / SLAB_PAGE_SIZE];
+}
+
+/**
+ * @brief Recarga la cache del hilo desde la lista global de una clase, asignandole una pagina nueva si la lista esta vacia.
+ *
+ * @param index Clase de tamaño.
+ *
+ * @return Cantidad de buffers agregados a la cache.
+*/
+static int slab_refill(int index)
+{
+    SlabClass *class = &slab.classes[index];
+    int moved = 0;
+
+    pthread_mutex_lock(&class->mutex);
+
+    if (!class->free)
+    {
+        long page = atomic_fetch_add(&slab.next_page, 1);
+
+        if (page < slab.pages)
+        {
+            char *start = slab.base + page * SLAB_PAGE_SIZE;
+            size_t size = class_size(index);
+
+            slab.page_class[page] = (unsigned char)index;
+
+            for (size_t offset = SLAB_PAGE_SIZE; offset >= size; offset -= size)
+            {
+                SlabObject *object = (SlabObject *)(start + offset - size);
+
+                object->next = class->free;
+                class->free = object;
+            }
+
+            class->pages++;
+        }
+    }
+
+    while (class->free && moved < SLAB_TRANSFER)
+    {
+        cache.objects[index][cache.count[index]++] = class->free;
+        class->free = class->free->next;
+        moved++;
+    }
+
+    class->in_use += moved;
+    class->refills++;
+
+    if (class->in_use > class->high_water)
+        class->high_water = class->in_use;
+
+    pthread_mutex_unlock(&class->mutex);
+
+    return moved;
+}
+
+/**
+ * @brief Devuelve a la lista global de una clase los buffers de la cache del hilo que exceden 'keep'.
+ *
+ * @param index Clase de tamaño.
+ * @param keep Cantidad de buffers que conserva la cache.
+ *
+ * @return No devuelve ningun valor.
+*/
+static void slab_flush(int index, int keep)
+{
+    SlabClass *class = &slab.classes[index];
+    int moved = 0;
+
+    if (cache.count[index] <= keep)
+        return;
+
+    pthread_mutex_lock(&class->mutex);
+
+    while (cache.count[index] > keep)
+    {
+        SlabObject *object = cache.objects[index][--cache.count[index]];
+
+        object->next = class->free;
+        class->free = object;
+        moved++;
+    }
+
+    class->in_use -= moved;
+    class->flushes++;
+
+    pthread_mutex_unlock(&class->mutex);
+}
+
+void slab_init(long objects, int threads)
+{
+    long pages = 0;
+
+    for (int i = 0; i < SLAB_CLASSES; i++)
+    {
+        long per_page = (long)(SLAB_PAGE_SIZE / class_size(i));
+
+        pages += (objects + (long)threads * SLAB_CACHE + per_page - 1) / per_page;
+    }
+
+    slab.pages = config_long("IPC_SLAB_PAGES", pages, 1, 65536);
+
+    if ((slab.base = mmap(NULL, (size_t)slab.pages * SLAB_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0)) == MAP_FAILED)
+    {
+        fprintf(stderr, "\033[1;31mNo se pudo reservar la arena de buffers de mensajes (%ld paginas): %s\033[0m\n", slab.pages, strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+
+    if ((slab.page_class = calloc((size_t)slab.pages, 1)) == NULL)
+    {
+        fprintf(stderr, "\033[1;31mNo se pudo reservar la tabla de paginas de la arena de buffers de mensajes\033[0m\n");
+        exit(EXIT_FAILURE);
+    }
+
+    atomic_store(&slab.next_page, 0);
+
+    for (int i = 0; i < SLAB_CLASSES; i++)
+        pthread_mutex_init(&slab.classes[i].mutex, NULL);
+}
+
+void* slab_alloc(size_t size)
+{
+    int index = 0;
+
+    while (index < SLAB_CLASSES && class_size(index) < size)
+        index++;
+
+    if (index == SLAB_CLASSES || !slab.base)
+        return NULL;
+
+    if (cache.count[index] == 0 && slab_refill(index) == 0)
+    {
+        atomic_fetch_add(&slab.classes[index].exhausted, 1);
+        return NULL;
+    }
+
+    return cache.objects[index][--cache.count[index]];
+}
+
+void slab_free_bulk(void* const* objects, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        int index = object_class(objects[i]);
+
+        if (cache.count[index] == SLAB_CACHE)
+            slab_flush(index, SLAB_CACHE - SLAB_TRANSFER);
+
+        cache.objects[index][cache.count[index]++] = objects[i];
+    }
+}
+
+void slab_thread_flush(void)
+{
+    if (!slab.base)
+        return;
+
+    for (int i = 0; i < SLAB_CLASSES; i++)
+        slab_flush(i, 0);
+}
+
+void print_slab_stats(FILE *fp)
+{
+    if (!slab.base)
+        return;
+
+    long assigned = atomic_load(&slab.next_page);
+
+    fprintf(fp, "SLAB           : %ld/%ld paginas de %d KB asignadas, cache de %d buffers por clase e hilo\n", assigned < slab.pages ? assigned : slab.pages, slab.pages, SLAB_PAGE_SIZE / 1024, SLAB_CACHE);
+
+    for (int i = 0; i < SLAB_CLASSES; i++)
+    {
+        SlabClass *class = &slab.classes[i];
+        char name[16];
+
+        snprintf(name, sizeof(name), "%zu B", class_size(i));
+
+        fprintf(fp, "  %-13s: %ld paginas, %ld en uso (max %ld) de %ld, %ld recargas, %ld devoluciones, %ld agotados\n", name, class->pages, class->in_use, class->high_water,
+                class->pages * (long)(SLAB_PAGE_SIZE / class_size(i)), class->refills, class->flushes, atomic_load(&class->exhausted));
+    }
+}
+
+void slab_close(void)
+{
+    if (!slab.base)
+        return;
+
+    munmap(slab.base, (size_t)slab.pages * SLAB_PAGE_SIZE);
+    free(slab.page_class);
+
+    slab.base = NULL;
+}
@@ -0,0 +1,275 @@
+/**
+ * @file TraceDump.c
+ * @author Bottini, Franco Nicolas.
+ * @brief Herramienta que combina los archivos de eventos del trazador en una traza de Chrome / Perfetto.
+ * @version 1.0
+ * @date Marzo de 2023.
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include "TraceDump.h"
+
+/**
+ * @struct events
+ *
+ * Estructura que almacena los eventos cargados de todos los archivos.
+*/
+struct
+{
+    //Eventos cargados.
+    LoadedEvent *list;
+
+    //Cantidad de eventos cargados.
+    size_t count;
+
+    //Capacidad de la lista.
+    size_t capacity;
+
+    //Cabeceras de los archivos cargados.
+    TraceFileHeader *files;
+
+    //Cantidad de archivos cargados.
+    int file_count;
+} events;
+
+/**
+ * Solicitud de un cliente o lease de un canal abierto, a la espera del evento que lo cierra.
+*/
+typedef struct OpenSpan
+{
+    //Proceso del intervalo.
+    int32_t pid;
+
+    //Hilo (o pista) del intervalo.
+    int32_t tid;
+
+    //Instante de apertura.
+    uint64_t start;
+
+    //Proceso del otro extremo (el cliente, en los leases).
+    int32_t peer;
+} OpenSpan;
+
+//Nombre de cada tipo de evento en la traza.
+static const char* TraceEventNames[TRACE_EVENT_TYPES] = { "REQUEST", "GRANT", "WAIT", "WRITE", "END_WRITE", "RECEIVE", "TIMEOUT", "RELEASE" };
+
+//Nombre de cada canal en la traza.
+static const char* TraceChannelNames[CHANNEL_COUNT] = { "FIFO", "SHARED MEMORY", "MESSAGE QUEUE", "MAPPED FILE" };
+
+void print_trace_dump_help(void)
+{
+	fprintf(stdout, "\n\033[1;34m");
+	fprintf(stdout, "Uso: TraceDump <salida.json> <eventos.bin>...\n");
+	fprintf(stdout, "	- salida.json: traza combinada, para abrir en chrome://tracing o ui.perfetto.dev.\n");
+	fprintf(stdout, "	- eventos.bin: archivos generados con IPC_EVENT_TRACE=1 (data/events_<pid>.bin).\n");
+	fprintf(stdout, "\033[0m\n");
+}
+
+void load_events(const char* path)
+{
+    FILE *fp;
+    TraceFileHeader header;
+    TraceEvent event;
+
+    if ((fp = fopen(path, "rb")) == NULL)
+    {
+        fprintf(stderr, "\033[1;31mNo se pudo abrir el archivo de eventos %s: %s\033[0m\n", path, strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+
+    if (fread(&header, sizeof(header), 1, fp) != 1 || header.magic != EVENT_TRACE_MAGIC)
+    {
+        fprintf(stderr, "\033[1;31mEl archivo %s no es un archivo de eventos valido !\033[0m\n", path);
+        exit(EXIT_FAILURE);
+    }
+
+    if ((events.files = realloc(events.files, (size_t)(events.file_count + 1) * sizeof(TraceFileHeader))) == NULL)
+    {
+        fprintf(stderr, "\033[1;31mNo hay memoria suficiente para cargar los eventos !\033[0m\n");
+        exit(EXIT_FAILURE);
+    }
+
+    events.files[events.file_count++] = header;
+
+    while (fread(&event, sizeof(event), 1, fp) == 1)
+    {
+        if (event.type >= TRACE_EVENT_TYPES || event.channel >= CHANNEL_COUNT)
+            continue;
+
+        if (events.count == events.capacity)
+        {
+            events.capacity = events.capacity ? events.capacity * 2 : 4096;
+
+            if ((events.list = realloc(events.list, events.capacity * sizeof(LoadedEvent))) == NULL)
+            {
+                fprintf(stderr, "\033[1;31mNo hay memoria suficiente para cargar los eventos !\033[0m\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+
+        events.list[events.count++] = (LoadedEvent) { .event = event, .pid = header.pid, .server = strncmp(header.role, "server", sizeof(header.role)) == 0 };
+    }
+
+    fclose(fp);
+}
+
+/**
+ * @brief Compara dos eventos por instante (y por proceso en caso de empate).
+ *
+ * @param a Primer evento.
+ * @param b Segundo evento.
+ *
+ * @return Negativo, cero o positivo segun el orden de los eventos.
+*/
+static int compare_events(const void* a, const void* b)
+{
+    const LoadedEvent *first = a, *second = b;
+
+    if (first->event.timestamp != second->event.timestamp)
+        return first->event.timestamp < second->event.timestamp ? -1 : 1;
+
+    return first->pid - second->pid;
+}
+
+/**
+ * @brief Escribe un intervalo completo ("ph": "X") en la traza.
+ *
+ * @param fp Archivo de salida.
+ * @param name Nombre del intervalo.
+ * @param pid Proceso del intervalo.
+ * @param tid Hilo (o pista) del intervalo.
+ * @param start Instante de apertura, en nanosegundos desde el primer evento.
+ * @param end Instante de cierre, en nanosegundos desde el primer evento.
+ * @param peer Proceso del otro extremo.
+ *
+ * @return No devuelve ningún valor.
+*/
+static void write_span(FILE* fp, const char* name, int32_t pid, int32_t tid, uint64_t start, uint64_t end, int32_t peer)
+{
+    fprintf(fp, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"peer\":%d}}",
+            name, pid, tid, (double)start / 1000.0, (double)(end - start) / 1000.0, peer);
+}
+
+/**
+ * @brief Busca el intervalo abierto de un hilo, o reserva uno nuevo.
+ *
+ * @param spans Intervalos abiertos.
+ * @param count Cantidad de intervalos abiertos (se incrementa si se reserva uno nuevo).
+ * @param pid Proceso del intervalo.
+ * @param tid Hilo (o pista) del intervalo.
+ *
+ * @return El intervalo del hilo.
+*/
+static OpenSpan* find_span(OpenSpan* spans, size_t* count, int32_t pid, int32_t tid)
+{
+    for (size_t i = 0; i < *count; i++)
+        if (spans[i].pid == pid && spans[i].tid == tid)
+            return &spans[i];
+
+    spans[*count] = (OpenSpan) { .pid = pid, .tid = tid };
+
+    return &spans[(*count)++];
+}
+
+void write_chrome_trace(const char* path)
+{
+    FILE *fp;
+    OpenSpan *spans = calloc(events.count + 1, sizeof(OpenSpan));
+    size_t open = 0;
+
+    if ((fp = fopen(path, "w")) == NULL || !spans)
+    {
+        fprintf(stderr, "\033[1;31mNo se pudo crear la traza %s: %s\033[0m\n", path, strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+
+    qsort(events.list, events.count, sizeof(LoadedEvent), compare_events);
+
+    uint64_t origin = events.count ? events.list[0].event.timestamp : 0;
+
+    fprintf(fp, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    fprintf(fp, "{\"name\":\"trace\",\"ph\":\"M\",\"pid\":0,\"args\":{\"events\":%zu}}", events.count);
+
+    for (int i = 0; i < events.file_count; i++)
+    {
+        const TraceFileHeader *file = &events.files[i];
+
+        if (strncmp(file->role, "server", sizeof(file->role)) != 0)
+        {
+            fprintf(fp, ",\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":\"Cliente %d\"}}", file->pid, file->pid);
+            continue;
+        }
+
+        fprintf(fp, ",\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":\"Server\"}}", file->pid);
+
+        for (int channel = 0; channel <= MESSAGE_QUEUE; channel++)
+            fprintf(fp, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"lease %s\"}}", file->pid, LEASE_TRACK_BASE + channel, TraceChannelNames[channel]);
+    }
+
+    for (size_t i = 0; i < events.count; i++)
+    {
+        const LoadedEvent *loaded = &events.list[i];
+        const TraceEvent *event = &loaded->event;
+        uint64_t ts = event->timestamp - origin;
+
+        fprintf(fp, ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f,\"args\":{\"peer\":%d,\"vid\":%u,\"seq\":%u}}",
+                TraceEventNames[event->type], TraceChannelNames[event->channel], loaded->pid, event->tid, (double)ts / 1000.0, event->peer, event->vid, event->seq);
+
+        if (loaded->server)
+        {
+            OpenSpan *lease = find_span(spans, &open, loaded->pid, LEASE_TRACK_BASE + event->channel);
+
+            if (event->type == TRACE_GRANT)
+            {
+                lease->start = ts + 1;
+                lease->peer = event->peer;
+            }
+            else if ((event->type == TRACE_RELEASE || event->type == TRACE_TIMEOUT) && lease->start)
+            {
+                write_span(fp, event->type == TRACE_TIMEOUT ? "lease (timeout)" : "lease", loaded->pid, LEASE_TRACK_BASE + event->channel, lease->start - 1, ts, lease->peer);
+                lease->start = 0;
+            }
+        }
+        else
+        {
+            OpenSpan *request = find_span(spans, &open, loaded->pid, event->tid);
+
+            if (event->type == TRACE_REQUEST)
+                request->start = ts + 1;
+            else if ((event->type == TRACE_GRANT || event->type == TRACE_WAIT || event->type == TRACE_TIMEOUT) && request->start)
+            {
+                write_span(fp, event->type == TRACE_GRANT ? "request -> GRANT" : (event->type == TRACE_WAIT ? "request -> WAIT" : "request -> TIMEOUT"),
+                           loaded->pid, event->tid, request->start - 1, ts, 0);
+                request->start = 0;
+            }
+        }
+    }
+
+    fprintf(fp, "\n]}\n");
+
+    fclose(fp);
+    free(spans);
+    free(events.files);
+    free(events.list);
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 3)
+    {
+        fprintf(stderr, "\033[1;31mNúmero de argumentos invalido !\033[0m\n");
+        print_trace_dump_help();
+        exit(EXIT_FAILURE);
+    }
+
+    for (int i = 2; i < argc; i++)
+        load_events(argv[i]);
+
+    write_chrome_trace(argv[1]);
+
+    fprintf(stdout, "\033[1;34m%zu eventos de %d archivos combinados en %s\033[0m\n", events.count, argc - 2, argv[1]);
+
+    return 0;
+}
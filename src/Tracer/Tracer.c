@@ -0,0 +1,154 @@
+/**
+ * @file Tracer.c
+ * @author Bottini, Franco Nicolas.
+ * @brief Implementacion del trazador de eventos del ciclo de vida de los mensajes.
+ * @version 1.0
+ * @date Marzo de 2023.
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <sys/syscall.h>
+#include "Tracer.h"
+
+/**
+ * Anillo de eventos de un hilo. Solo lo escribe su hilo; se lee al volcar los eventos.
+*/
+typedef struct TraceRing
+{
+    //Cantidad de eventos registrados desde la creacion del anillo.
+    atomic_ulong head;
+
+    //Eventos del anillo.
+    TraceEvent events[];
+} TraceRing;
+
+/**
+ * @struct tracer
+ *
+ * Estructura que almacena el estado del trazador del proceso.
+*/
+struct
+{
+    //1 si el trazador esta habilitado.
+    int enabled;
+
+    //Rol del proceso.
+    char role[16];
+
+    //Cantidad de eventos del anillo de cada hilo (IPC_TRACE_RING_EVENTS, potencia de 2).
+    unsigned long events;
+
+    //Anillos de los hilos que registraron eventos.
+    TraceRing* rings[TRACE_THREADS_MAX];
+
+    //Cantidad de anillos creados.
+    int count;
+
+    //Serializa la creacion de anillos y el volcado.
+    pthread_mutex_t mutex;
+} tracer = { .events = TRACE_RING_EVENTS, .mutex = PTHREAD_MUTEX_INITIALIZER };
+
+//Anillo del hilo actual (NULL hasta su primer evento).
+static _Thread_local TraceRing* thread_ring;
+
+//Identificador del hilo actual.
+static _Thread_local int32_t thread_id;
+
+/**
+ * @brief Crea el anillo del hilo actual y lo registra para el volcado.
+ *
+ * @return El anillo creado, o NULL si se alcanzo TRACE_THREADS_MAX o no hay memoria.
+*/
+static TraceRing* ring_create(void)
+{
+    TraceRing* ring = NULL;
+
+    pthread_mutex_lock(&tracer.mutex);
+
+    if (tracer.count < TRACE_THREADS_MAX && (ring = calloc(1, sizeof(TraceRing) + tracer.events * sizeof(TraceEvent))) != NULL)
+        tracer.rings[tracer.count++] = ring;
+
+    pthread_mutex_unlock(&tracer.mutex);
+
+    thread_id = (int32_t)syscall(SYS_gettid);
+
+    return ring;
+}
+
+void tracer_init(const char* role)
+{
+    const char* enabled = config_get("IPC_EVENT_TRACE");
+
+    if (!enabled || strcmp(enabled, "1") != 0)
+        return;
+
+    snprintf(tracer.role, sizeof(tracer.role), "%s", role);
+
+    tracer.events = (unsigned long)config_pow2("IPC_TRACE_RING_EVENTS", TRACE_RING_EVENTS, 1024, 1 << 24);
+
+    tracer.enabled = 1;
+}
+
+void trace_event(TraceEventType type, int channel, pid_t peer, uint32_t vid, uint32_t seq)
+{
+    struct timespec now;
+
+    if (!tracer.enabled || (!thread_ring && (thread_ring = ring_create()) == NULL))
+        return;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    unsigned long head = atomic_load_explicit(&thread_ring->head, memory_order_relaxed);
+
+    thread_ring->events[head & (tracer.events - 1)] = (TraceEvent)
+    {
+        .timestamp = (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec,
+        .tid = thread_id,
+        .peer = peer,
+        .vid = vid,
+        .seq = seq,
+        .type = (uint16_t)type,
+        .channel = (uint16_t)channel
+    };
+
+    atomic_store_explicit(&thread_ring->head, head + 1, memory_order_release);
+}
+
+void tracer_dump(void)
+{
+    char file[64];
+    FILE *fp;
+    TraceFileHeader header = { .magic = EVENT_TRACE_MAGIC, .pid = getpid() };
+
+    if (!tracer.enabled)
+        return;
+
+    snprintf(file, sizeof(file), "%s%d.bin", TRACE_FILE_BASE, getpid());
+    memcpy(header.role, tracer.role, sizeof(header.role));
+
+    if ((fp = fopen(file, "wb")) == NULL)
+    {
+        fprintf(stderr, "\033[1;31mNo se pudo crear el archivo de eventos %s: %s\033[0m\n", file, strerror(errno));
+        return;
+    }
+
+    fwrite(&header, sizeof(header), 1, fp);
+
+    pthread_mutex_lock(&tracer.mutex);
+
+    for (int i = 0; i < tracer.count; i++)
+    {
+        TraceRing* ring = tracer.rings[i];
+        unsigned long head = atomic_load_explicit(&ring->head, memory_order_acquire);
+        unsigned long first = head > tracer.events ? head - tracer.events : 0;
+
+        for (unsigned long pos = first; pos < head; pos++)
+            fwrite(&ring->events[pos & (tracer.events - 1)], sizeof(TraceEvent), 1, fp);
+    }
+
+    pthread_mutex_unlock(&tracer.mutex);
+
+    fclose(fp);
+}